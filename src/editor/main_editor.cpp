@@ -5,10 +5,31 @@
 // TODO create an entire editor
 // no biggie...
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
 #include "Editor.hpp"
 
-int main(int /*argc*/, char** argv) {
+int main(int argc, char** argv) {
+    bool headless = false;
+    int width = 0, height = 0;
+    unsigned int max_frames = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            std::sscanf(argv[++i], "%dx%d", &width, &height);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = static_cast<unsigned int>(std::atoi(argv[++i]));
+        }
+    }
+    if (headless) {
+        Application::request_headless(width, height);
+    }
+
     Editor editor{argv};
+    editor.set_max_frames(max_frames);
     editor.setup();
-    return editor.loop();
+    return editor.loop() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
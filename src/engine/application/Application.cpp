@@ -1,24 +1,51 @@
 #include "Application.hpp"
-#include <OpenGL/gl3.h>
+#include "engine/renderer/GL.hpp"
 #include <thread>
 #include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+Application::HeadlessRequest Application::headless_request;
 
 GLFWwindow* Application::init_window() {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_SAMPLES, 4);
+    headless_ = headless_request.enabled;
+    if (headless_request.width > 0 && headless_request.height > 0) {
+        window_width_ = static_cast<unsigned int>(headless_request.width);
+        window_height_ = static_cast<unsigned int>(headless_request.height);
+    }
+
+    // The software backend renders at the requested size without a window or GL context
+    if (!Renderer::uses_gl()) {
+        framebuffer_width_ = static_cast<int>(window_width_);
+        framebuffer_height_ = static_cast<int>(window_height_);
+        return nullptr;
+    }
+
+    GLFWwindow* window = nullptr;
+    if (headless_) {
+        window = create_headless_window();
+    } else {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_SAMPLES, 4);
 
-    GLFWwindow* window = glfwCreateWindow(window_width_, window_height_, window_name_.c_str(), nullptr, nullptr);
+        window = glfwCreateWindow(window_width_, window_height_, window_name_.c_str(), nullptr, nullptr);
+    }
 
     glfwMakeContextCurrent(window);
     glfwSwapInterval(0);
 
-    int w, h;
-    glfwGetFramebufferSize(window, &w, &h);
-    glViewport(0, 0, w, h);
-    glfwSetWindowAspectRatio(window, window_width_, window_height_);
+    if (headless_) {
+        framebuffer_width_ = static_cast<int>(window_width_);
+        framebuffer_height_ = static_cast<int>(window_height_);
+        create_offscreen_backbuffer();
+    } else {
+        glfwGetFramebufferSize(window, &framebuffer_width_, &framebuffer_height_);
+        glfwSetWindowAspectRatio(window, window_width_, window_height_);
+    }
+    glViewport(0, 0, framebuffer_width_, framebuffer_height_);
 
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_MULTISAMPLE);
@@ -28,34 +55,240 @@ GLFWwindow* Application::init_window() {
     return window;
 }
 
+GLFWwindow* Application::create_headless_window() {
+    struct Attempt {
+        int platform;
+        int context_api;
+    };
+    const Attempt attempts[] = {
+        {GLFW_PLATFORM_NULL, GLFW_EGL_CONTEXT_API},     // Surfaceless EGL, e.g. Mesa llvmpipe
+        {GLFW_PLATFORM_NULL, GLFW_OSMESA_CONTEXT_API},
+        {GLFW_ANY_PLATFORM, GLFW_NATIVE_CONTEXT_API},   // Hidden window, needs a display (or Xvfb)
+    };
+
+    for (const auto& attempt: attempts) {
+        glfwInitHint(GLFW_PLATFORM, attempt.platform);
+        if (!glfwInit()) continue;
+
+        glfwDefaultWindowHints();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, attempt.context_api);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        GLFWwindow* window = glfwCreateWindow(window_width_, window_height_, window_name_.c_str(), nullptr, nullptr);
+        if (window) return window;
+        glfwTerminate();
+    }
+
+    throw std::runtime_error("Failed to create a headless OpenGL context");
+}
+
+void Application::create_offscreen_backbuffer() {
+    // Surfaceless contexts have no default framebuffer, so headless frames always go here
+    glGenRenderbuffers(1, &backbuffer_color_);
+    glBindRenderbuffer(GL_RENDERBUFFER, backbuffer_color_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, framebuffer_width_, framebuffer_height_);
+
+    glGenRenderbuffers(1, &backbuffer_depth_);
+    glBindRenderbuffer(GL_RENDERBUFFER, backbuffer_depth_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, framebuffer_width_, framebuffer_height_);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &backbuffer_fbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, backbuffer_fbo_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, backbuffer_color_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, backbuffer_depth_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Headless backbuffer is incomplete");
+    }
+}
+
+Application::~Application() noexcept {
+    // Everything holding handles goes first, so the handles land in the retention caches
+    main_scene_.reset();
+    frame_recorder_.reset();
+    software_rasterizer_.reset();
+    dynamic_resolution_.reset();
+    deferred_renderer_.reset();
+    render_graph_.reset();
+
+    Managers::model_manager().clean();
+    Managers::texture_manager().clean();
+    Managers::shader_manager().clean();
+    // Released GL resources are freed through the upload queue
+    Renderer::UploadQueue::instance().process(SIZE_MAX);
+}
+
 void Application::add_prefab_to_scene(const Scene::Prefab& prefab) {
     assert(main_scene_);
     prefab.initialize(*main_scene_);
 }
 
+Preloader::Report Application::preload(const std::vector<const Scene::Prefab*>& prefabs) {
+    AssetManifest manifest;
+    for (const auto prefab: prefabs) {
+        prefab->collect(manifest);
+    }
+    Preloader::Report report = Preloader::load(manifest);
+    report.print();
+    return report;
+}
+
+void Application::set_render_mode(RenderMode mode) {
+    if (mode == RenderMode::DEFERRED && !Renderer::uses_gl()) {
+        printf("WARNING — Deferred rendering needs the OpenGL backend, staying on forward\n");
+        return;
+    }
+    if (mode == RenderMode::DEFERRED && !deferred_renderer_) {
+        deferred_renderer_ = std::make_unique<Renderer::DeferredRenderer>();
+    }
+    render_mode_ = mode;
+}
+
+void Application::set_dynamic_resolution(bool enabled) {
+    if (enabled && !Renderer::uses_gl()) {
+        printf("WARNING — Dynamic resolution needs the OpenGL backend\n");
+        return;
+    }
+    if (enabled && !dynamic_resolution_) {
+        dynamic_resolution_ = std::make_unique<Renderer::DynamicResolution>(
+            framebuffer_width_, framebuffer_height_, FRAME_DURATION_MS);
+    } else if (!enabled) {
+        dynamic_resolution_ = nullptr;
+    }
+}
+
+void Application::set_frame_capture(const std::filesystem::path& output, Renderer::FrameRecorder::Format format) {
+    if (!Renderer::uses_gl()) {
+        printf("WARNING — Frame capture needs the OpenGL backend, use --output instead\n");
+        return;
+    }
+    frame_recorder_ = std::make_unique<Renderer::FrameRecorder>(
+        output, format, framebuffer_width_, framebuffer_height_);
+}
+
+void Application::process_scene(double delta_t) {
+    assert(main_scene_);
+    // Uploads for resources that finished loading in the background since the last frame
+    Renderer::UploadQueue::instance().process_frame();
+    // Finer mips for streamed textures drawn close up last frame
+    Renderer::TextureStreamer::instance().update();
+
+    main_scene_->update(delta_t);
+
+    if (software_rasterizer_) {
+        software_rasterizer_->render(*main_scene_);
+        return;
+    }
+
+    // Meshes unloaded since the last frame can leave holes in the shared geometry buffers
+    Renderer::GeometryPool::defragment_all();
+
+    render_graph_.reset();
+    const auto backbuffer = render_graph_.import_framebuffer(
+        "backbuffer", backbuffer_fbo_, framebuffer_width_, framebuffer_height_);
+
+    Renderer::RenderTarget target{backbuffer, backbuffer, framebuffer_width_, framebuffer_height_};
+    if (dynamic_resolution_) {
+        target = dynamic_resolution_->create_scene_target(render_graph_);
+    }
+    Renderer::TextureStreamer::instance().set_viewport_height(target.viewport_height);
+
+    if (render_mode_ == RenderMode::DEFERRED) {
+        deferred_renderer_->add_render_passes(render_graph_, *main_scene_, target);
+    } else {
+        main_scene_->add_render_passes(render_graph_, target);
+    }
+
+    if (dynamic_resolution_) {
+        dynamic_resolution_->add_upscale_pass(render_graph_, target, backbuffer);
+    }
+
+    render_graph_.compile();
+
+    if (dynamic_resolution_) {
+        dynamic_resolution_->begin_frame();
+    }
+    render_graph_.execute();
+    if (dynamic_resolution_) {
+        dynamic_resolution_->end_frame();
+    }
+}
+
+void Application::print_benchmark(unsigned int n_frames, double elapsed_ms) const {
+    printf("Rendered %u frames at %dx%d (%s), %.3f ms/frame\n",
+           n_frames, framebuffer_width_, framebuffer_height_,
+           Renderer::uses_gl() ? "OpenGL headless" : "software", elapsed_ms / std::max(1u, n_frames));
+}
+
+bool Application::software_loop() {
+    // Fixed time step so runs are reproducible
+    constexpr double delta_t = FRAME_DURATION_MS / 1000.0;
+    const unsigned int n_frames = std::max(1u, max_frames_);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int frame = 0; frame < n_frames; frame++) {
+        poll_events();
+        process_scene(delta_t);
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    print_benchmark(n_frames, elapsed.count());
+
+    if (!output_image_path_.empty() && !software_rasterizer_->write_png(output_image_path_)) {
+        printf("ERROR — Failed to write %s\n", output_image_path_.c_str());
+        return false;
+    }
+    return true;
+}
+
 bool Application::loop() {
     assert(initialized);
 
+    if (software_rasterizer_) {
+        return software_loop();
+    }
+
     double delta_t = 0.0;
     double last = glfwGetTime();
     double now = 0.0;
     double this_frame_duration_ms = 0.0;
     double time_to_next_frame_ms = 0.0;
 
-    while (!glfwWindowShouldClose(window_)) {
+    const auto start = std::chrono::steady_clock::now();
+    unsigned int frame = 0;
+    while (!glfwWindowShouldClose(window_) && (max_frames_ == 0 || frame < max_frames_)) {
+        frame++;
         now = glfwGetTime();
-        delta_t = now - last;
+        // Unattended runs use a fixed time step so they are reproducible
+        delta_t = headless_ ? FRAME_DURATION_MS / 1000.0 : now - last;
         last = now;
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glfwPollEvents();
 
         poll_events();
 
         process_scene(delta_t);
 
+        if (dynamic_resolution_) {
+            dynamic_resolution_->record_cpu_time((glfwGetTime() - now) * 1000.0);
+        }
+
+        // Queues a readback of the finished frame, collected a few frames later
+        if (frame_recorder_) {
+            frame_recorder_->capture(backbuffer_fbo_);
+        }
+
         glfwSwapBuffers(window_);
 
+        if (dynamic_resolution_) {
+            dynamic_resolution_->update_scale();
+        }
+
+        // Headless runs are benchmarks, so they aren't paced
+        if (headless_) continue;
+
         // Attempt at frame timing
         this_frame_duration_ms = (glfwGetTime() - now) * 1000.0;
         time_to_next_frame_ms = FRAME_DURATION_MS - this_frame_duration_ms;
@@ -65,5 +298,18 @@ bool Application::loop() {
             );
         }
     }
+
+    if (headless_) {
+        // Include the GPU work still queued for the last frames
+        glFinish();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        print_benchmark(frame, elapsed.count());
+    }
+
+    if (frame_recorder_) {
+        frame_recorder_->finish();
+        printf("Captured %u frames, dropped %u\n",
+               frame_recorder_->get_written_frames(), frame_recorder_->get_dropped_frames());
+    }
     return true;
 }
@@ -3,28 +3,78 @@
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <thread>
+#include <algorithm>
 
-#include <OpenGL/gl3.h>
+#include "engine/renderer/GL.hpp"
 #include <GLFW/glfw3.h>
 
 #include "engine/utilities/Utils.hpp"
 #include "engine/scene/Scene.hpp"
 #include "engine/utilities/Input.hpp"
+#include "engine/utilities/JobSystem.hpp"
 #include "engine/resources/ResourceManager.hpp"
 #include "engine/scene/Prefab.hpp"
+#include "engine/resources/Preloader.hpp"
+#include "engine/renderer/DeferredRenderer.hpp"
+#include "engine/renderer/DynamicResolution.hpp"
+#include "engine/renderer/RenderGraph.hpp"
+#include "engine/renderer/Backend.hpp"
+#include "engine/renderer/SoftwareRasterizer.hpp"
+#include "engine/renderer/FrameRecorder.hpp"
+#include "engine/renderer/TextureStreamer.hpp"
+#include "engine/renderer/UploadQueue.hpp"
 
 constexpr double TARGET_FPS = 120.0;
 constexpr double FRAME_DURATION_MS = 1.0 / TARGET_FPS * 1000.0;
 
+enum class RenderMode {
+    FORWARD,
+    DEFERRED,
+};
+
 class Application {
 private:
+    struct HeadlessRequest {
+        bool enabled = false;
+        int width = 0;
+        int height = 0;
+    };
+
+    static HeadlessRequest headless_request;
+
     unsigned int window_width_;
     unsigned int window_height_;
     const std::string window_name_;
+    int framebuffer_width_ = 0;
+    int framebuffer_height_ = 0;
+    bool headless_ = false;
+    // Filled in by init_window(), so declared before window_. 0 is the window's framebuffer.
+    GLuint backbuffer_fbo_ = 0;
+    GLuint backbuffer_color_ = 0;
+    GLuint backbuffer_depth_ = 0;
     GLFWwindow* window_;
 
+    RenderMode render_mode_ = RenderMode::FORWARD;
+    std::unique_ptr<Renderer::DeferredRenderer> deferred_renderer_ = nullptr;
+    std::unique_ptr<Renderer::DynamicResolution> dynamic_resolution_ = nullptr;
+    Renderer::RenderGraph render_graph_;
+    std::unique_ptr<Renderer::SoftwareRasterizer> software_rasterizer_ = nullptr;
+    std::unique_ptr<Renderer::FrameRecorder> frame_recorder_ = nullptr;
+
+    unsigned int max_frames_ = 0;
+    std::string output_image_path_;
+
     GLFWwindow* init_window();
 
+    GLFWwindow* create_headless_window();
+
+    void create_offscreen_backbuffer();
+
+    void print_benchmark(unsigned int n_frames, double elapsed_ms) const;
+
+    bool software_loop();
+
 protected:
     const std::filesystem::path exe_dir_path_;
     std::unique_ptr<Scene::Scene> main_scene_ = nullptr;
@@ -39,11 +89,25 @@ public:
           window_(init_window()),
           exe_dir_path_(Utils::exe_dir_path_from_argv0(argv[0])) {
         // Set up singletons
+        JobSystem::initialize(std::max(1u, std::thread::hardware_concurrency()) - 1);
         Managers::initialize(exe_dir_path_);
         Input::initialize(window_);
+
+        if (!Renderer::uses_gl()) {
+            software_rasterizer_ = std::make_unique<Renderer::SoftwareRasterizer>(
+                framebuffer_width_, framebuffer_height_);
+        }
     }
 
-    virtual ~Application() noexcept = default;
+    // Frees the retained resources while the GL context, geometry pools and texture
+    // streamer they release into are still alive, rather than at static destruction
+    virtual ~Application() noexcept;
+
+    // Must be called before the application is constructed. Renders into an offscreen
+    // framebuffer instead of a visible window, at the window size unless one is given. Tries
+    // a surfaceless EGL context, then OSMesa, then a hidden window, so it runs on GPU-less
+    // machines through Mesa's llvmpipe.
+    static void request_headless(int width = 0, int height = 0) { headless_request = {true, width, height}; }
 
     virtual void setup() = 0;
 
@@ -51,15 +115,41 @@ public:
 
     void add_prefab_to_scene(const Scene::Prefab &prefab);
 
+    // Loads every asset the prefabs use at once and prints how long each took. Keep the
+    // report until the prefabs are added, it holds the assets loaded until then.
+    Preloader::Report preload(const std::vector<const Scene::Prefab*> &prefabs);
+
     double get_aspect_ratio() const { return static_cast<double>(window_width_) / window_height_; }
 
+    // Deferred shaders and the light volume mesh are loaded lazily, the G-buffer itself is
+    // allocated by the render graph only while deferred passes are added
+    void set_render_mode(RenderMode mode);
+
+    RenderMode get_render_mode() const { return render_mode_; }
+
+    // Renders offscreen at a scale picked from recent frame times to hold TARGET_FPS
+    void set_dynamic_resolution(bool enabled);
+
+    bool get_dynamic_resolution() const { return dynamic_resolution_ != nullptr; }
+
+    bool is_headless() const { return headless_; }
+
+    // Framebuffer frames are presented from, the window's or the headless offscreen one
+    GLuint get_backbuffer_fbo() const { return backbuffer_fbo_; }
+
+    // Stop after this many frames, 0 runs until the window is closed
+    void set_max_frames(unsigned int max_frames) { max_frames_ = max_frames; }
+
+    // Software backend only, the last frame is written here as a PNG
+    void set_output_image(const std::string& path) { output_image_path_ = path; }
+
+    // OpenGL backend only. Every presented frame is read back asynchronously and written to
+    // `output`, a directory of numbered PNGs or a single raw RGBA8 stream.
+    void set_frame_capture(const std::filesystem::path& output, Renderer::FrameRecorder::Format format);
+
     void poll_events() const { Input::poll(); }
 
-    void process_scene(double delta_t) {
-        assert(main_scene_);
-        main_scene_->update(delta_t);
-        main_scene_->render();
-    }
+    void process_scene(double delta_t);
 
     bool loop();
 };
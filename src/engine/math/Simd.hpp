@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace Math {
+    // Four float lanes, SSE2 or NEON where available. Comparisons return a 4 bit mask with
+    // lane 0 in the lowest bit.
+#if defined(__SSE2__)
+    struct Float4 {
+        __m128 v;
+
+        static Float4 broadcast(float x) { return {_mm_set1_ps(x)}; }
+        static Float4 ramp() { return {_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)}; }
+        static Float4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+        void store(float* p) const { _mm_storeu_ps(p, v); }
+    };
+
+    inline Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+    inline Float4 operator-(Float4 a, Float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+    inline Float4 operator*(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+    inline Float4 min(Float4 a, Float4 b) { return {_mm_min_ps(a.v, b.v)}; }
+    inline Float4 max(Float4 a, Float4 b) { return {_mm_max_ps(a.v, b.v)}; }
+    inline int greater(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmpgt_ps(a.v, b.v)); }
+    inline int equal(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmpeq_ps(a.v, b.v)); }
+    inline int less(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+#elif defined(__aarch64__)
+    struct Float4 {
+        float32x4_t v;
+
+        static Float4 broadcast(float x) { return {vdupq_n_f32(x)}; }
+
+        static Float4 ramp() {
+            const float lanes[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+            return {vld1q_f32(lanes)};
+        }
+
+        static Float4 load(const float* p) { return {vld1q_f32(p)}; }
+        void store(float* p) const { vst1q_f32(p, v); }
+    };
+
+    inline int movemask(uint32x4_t lanes) {
+        const int32x4_t shift = {0, 1, 2, 3};
+        return static_cast<int>(vaddvq_u32(vshlq_u32(vshrq_n_u32(lanes, 31), shift)));
+    }
+
+    inline Float4 operator+(Float4 a, Float4 b) { return {vaddq_f32(a.v, b.v)}; }
+    inline Float4 operator-(Float4 a, Float4 b) { return {vsubq_f32(a.v, b.v)}; }
+    inline Float4 operator*(Float4 a, Float4 b) { return {vmulq_f32(a.v, b.v)}; }
+    inline Float4 min(Float4 a, Float4 b) { return {vminq_f32(a.v, b.v)}; }
+    inline Float4 max(Float4 a, Float4 b) { return {vmaxq_f32(a.v, b.v)}; }
+    inline int greater(Float4 a, Float4 b) { return movemask(vcgtq_f32(a.v, b.v)); }
+    inline int equal(Float4 a, Float4 b) { return movemask(vceqq_f32(a.v, b.v)); }
+    inline int less(Float4 a, Float4 b) { return movemask(vcltq_f32(a.v, b.v)); }
+#else
+    struct Float4 {
+        float v[4];
+
+        static Float4 broadcast(float x) { return {{x, x, x, x}}; }
+        static Float4 ramp() { return {{0.0f, 1.0f, 2.0f, 3.0f}}; }
+        static Float4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+        void store(float* p) const { std::copy(v, v + 4, p); }
+    };
+
+    template<typename Op>
+    Float4 lanewise(Float4 a, Float4 b, Op op) {
+        return {{op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]), op(a.v[3], b.v[3])}};
+    }
+
+    template<typename Op>
+    int lanemask(Float4 a, Float4 b, Op op) {
+        int mask = 0;
+        for (int lane = 0; lane < 4; lane++) {
+            if (op(a.v[lane], b.v[lane])) mask |= 1 << lane;
+        }
+        return mask;
+    }
+
+    inline Float4 operator+(Float4 a, Float4 b) { return lanewise(a, b, [](float x, float y) { return x + y; }); }
+    inline Float4 operator-(Float4 a, Float4 b) { return lanewise(a, b, [](float x, float y) { return x - y; }); }
+    inline Float4 operator*(Float4 a, Float4 b) { return lanewise(a, b, [](float x, float y) { return x * y; }); }
+    inline Float4 min(Float4 a, Float4 b) { return lanewise(a, b, [](float x, float y) { return std::min(x, y); }); }
+    inline Float4 max(Float4 a, Float4 b) { return lanewise(a, b, [](float x, float y) { return std::max(x, y); }); }
+    inline int greater(Float4 a, Float4 b) { return lanemask(a, b, [](float x, float y) { return x > y; }); }
+    inline int equal(Float4 a, Float4 b) { return lanemask(a, b, [](float x, float y) { return x == y; }); }
+    inline int less(Float4 a, Float4 b) { return lanemask(a, b, [](float x, float y) { return x < y; }); }
+#endif
+}
@@ -9,7 +9,5 @@ public:
         : RenderedObject(model_name, shader_name, std::move(controller)) {
     }
 
-    void render(const Camera* camera, const std::vector<const LightSource*>& lights) const override;
-
     void process(double delta_t) override;
 };
@@ -4,13 +4,13 @@
 
 #include "engine/objects/LightSource.hpp"
 
-void LightSource::render(const Camera* camera, const std::vector<const LightSource*>&) const {
-    shader->use();
-    shader->set_mat4("model", get_global_transform().to_glm());
-    shader->set_mat4("view", camera->get_view_matrix().to_glm());
-    shader->set_mat4("projection", camera->get_projection_matrix().to_glm());
-    shader->set_vec3("view_pos", camera->get_global_position().to_glm());
-    shader->set_vec3("light_color", color.to_glm());
-    shader->set_vec3("material_color", color.to_glm());
-    model->render(get_global_transform(), *shader);
+void LightSource::record(Renderer::CommandBuffer& out, const Transform& global_transform) const {
+    if (!model->is_ready()) return;
+    const size_t first = out.size();
+    model->record(global_transform, *shader, out);
+    // Unlit, drawn with the light's own color instead of the model's materials
+    for (size_t i = first; i < out.size(); i++) {
+        out[i].material = nullptr;
+        out[i].color = color.to_glm();
+    }
 }
@@ -11,6 +11,7 @@ class LightSource : public RenderedObject {
 private:
     Vector3 color{1.0};
     float ambient_strength = 1;
+    float range = 1000.0f;  // Radius of the light volume used by the deferred renderer
 
 public:
     LightSource(const std::string& model_name, const Vector3& color, float ambient_strength,
@@ -27,5 +28,8 @@ public:
     float get_strength() const { return ambient_strength; }
     void set_strength(float new_strength) { ambient_strength = new_strength; }
 
-    void render(const Camera* camera, const std::vector<const LightSource*>&) const override;
+    float get_range() const { return range; }
+    void set_range(float new_range) { range = new_range; }
+
+    void record(Renderer::CommandBuffer& out, const Transform& global_transform) const override;
 };
@@ -21,6 +21,7 @@ public:
         RENDERABLE = 1 << 0,
         CAMERA = 1 << 1,
         AREA_LIGHT = 1 << 2,
+        PARTICLE_EMITTER = 1 << 3,
     };
 
 private:
@@ -0,0 +1,55 @@
+#include "engine/objects/ParticleEmitter.hpp"
+
+#include <cmath>
+
+ParticleEmitter::ParticleEmitter(const Settings& settings, unsigned int seed)
+    : settings_(settings), pool_(settings.capacity), rng_(seed) {
+    properties = properties | SceneProperties::PARTICLE_EMITTER;
+}
+
+void ParticleEmitter::process(double delta_t) {
+    const float dt = static_cast<float>(delta_t);
+    pool_.simulate(dt, settings_.acceleration, settings_.drag);
+
+    const glm::mat4 transform = get_global_transform().to_glm();
+    const glm::vec3 position(transform[3]);
+    if (!has_last_position_) {
+        last_position_ = position;
+        has_last_position_ = true;
+    }
+
+    if (emitting_ && dt > 0.0f) {
+        const glm::vec3 direction = glm::normalize(glm::mat3(transform) * settings_.direction);
+        const glm::vec3 emitter_velocity = (position - last_position_) / dt;
+
+        emit_accumulator_ += settings_.rate * dt;
+        const int n_spawn = static_cast<int>(emit_accumulator_);
+        emit_accumulator_ -= static_cast<float>(n_spawn);
+
+        for (int i = 0; i < n_spawn; i++) {
+            // Spread the frame's particles along the path the emitter moved and age them to
+            // match, otherwise a fast emitter leaves one clump per frame
+            const float t = (static_cast<float>(i) + 1.0f) / static_cast<float>(n_spawn);
+            const float age = (1.0f - t) * dt;
+
+            glm::vec3 offset;
+            do {
+                offset = {random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f)};
+            } while (glm::dot(offset, offset) > 1.0f);
+
+            glm::vec3 velocity = direction + offset * settings_.spread;
+            const float length = std::sqrt(glm::dot(velocity, velocity));
+            velocity = (length > 0.0f ? velocity / length : direction) * random(settings_.speed_min, settings_.speed_max);
+            velocity += emitter_velocity * settings_.inherit_velocity;
+
+            const float u = random(0.0f, 1.0f);
+            pool_.spawn({
+                last_position_ + (position - last_position_) * t + velocity * age,
+                velocity,
+                settings_.color_min + (settings_.color_max - settings_.color_min) * u,
+                random(settings_.lifetime_min, settings_.lifetime_max) - age,
+            });
+        }
+    }
+    last_position_ = position;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <random>
+
+#include <glm/glm.hpp>
+
+#include "engine/objects/Node.hpp"
+#include "engine/particles/ParticlePool.hpp"
+
+// Spawns particles at its global position into its own pool and simulates them every scene
+// update. Attach it as a child of the node the particles come from, e.g. an engine's
+// exhaust `LightSource`. Particles live in world space, so they trail behind a moving parent.
+class ParticleEmitter : public Node {
+public:
+    struct Settings {
+        size_t capacity = 10000;
+        float rate = 1000.0f;               // Particles per second
+        float lifetime_min = 0.5f;          // Seconds
+        float lifetime_max = 1.0f;
+        float speed_min = 1.0f;
+        float speed_max = 2.0f;
+        glm::vec3 direction{0.0f, 0.0f, 1.0f};  // Local space, follows the emitter's rotation
+        float spread = 0.2f;                // Radius of the random offset added to the unit direction
+        float inherit_velocity = 0.0f;      // Fraction of the emitter's own motion particles keep
+        glm::vec3 acceleration{0.0f};       // World space
+        float drag = 0.0f;                  // Velocity lost per second, exponential
+        glm::vec4 color_min{1.0f};          // Each particle picks a color between these
+        glm::vec4 color_max{1.0f};
+        float size = 0.1f;                  // Billboard half extent in world units
+    };
+
+private:
+    Settings settings_;
+    Particles::ParticlePool pool_;
+    std::minstd_rand rng_;
+    float emit_accumulator_ = 0.0f;
+    glm::vec3 last_position_{0.0f};
+    bool has_last_position_ = false;
+    bool emitting_ = true;
+
+    float random(float min, float max) { return std::uniform_real_distribution<float>(min, max)(rng_); }
+
+protected:
+    void process(double delta_t) override;
+
+public:
+    explicit ParticleEmitter(const Settings& settings, unsigned int seed = std::minstd_rand::default_seed);
+
+    // Stops spawning, the live particles still run out their lifetime
+    void set_emitting(bool emitting) { emitting_ = emitting; }
+    bool is_emitting() const { return emitting_; }
+
+    const Settings& get_settings() const { return settings_; }
+    const Particles::ParticlePool& get_pool() const { return pool_; }
+};
@@ -9,9 +9,6 @@
 #include "engine/resources/Model.hpp"
 #include "engine/controllers/BaseController.hpp"
 
-class LightSource;
-class Camera;
-
 
 class RenderedObject : public Node {
 protected:
@@ -28,7 +25,8 @@ public:
         : model_name(model_name), shader_name(shader_name) {
         controller_ = std::move(controller);
         properties = properties | SceneProperties::RENDERABLE;
-        model = Managers::model_manager().get(model_name);
+        // Doesn't wait for the model, the object is drawn once it has loaded
+        model = Managers::model_manager().get_async(model_name);
         shader = Managers::shader_manager().get(shader_name);
     };
 
@@ -69,5 +67,11 @@ public:
         return *this;
     }
 
-    virtual void render(const Camera* camera, const std::vector<const LightSource*>& lights) const = 0;
+    // Appends this object's draws to `out` without touching GL. `global_transform` is passed
+    // in rather than read from the node, since resolving it mutates cached transforms and
+    // recording runs on worker threads.
+    virtual void record(Renderer::CommandBuffer& out, const Transform& global_transform) const {
+        if (!model->is_ready()) return;
+        model->record(global_transform, *shader, out);
+    }
 };
@@ -0,0 +1,104 @@
+#include "engine/particles/ParticlePool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "engine/math/Simd.hpp"
+#include "engine/utilities/JobSystem.hpp"
+
+namespace Particles {
+    using Math::Float4;
+
+    namespace {
+        uint32_t pack_color(float r, float g, float b, float a) {
+            auto channel = [](float c) {
+                return static_cast<uint32_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+            };
+            return channel(r) | channel(g) << 8 | channel(b) << 16 | channel(a) << 24;
+        }
+    }
+
+    ParticlePool::ParticlePool(size_t capacity) : capacity_(capacity) {
+        // Whole SIMD groups, so the kernel never needs a scalar tail
+        const size_t padded = (capacity + 3) & ~size_t{3};
+        for (auto* array: {&pos_x_, &pos_y_, &pos_z_, &vel_x_, &vel_y_, &vel_z_, &life_, &inv_lifetime_,
+                           &color_r_, &color_g_, &color_b_, &color_a_}) {
+            array->assign(padded, 0.0f);
+        }
+    }
+
+    bool ParticlePool::spawn(const Spawn& particle) {
+        if (size_ == capacity_ || particle.lifetime <= 0.0f) {
+            dropped_ += size_ == capacity_;
+            return false;
+        }
+        const size_t i = size_++;
+        pos_x_[i] = particle.position.x;
+        pos_y_[i] = particle.position.y;
+        pos_z_[i] = particle.position.z;
+        vel_x_[i] = particle.velocity.x;
+        vel_y_[i] = particle.velocity.y;
+        vel_z_[i] = particle.velocity.z;
+        life_[i] = particle.lifetime;
+        inv_lifetime_[i] = 1.0f / particle.lifetime;
+        color_r_[i] = particle.color.r;
+        color_g_[i] = particle.color.g;
+        color_b_[i] = particle.color.b;
+        color_a_[i] = particle.color.a;
+        return true;
+    }
+
+    void ParticlePool::kill(size_t index) {
+        const size_t last = --size_;
+        for (auto* array: {&pos_x_, &pos_y_, &pos_z_, &vel_x_, &vel_y_, &vel_z_, &life_, &inv_lifetime_,
+                           &color_r_, &color_g_, &color_b_, &color_a_}) {
+            (*array)[index] = (*array)[last];
+        }
+    }
+
+    void ParticlePool::simulate(float delta_t, const glm::vec3& acceleration, float drag) {
+        if (size_ == 0) return;
+
+        const Float4 dt = Float4::broadcast(delta_t);
+        const Float4 damping = Float4::broadcast(std::exp(-drag * delta_t));
+        const Float4 accel_x = Float4::broadcast(acceleration.x * delta_t);
+        const Float4 accel_y = Float4::broadcast(acceleration.y * delta_t);
+        const Float4 accel_z = Float4::broadcast(acceleration.z * delta_t);
+
+        // Groups of four, the padding lanes past size() are integrated too and ignored
+        const size_t n_groups = (size_ + 3) / 4;
+        JobSystem::instance().parallel_for(n_groups, MIN_BATCH / 4, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin * 4; i < end * 4; i += 4) {
+                const Float4 vx = Float4::load(&vel_x_[i]) * damping + accel_x;
+                const Float4 vy = Float4::load(&vel_y_[i]) * damping + accel_y;
+                const Float4 vz = Float4::load(&vel_z_[i]) * damping + accel_z;
+                vx.store(&vel_x_[i]);
+                vy.store(&vel_y_[i]);
+                vz.store(&vel_z_[i]);
+                (Float4::load(&pos_x_[i]) + vx * dt).store(&pos_x_[i]);
+                (Float4::load(&pos_y_[i]) + vy * dt).store(&pos_y_[i]);
+                (Float4::load(&pos_z_[i]) + vz * dt).store(&pos_z_[i]);
+                (Float4::load(&life_[i]) - dt).store(&life_[i]);
+            }
+        });
+
+        // Serial, a compare per particle and a copy per dead one
+        for (size_t i = 0; i < size_;) {
+            if (life_[i] <= 0.0f) {
+                kill(i);
+            } else {
+                i++;
+            }
+        }
+    }
+
+    void ParticlePool::write_instances(Instance* out) const {
+        JobSystem::instance().parallel_for(size_, MIN_BATCH, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                const float fade = life_[i] * inv_lifetime_[i];
+                out[i] = {pos_x_[i], pos_y_[i], pos_z_[i],
+                          pack_color(color_r_[i], color_g_[i], color_b_[i], color_a_[i] * fade)};
+            }
+        });
+    }
+}
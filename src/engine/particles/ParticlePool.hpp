@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace Particles {
+    // Fixed-capacity particle storage, one array per attribute (SoA) so the integration
+    // kernel streams through exactly the data it needs, four particles per SIMD operation.
+    // Every array is allocated once, sized to the capacity rounded up to a multiple of 4.
+    // Live particles are kept packed in [0, size()): dead ones are swapped with the last
+    // live particle, so particle order is not stable.
+    class ParticlePool {
+    public:
+        // GPU instance layout written by `write_instances()`
+        struct Instance {
+            float x, y, z;
+            uint32_t color;  // RGBA8, alpha faded by remaining life
+        };
+
+        struct Spawn {
+            glm::vec3 position;
+            glm::vec3 velocity;
+            glm::vec4 color;
+            float lifetime;
+        };
+
+    private:
+        // Particles per job, below this the integration isn't worth handing off
+        static constexpr size_t MIN_BATCH = 4096;
+
+        size_t capacity_;
+        size_t size_ = 0;
+        size_t dropped_ = 0;
+
+        std::vector<float> pos_x_, pos_y_, pos_z_;
+        std::vector<float> vel_x_, vel_y_, vel_z_;
+        std::vector<float> life_;          // Seconds remaining
+        std::vector<float> inv_lifetime_;  // 1 / initial life, for the fade
+        std::vector<float> color_r_, color_g_, color_b_, color_a_;
+
+        void kill(size_t index);
+
+    public:
+        explicit ParticlePool(size_t capacity);
+
+        // Returns false, and counts a drop, if the pool is full
+        bool spawn(const Spawn& particle);
+
+        // Integrates every live particle on the job system: velocity is damped by `drag` (per
+        // second) and accelerated by `acceleration`, then particles past their lifetime are
+        // removed.
+        void simulate(float delta_t, const glm::vec3& acceleration, float drag);
+
+        // Writes the live particles to `out`, which must hold `size()` instances. Runs on the
+        // job system so it can fill a mapped GL buffer directly.
+        void write_instances(Instance* out) const;
+
+        void clear() { size_ = 0; }
+
+        size_t size() const { return size_; }
+        size_t capacity() const { return capacity_; }
+        size_t get_dropped() const { return dropped_; }
+
+        glm::vec3 get_position(size_t i) const { return {pos_x_[i], pos_y_[i], pos_z_[i]}; }
+        glm::vec3 get_velocity(size_t i) const { return {vel_x_[i], vel_y_[i], vel_z_[i]}; }
+        float get_life(size_t i) const { return life_[i]; }
+    };
+}
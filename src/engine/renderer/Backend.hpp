@@ -0,0 +1,20 @@
+#pragma once
+
+namespace Renderer {
+    enum class Backend {
+        OPENGL,
+        SOFTWARE,  // CPU rasterizer, no GL context exists
+    };
+
+    // Picked once at startup, before the application or any resource is created. Under
+    // SOFTWARE, resources skip their GL uploads and keep the CPU side data the rasterizer
+    // reads instead.
+    inline Backend& active_backend() {
+        static Backend backend = Backend::OPENGL;
+        return backend;
+    }
+
+    inline void set_backend(Backend backend) { active_backend() = backend; }
+
+    inline bool uses_gl() { return active_backend() == Backend::OPENGL; }
+}
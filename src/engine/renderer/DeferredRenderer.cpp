@@ -0,0 +1,141 @@
+#include "engine/renderer/DeferredRenderer.hpp"
+
+#include <algorithm>
+
+#include "engine/scene/Scene.hpp"
+#include "engine/resources/ResourceManager.hpp"
+
+namespace Renderer {
+    // sphere.gltf is a unit UV sphere, its faces sit slightly inside the radius
+    constexpr double LIGHT_VOLUME_PADDING = 1.1;
+
+    // G-buffer textures live above unit 0 so model materials binding `albedoTex` can't clobber them
+    constexpr unsigned int GBUFFER_FIRST_UNIT = 1;
+
+    DeferredRenderer::DeferredRenderer() {
+        geometry_shader_ = Managers::shader_manager().get("gbuffer");
+        light_shader_ = Managers::shader_manager().get("deferred_light");
+        composite_shader_ = Managers::shader_manager().get("deferred_composite");
+        light_volume_ = Managers::model_manager().get("sphere.gltf");
+
+        glGenVertexArrays(1, &fullscreen_vao_);
+    }
+
+    DeferredRenderer::~DeferredRenderer() noexcept {
+        glDeleteVertexArrays(1, &fullscreen_vao_);
+    }
+
+    void DeferredRenderer::add_render_passes(RenderGraph& graph, const Scene::Scene& scene,
+                                             const RenderTarget& target) const {
+        const Camera* camera = scene.get_camera();
+        const std::vector<const LightSource*> lights = scene.get_lights();
+        const RenderQueue* queue = &scene.record_render_queue();
+
+        FrameUniforms frame = FrameUniforms::from_scene(*camera, lights);
+        // The forward shader only ever sees one light's ambient term, use the strongest one
+        frame.ambient_strength = 0.0f;
+        for (const auto light: lights) {
+            frame.ambient_strength = std::max(frame.ambient_strength, light->get_strength());
+        }
+
+        // G-buffer textures match the target's allocation, the viewport picks the used sub-rect
+        const TextureDesc& target_desc = graph.get_desc(target.color);
+        const int width = target.viewport_width;
+        const int height = target.viewport_height;
+        const float uv_scale_x = static_cast<float>(width) / target_desc.width;
+        const float uv_scale_y = static_cast<float>(height) / target_desc.height;
+
+        RenderGraph::ResourceId albedo = 0, normal = 0, light = 0, depth = 0;
+
+        graph.add_pass("gbuffer", [&](RenderGraph::PassBuilder& builder) {
+            albedo = builder.create("gbuffer_albedo", {target_desc.width, target_desc.height, GL_RGBA8});
+            normal = builder.create("gbuffer_normal", {target_desc.width, target_desc.height, GL_RGBA16F});
+            light = builder.create("gbuffer_light", {target_desc.width, target_desc.height, GL_RGBA16F});
+            depth = builder.create("gbuffer_depth", {target_desc.width, target_desc.height, GL_DEPTH_COMPONENT32F});
+        }, [this, queue, frame, width, height](const RenderGraph::PassResources&) {
+            glViewport(0, 0, width, height);
+            queue->execute(frame, RenderQueue::Filter::LIT, geometry_shader_.get());
+        });
+
+        graph.add_pass("lighting", [&](RenderGraph::PassBuilder& builder) {
+            builder.read(albedo);
+            builder.read(normal);
+            builder.read(depth);
+            builder.write(light);
+        }, [this, lights, frame, width, height, target_desc, albedo, normal, depth](
+        const RenderGraph::PassResources& resources) {
+            glViewport(0, 0, width, height);
+            glDisable(GL_DEPTH_TEST);
+            glDepthMask(GL_FALSE);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE);
+            // Back faces only, so the volume still shades when the camera is inside it
+            glEnable(GL_CULL_FACE);
+            glCullFace(GL_FRONT);
+
+            resources.bind_texture(albedo, GBUFFER_FIRST_UNIT);
+            resources.bind_texture(normal, GBUFFER_FIRST_UNIT + 1);
+            resources.bind_texture(depth, GBUFFER_FIRST_UNIT + 2);
+            light_shader_->use();
+            light_shader_->set_int("gAlbedo", GBUFFER_FIRST_UNIT);
+            light_shader_->set_int("gNormal", GBUFFER_FIRST_UNIT + 1);
+            light_shader_->set_int("gDepth", GBUFFER_FIRST_UNIT + 2);
+            light_shader_->set_mat4("view", frame.view);
+            light_shader_->set_mat4("projection", frame.projection);
+            light_shader_->set_mat4("inv_view_projection", glm::inverse(frame.projection * frame.view));
+            light_shader_->set_vec3("view_pos", frame.view_pos);
+            light_shader_->set_vec2("screen_size", glm::vec2(
+                                        static_cast<float>(target_desc.width),
+                                        static_cast<float>(target_desc.height)));
+
+            for (const auto light_source: lights) {
+                const Vector3 light_pos = light_source->get_global_position();
+                light_shader_->set_vec3("light_pos", light_pos.to_glm());
+                light_shader_->set_vec3("light_color", light_source->get_color().to_glm());
+                light_shader_->set_float("light_range", light_source->get_range());
+
+                Transform volume(1.0);
+                volume.translate(light_pos);
+                volume.scale(Vector3(light_source->get_range() * LIGHT_VOLUME_PADDING));
+                light_volume_->render(volume, *light_shader_);
+            }
+
+            glCullFace(GL_BACK);
+            glDisable(GL_CULL_FACE);
+            glDisable(GL_BLEND);
+            glDepthMask(GL_TRUE);
+            glEnable(GL_DEPTH_TEST);
+        });
+
+        graph.add_pass("composite", [&](RenderGraph::PassBuilder& builder) {
+            builder.read(light);
+            builder.read(depth);
+            builder.write(target);
+        }, [this, width, height, uv_scale_x, uv_scale_y, light, depth](const RenderGraph::PassResources& resources) {
+            glViewport(0, 0, width, height);
+            resources.bind_texture(light, GBUFFER_FIRST_UNIT);
+            resources.bind_texture(depth, GBUFFER_FIRST_UNIT + 1);
+            composite_shader_->use();
+            composite_shader_->set_int("gLight", GBUFFER_FIRST_UNIT);
+            composite_shader_->set_int("gDepth", GBUFFER_FIRST_UNIT + 1);
+            composite_shader_->set_vec2("uv_scale", glm::vec2(uv_scale_x, uv_scale_y));
+
+            glDepthFunc(GL_ALWAYS);
+            glBindVertexArray(fullscreen_vao_);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glBindVertexArray(0);
+            glDepthFunc(GL_LESS);
+        });
+
+        // Light source meshes are unlit and stay forward shaded
+        graph.add_pass("unlit", [&](RenderGraph::PassBuilder& builder) {
+            builder.write(target);
+        }, [queue, frame, width, height](const RenderGraph::PassResources&) {
+            glViewport(0, 0, width, height);
+            queue->execute(frame, RenderQueue::Filter::UNLIT);
+        });
+
+        scene.add_skybox_pass(graph, target);
+        scene.add_particle_pass(graph, target);
+    }
+}
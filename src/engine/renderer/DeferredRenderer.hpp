@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+
+#include "engine/renderer/GL.hpp"
+
+#include "engine/renderer/RenderGraph.hpp"
+#include "engine/resources/Shader.hpp"
+#include "engine/resources/Model.hpp"
+
+namespace Scene {
+    class Scene;
+}
+
+namespace Renderer {
+    // Deferred alternative to the forward scene passes.
+    //
+    // 1. Geometry pass: the scene's lit draw commands are executed once into the G-buffer.
+    //    The light target is seeded with the ambient term.
+    // 2. Light pass: each `LightSource` is drawn as a sphere volume (`sphere.gltf`) scaled to
+    //    its range and additively blended into the light target.
+    // 3. Composite: the light target is copied to the target along with the G-buffer depth,
+    //    the light source meshes are forward shaded on top and the skybox fills the rest.
+    //    Particles are blended over the result.
+    //
+    // G-buffer layout, all transient render graph textures:
+    //  albedo  RGBA8    rgb = diffuse * texture, a = specular intensity
+    //  normal  RGBA16F  xyz = world space normal, w = shininess
+    //  light   RGBA16F  accumulated lighting
+    //  depth   DEPTH_COMPONENT32F, world positions are reconstructed from it and the game's
+    //          far plane is 10000 units out
+    class DeferredRenderer {
+    private:
+        std::shared_ptr<Shader> geometry_shader_;
+        std::shared_ptr<Shader> light_shader_;
+        std::shared_ptr<Shader> composite_shader_;
+        std::shared_ptr<Model::Model> light_volume_;
+
+        GLuint fullscreen_vao_ = 0;  // Attribute-less VAO, the triangle is generated from gl_VertexID
+
+    public:
+        DeferredRenderer();
+
+        ~DeferredRenderer() noexcept;
+
+        DeferredRenderer(const DeferredRenderer&) = delete;
+
+        DeferredRenderer& operator=(const DeferredRenderer&) = delete;
+
+        void add_render_passes(RenderGraph& graph, const Scene::Scene& scene, const RenderTarget& target) const;
+    };
+}
@@ -0,0 +1,68 @@
+#include "engine/renderer/DynamicResolution.hpp"
+
+#include <algorithm>
+
+#include "engine/resources/ResourceManager.hpp"
+
+namespace Renderer {
+    DynamicResolution::DynamicResolution(int window_width, int window_height, double budget_ms)
+        : controller_(budget_ms, 0.5, 1.0, GpuTimer::RING_SIZE),
+          window_width_(window_width),
+          window_height_(window_height),
+          scaled_width_(window_width),
+          scaled_height_(window_height) {
+        upscale_shader_ = Managers::shader_manager().get("upscale");
+        glGenVertexArrays(1, &fullscreen_vao_);
+        apply_scale(controller_.get_scale());
+    }
+
+    DynamicResolution::~DynamicResolution() noexcept {
+        glDeleteVertexArrays(1, &fullscreen_vao_);
+    }
+
+    void DynamicResolution::apply_scale(double scale) {
+        scaled_width_ = std::max(1, static_cast<int>(window_width_ * scale));
+        scaled_height_ = std::max(1, static_cast<int>(window_height_ * scale));
+    }
+
+    RenderTarget DynamicResolution::create_scene_target(RenderGraph& graph) const {
+        RenderTarget target;
+        target.color = graph.create_texture("scene_color", {window_width_, window_height_, GL_RGBA8});
+        target.depth = graph.create_texture("scene_depth", {window_width_, window_height_, GL_DEPTH_COMPONENT24});
+        target.viewport_width = scaled_width_;
+        target.viewport_height = scaled_height_;
+        return target;
+    }
+
+    void DynamicResolution::add_upscale_pass(RenderGraph& graph, const RenderTarget& scene_target,
+                                             RenderGraph::ResourceId output) const {
+        const glm::vec2 uv_scale(static_cast<float>(scaled_width_) / window_width_,
+                                 static_cast<float>(scaled_height_) / window_height_);
+        const RenderGraph::ResourceId scene_color = scene_target.color;
+
+        graph.add_pass("upscale", [&](RenderGraph::PassBuilder& builder) {
+            builder.read(scene_color);
+            builder.write(output);
+        }, [this, uv_scale, scene_color](const RenderGraph::PassResources& resources) {
+            resources.bind_texture(scene_color, 0);
+            upscale_shader_->use();
+            upscale_shader_->set_int("scene", 0);
+            upscale_shader_->set_vec2("uv_scale", uv_scale);
+
+            glDisable(GL_DEPTH_TEST);
+            glBindVertexArray(fullscreen_vao_);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glBindVertexArray(0);
+            glEnable(GL_DEPTH_TEST);
+        });
+    }
+
+    void DynamicResolution::update_scale() {
+        double gpu_ms = gpu_timer_.poll_ms();
+        if (gpu_ms >= 0.0) {
+            gpu_times_ms_.push(static_cast<float>(gpu_ms));
+        }
+
+        apply_scale(controller_.update(cpu_times_ms_, gpu_times_ms_));
+    }
+}
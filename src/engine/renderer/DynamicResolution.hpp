@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+
+#include "engine/renderer/GL.hpp"
+
+#include "engine/renderer/GpuTimer.hpp"
+#include "engine/renderer/RenderGraph.hpp"
+#include "engine/renderer/ResolutionController.hpp"
+#include "engine/resources/Shader.hpp"
+#include "engine/utilities/Utils.hpp"
+
+namespace Renderer {
+    // Renders the scene into an offscreen target at a fraction of the window resolution and
+    // upscales it to the window. The target is described at full size and the scene is drawn
+    // into a scaled sub-rect of it, so changing the scale never reallocates the render
+    // graph's pooled textures.
+    class DynamicResolution {
+    private:
+        GpuTimer gpu_timer_;
+        ResolutionController controller_;
+
+        Utils::CircularBuffer cpu_times_ms_{32};
+        Utils::CircularBuffer gpu_times_ms_{32};
+
+        std::shared_ptr<Shader> upscale_shader_;
+        GLuint fullscreen_vao_ = 0;
+
+        int window_width_;
+        int window_height_;
+        int scaled_width_;
+        int scaled_height_;
+
+        void apply_scale(double scale);
+
+    public:
+        DynamicResolution(int window_width, int window_height, double budget_ms);
+
+        ~DynamicResolution() noexcept;
+
+        DynamicResolution(const DynamicResolution&) = delete;
+
+        DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+        // Full size color and depth textures with the scaled viewport
+        RenderTarget create_scene_target(RenderGraph& graph) const;
+
+        void add_upscale_pass(RenderGraph& graph, const RenderTarget& scene_target, RenderGraph::ResourceId output) const;
+
+        // Bracket the graph's execution with the GPU timer
+        void begin_frame() { gpu_timer_.begin(); }
+
+        void end_frame() { gpu_timer_.end(); }
+
+        // CPU time spent building the frame, excluding the swap
+        void record_cpu_time(double cpu_ms) { cpu_times_ms_.push(static_cast<float>(cpu_ms)); }
+
+        // Polls finished GPU timings and lets the controller pick the next scale
+        void update_scale();
+
+        int get_scaled_width() const { return scaled_width_; }
+        int get_scaled_height() const { return scaled_height_; }
+        double get_scale() const { return controller_.get_scale(); }
+    };
+}
@@ -0,0 +1,175 @@
+#include "engine/renderer/FrameRecorder.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <stb_image_write.h>
+
+namespace Renderer {
+    FrameRecorder::FrameRecorder(std::filesystem::path output, Format format, int width, int height)
+        : output_(std::move(output)), format_(format), width_(width), height_(height) {
+        if (format_ == Format::PNG) {
+            std::filesystem::create_directories(output_);
+        } else {
+            if (output_.has_parent_path()) {
+                std::filesystem::create_directories(output_.parent_path());
+            }
+            raw_stream_.open(output_, std::ios::binary | std::ios::trunc);
+            if (!raw_stream_) {
+                throw std::runtime_error("Failed to open capture stream " + output_.string());
+            }
+        }
+
+        for (auto& slot: slots_) {
+            glGenBuffers(1, &slot.pbo);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(frame_bytes()), nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        writer_ = std::thread(&FrameRecorder::writer_loop, this);
+    }
+
+    FrameRecorder::~FrameRecorder() noexcept {
+        finish();
+        for (auto& slot: slots_) {
+            glDeleteBuffers(1, &slot.pbo);
+        }
+    }
+
+    void FrameRecorder::capture(GLuint fbo) {
+        assert(!finished_);
+        collect(false);
+
+        Slot& slot = slots_[next_slot_];
+        if (slot.fence) {
+            // The GPU is more than RING_SIZE frames behind, drop this frame rather than block
+            dropped_frames_++;
+            frame_index_++;
+            return;
+        }
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        // Into the bound PBO, so this only queues the copy
+        glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.frame = frame_index_++;
+        next_slot_ = (next_slot_ + 1) % RING_SIZE;
+    }
+
+    void FrameRecorder::collect(bool wait) {
+        for (size_t i = 0; i < RING_SIZE; i++) {
+            Slot& slot = slots_[(next_slot_ + i) % RING_SIZE];
+            if (!slot.fence) continue;
+
+            if (wait) {
+                while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+            } else {
+                // Zero timeout only polls, the flush makes sure the fence is ever reached when
+                // nothing is presented (headless)
+                const GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+                // Later slots were fenced after this one, so stop to keep frames in order
+                if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return;
+            }
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                if (queue_.size() >= MAX_QUEUED_FRAMES && !wait) {
+                    dropped_frames_++;
+                    continue;
+                }
+            }
+
+            Frame frame;
+            frame.index = slot.frame;
+            frame.pixels.resize(frame_bytes());
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                                  static_cast<GLsizeiptr>(frame_bytes()), GL_MAP_READ_BIT);
+            if (mapped) {
+                std::memcpy(frame.pixels.data(), mapped, frame_bytes());
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            if (!mapped) {
+                printf("ERROR — Failed to map capture buffer for frame %u\n", slot.frame);
+                dropped_frames_++;
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                queue_.push_back(std::move(frame));
+            }
+            queue_cv_.notify_one();
+        }
+    }
+
+    void FrameRecorder::finish() {
+        if (finished_) return;
+        finished_ = true;
+
+        collect(true);
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stopping_ = true;
+        }
+        queue_cv_.notify_one();
+        writer_.join();
+        if (raw_stream_.is_open()) {
+            raw_stream_.close();
+        }
+    }
+
+    void FrameRecorder::writer_loop() {
+        while (true) {
+            Frame frame;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex_);
+                queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                frame = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            write_frame(frame);
+        }
+    }
+
+    void FrameRecorder::write_frame(Frame& frame) {
+        // GL rows start at the bottom, images at the top
+        const size_t row_bytes = static_cast<size_t>(width_) * 4;
+        for (int y = 0; y < height_ / 2; y++) {
+            std::swap_ranges(frame.pixels.begin() + y * row_bytes,
+                             frame.pixels.begin() + (y + 1) * row_bytes,
+                             frame.pixels.begin() + (height_ - 1 - y) * row_bytes);
+        }
+
+        if (format_ == Format::RAW) {
+            raw_stream_.write(reinterpret_cast<const char*>(frame.pixels.data()),
+                              static_cast<std::streamsize>(frame.pixels.size()));
+            if (!raw_stream_) {
+                printf("ERROR — Failed to write frame %u to %s\n", frame.index, output_.string().c_str());
+                return;
+            }
+        } else {
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%05u.png", frame.index);
+            const std::string path = (output_ / name).string();
+            if (!stbi_write_png(path.c_str(), width_, height_, 4, frame.pixels.data(), static_cast<int>(row_bytes))) {
+                printf("ERROR — Failed to write %s\n", path.c_str());
+                return;
+            }
+        }
+        written_frames_++;
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "engine/renderer/GL.hpp"
+
+namespace Renderer {
+    // Captures frames without stalling the pipeline. Each `capture()` starts an asynchronous
+    // glReadPixels into one of a ring of pixel buffer objects and fences it. The pixels are
+    // mapped once the fence has signalled, a couple of frames later, and handed to a writer
+    // thread that encodes them. The writer has its own thread rather than using the job
+    // system so a slow PNG encode never delays the frame's render recording.
+    //
+    // Nothing on the GL thread ever waits. If a ring slot is still in flight when it comes
+    // up again, or the writer has fallen too far behind, the frame is dropped and counted.
+    class FrameRecorder {
+    public:
+        enum class Format {
+            PNG,  // One numbered image per frame in the output directory
+            RAW,  // RGBA8 frames appended to one file, top row first
+        };
+
+    private:
+        struct Slot {
+            GLuint pbo = 0;
+            GLsync fence = nullptr;
+            unsigned int frame = 0;
+        };
+
+        struct Frame {
+            unsigned int index = 0;
+            std::vector<unsigned char> pixels;
+        };
+
+        static constexpr size_t RING_SIZE = 3;
+        static constexpr size_t MAX_QUEUED_FRAMES = 8;
+
+        const std::filesystem::path output_;
+        const Format format_;
+        const int width_;
+        const int height_;
+
+        std::array<Slot, RING_SIZE> slots_{};
+        size_t next_slot_ = 0;  // Also the oldest slot in flight
+        unsigned int frame_index_ = 0;
+        unsigned int dropped_frames_ = 0;
+        bool finished_ = false;
+
+        std::thread writer_;
+        std::mutex queue_mutex_;
+        std::condition_variable queue_cv_;
+        std::deque<Frame> queue_;
+        bool stopping_ = false;
+        std::atomic<unsigned int> written_frames_{0};
+        std::ofstream raw_stream_;
+
+        size_t frame_bytes() const { return static_cast<size_t>(width_) * height_ * 4; }
+
+        // Reads back finished slots oldest first, stopping at the first one still in flight
+        void collect(bool wait);
+
+        void writer_loop();
+
+        void write_frame(Frame& frame);
+
+    public:
+        FrameRecorder(std::filesystem::path output, Format format, int width, int height);
+
+        ~FrameRecorder() noexcept;
+
+        FrameRecorder(const FrameRecorder&) = delete;
+
+        FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+        // Call after the frame is drawn and before the buffer swap
+        void capture(GLuint fbo);
+
+        // Waits for the frames in flight and for the writer to drain
+        void finish();
+
+        unsigned int get_written_frames() const { return written_frames_; }
+        unsigned int get_dropped_frames() const { return dropped_frames_; }
+    };
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+// OpenGL 3.3 core declarations. macOS exports the entry points from the OpenGL framework,
+// on Linux libGL (including Mesa's llvmpipe) exports them when prototypes are requested.
+#if defined(__APPLE__)
+#include <OpenGL/gl3.h>
+#else
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+#include <GL/glcorearb.h>
+#endif
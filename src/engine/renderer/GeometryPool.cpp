@@ -0,0 +1,366 @@
+#include "engine/renderer/GeometryPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace Renderer {
+    size_t vertex_stride(VertexFormat format) {
+        switch (format) {
+            case VertexFormat::POSITION_NORMAL_UV:
+                return 8 * sizeof(float);
+            case VertexFormat::QUANTIZED:
+                return 8 * sizeof(int16_t);
+        }
+        throw std::runtime_error("Unknown vertex format");
+    }
+
+    size_t index_size(IndexType type) {
+        return type == IndexType::UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    }
+
+    static GLenum gl_index_type(IndexType type) {
+        return type == IndexType::UINT16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+
+    void set_vertex_attributes(VertexFormat format) {
+        const GLsizei stride = static_cast<GLsizei>(vertex_stride(format));
+        switch (format) {
+            case VertexFormat::POSITION_NORMAL_UV:
+                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*) 0);
+                glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*) (3 * sizeof(float)));
+                glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*) (6 * sizeof(float)));
+                break;
+            case VertexFormat::QUANTIZED:
+                // x y z and a padding short, so the normal starts 4 byte aligned
+                glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (void*) 0);
+                glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*) (4 * sizeof(int16_t)));
+                glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*) (6 * sizeof(int16_t)));
+                break;
+        }
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+    }
+
+    static int16_t to_snorm16(float value) {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    glm::vec2 encode_octahedral(const glm::vec3& normal) {
+        const float l1 = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+        if (l1 == 0.0f) return glm::vec2(0.0f);
+        glm::vec2 p(normal.x / l1, normal.y / l1);
+        if (normal.z < 0.0f) {
+            // Fold the lower hemisphere over the diagonals
+            const glm::vec2 folded(1.0f - std::fabs(p.y), 1.0f - std::fabs(p.x));
+            p = glm::vec2(p.x >= 0.0f ? folded.x : -folded.x, p.y >= 0.0f ? folded.y : -folded.y);
+        }
+        return p;
+    }
+
+    glm::vec3 decode_octahedral(const glm::vec2& encoded) {
+        glm::vec3 n(encoded.x, encoded.y, 1.0f - std::fabs(encoded.x) - std::fabs(encoded.y));
+        const float t = std::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -t : t;
+        n.y += n.y >= 0.0f ? -t : t;
+        return glm::normalize(n);
+    }
+
+    uint16_t float_to_half(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        const uint32_t sign = (bits >> 16) & 0x8000;
+        const int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        if (exponent >= 31) {
+            // Overflow to infinity, NaN stays NaN
+            const bool nan = ((bits >> 23) & 0xFF) == 0xFF && mantissa != 0;
+            return static_cast<uint16_t>(sign | 0x7C00 | (nan ? 0x200 : 0));
+        }
+        if (exponent <= 0) {
+            // Subnormal or zero
+            if (exponent < -10) return static_cast<uint16_t>(sign);
+            mantissa |= 0x800000;
+            const int shift = 14 - exponent;
+            uint32_t half = mantissa >> shift;
+            if ((mantissa >> (shift - 1)) & 1) half++;  // Round half up
+            return static_cast<uint16_t>(sign | half);
+        }
+        uint32_t half = sign | static_cast<uint32_t>(exponent) << 10 | mantissa >> 13;
+        if (mantissa & 0x1000) half++;  // Round half up, carries into the exponent correctly
+        return static_cast<uint16_t>(half);
+    }
+
+    float half_to_float(uint16_t half) {
+        const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+        const uint32_t exponent = (half >> 10) & 0x1F;
+        const uint32_t mantissa = half & 0x3FF;
+        float value;
+        if (exponent == 0) {
+            value = std::ldexp(static_cast<float>(mantissa), -24);
+        } else if (exponent == 31) {
+            value = mantissa ? std::numeric_limits<float>::quiet_NaN() : std::numeric_limits<float>::infinity();
+        } else {
+            value = std::ldexp(static_cast<float>(mantissa | 0x400), static_cast<int>(exponent) - 25);
+        }
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits |= sign;
+        std::memcpy(&value, &bits, sizeof(bits));
+        return value;
+    }
+
+    std::vector<unsigned char> pack_vertices(VertexFormat format, const float* data, size_t n_vertices,
+                                             glm::mat4& dequantize) {
+        dequantize = glm::mat4(1.0f);
+        std::vector<unsigned char> out(n_vertices * vertex_stride(format));
+        if (format == VertexFormat::POSITION_NORMAL_UV) {
+            if (n_vertices > 0) std::memcpy(out.data(), data, out.size());
+            return out;
+        }
+
+        glm::vec3 min(std::numeric_limits<float>::max()), max(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < n_vertices; i++) {
+            const glm::vec3 position(data[i * 8], data[i * 8 + 1], data[i * 8 + 2]);
+            min = glm::min(min, position);
+            max = glm::max(max, position);
+        }
+        glm::vec3 center(0.0f), extent(1.0f);
+        if (n_vertices > 0) {
+            center = (min + max) * 0.5f;
+            extent = (max - min) * 0.5f;
+            // A flat axis would divide by zero, any scale reproduces it
+            for (int axis = 0; axis < 3; axis++) {
+                if (extent[axis] <= 0.0f) extent[axis] = 1.0f;
+            }
+        }
+        dequantize[0][0] = extent.x;
+        dequantize[1][1] = extent.y;
+        dequantize[2][2] = extent.z;
+        dequantize[3] = glm::vec4(center, 1.0f);
+
+        for (size_t i = 0; i < n_vertices; i++) {
+            const float* vertex = data + i * 8;
+            int16_t packed[8];
+            for (int axis = 0; axis < 3; axis++) packed[axis] = to_snorm16((vertex[axis] - center[axis]) / extent[axis]);
+            packed[3] = 0;
+            const glm::vec2 normal = encode_octahedral(glm::vec3(vertex[3], vertex[4], vertex[5]));
+            packed[4] = to_snorm16(normal.x);
+            packed[5] = to_snorm16(normal.y);
+            const uint16_t u = float_to_half(vertex[6]), v = float_to_half(vertex[7]);
+            std::memcpy(&packed[6], &u, sizeof(u));
+            std::memcpy(&packed[7], &v, sizeof(v));
+            std::memcpy(out.data() + i * sizeof(packed), packed, sizeof(packed));
+        }
+        return out;
+    }
+
+    GeometryPool::GeometryPool(VertexFormat format, IndexType index_type)
+        : format_(format),
+          index_type_(index_type),
+          stride_(vertex_stride(format)),
+          index_size_(index_size(index_type)) {
+    }
+
+    GeometryPool::~GeometryPool() noexcept {
+        for (const auto& arena: arenas_) {
+            glDeleteVertexArrays(1, &arena->vao);
+            glDeleteBuffers(1, &arena->vbo);
+            glDeleteBuffers(1, &arena->ebo);
+        }
+    }
+
+    static std::array<std::unique_ptr<GeometryPool>, VERTEX_FORMAT_COUNT * 2>& pools() {
+        static std::array<std::unique_ptr<GeometryPool>, VERTEX_FORMAT_COUNT * 2> pools;
+        return pools;
+    }
+
+    GeometryPool& GeometryPool::instance(VertexFormat format, IndexType index_type) {
+        auto& pool = pools()[static_cast<size_t>(format) * 2 + static_cast<size_t>(index_type)];
+        if (!pool) {
+            pool = std::make_unique<GeometryPool>(format, index_type);
+        }
+        return *pool;
+    }
+
+    size_t GeometryPool::defragment_all() {
+        size_t n_packed = 0;
+        for (const auto& pool: pools()) {
+            if (pool) n_packed += pool->defragment();
+        }
+        return n_packed;
+    }
+
+    GeometryPool::Arena& GeometryPool::create_arena(size_t n_vertices, size_t n_indices) {
+        auto arena = std::make_unique<Arena>(n_vertices, n_indices);
+
+        glGenVertexArrays(1, &arena->vao);
+        glGenBuffers(1, &arena->vbo);
+        glGenBuffers(1, &arena->ebo);
+
+        glBindVertexArray(arena->vao);
+        glBindBuffer(GL_ARRAY_BUFFER, arena->vbo);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(n_vertices * stride_), nullptr, GL_STATIC_DRAW);
+        set_vertex_attributes(format_);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena->ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(n_indices * index_size_),
+                     nullptr, GL_STATIC_DRAW);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        arenas_.push_back(std::move(arena));
+        return *arenas_.back();
+    }
+
+    GeometryPool::AllocationId GeometryPool::allocate(const void* vertex_data, size_t n_vertices,
+                                                      const void* index_data, size_t n_indices) {
+        Range range;
+        range.vertex_count = n_vertices;
+        range.index_count = n_indices;
+        range.live = true;
+
+        bool placed = false;
+        for (uint32_t i = 0; i < arenas_.size() && !placed; i++) {
+            Arena& arena = *arenas_[i];
+            if (arena.vertices.largest_free_block() < n_vertices ||
+                arena.indices.largest_free_block() < n_indices) {
+                continue;
+            }
+            range.arena = i;
+            range.base_vertex = *arena.vertices.allocate(n_vertices);
+            range.first_index = *arena.indices.allocate(n_indices);
+            placed = true;
+        }
+        // Holes that only fit the mesh once packed are worth a compaction before a new arena
+        for (uint32_t i = 0; i < arenas_.size() && !placed; i++) {
+            Arena& arena = *arenas_[i];
+            if (arena.vertices.free_space() < n_vertices || arena.indices.free_space() < n_indices) continue;
+            compact(i);
+            range.arena = i;
+            range.base_vertex = *arena.vertices.allocate(n_vertices);
+            range.first_index = *arena.indices.allocate(n_indices);
+            placed = true;
+        }
+        if (!placed) {
+            Arena& arena = create_arena(std::max(ARENA_VERTICES, n_vertices), std::max(ARENA_INDICES, n_indices));
+            range.arena = static_cast<uint32_t>(arenas_.size() - 1);
+            range.base_vertex = *arena.vertices.allocate(n_vertices);
+            range.first_index = *arena.indices.allocate(n_indices);
+        }
+
+        // The copy targets aren't VAO state, unlike GL_ELEMENT_ARRAY_BUFFER
+        const Arena& arena = *arenas_[range.arena];
+        glBindBuffer(GL_COPY_WRITE_BUFFER, arena.vbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(range.base_vertex * stride_),
+                        static_cast<GLsizeiptr>(n_vertices * stride_), vertex_data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, arena.ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(range.first_index * index_size_),
+                        static_cast<GLsizeiptr>(n_indices * index_size_), index_data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        if (!free_ids_.empty()) {
+            const AllocationId id = free_ids_.back();
+            free_ids_.pop_back();
+            ranges_[id] = range;
+            return id;
+        }
+        ranges_.push_back(range);
+        return static_cast<AllocationId>(ranges_.size() - 1);
+    }
+
+    void GeometryPool::free(AllocationId id) {
+        Range& range = ranges_[id];
+        assert(range.live);
+        Arena& arena = *arenas_[range.arena];
+        arena.vertices.free(range.base_vertex, range.vertex_count);
+        arena.indices.free(range.first_index, range.index_count);
+        range.live = false;
+        free_ids_.push_back(id);
+    }
+
+    void GeometryPool::draw(AllocationId id, GLsizei instances) const {
+        const Range& range = ranges_[id];
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(range.index_count),
+                                          gl_index_type(index_type_), (void*) (range.first_index * index_size_),
+                                          instances, static_cast<GLint>(range.base_vertex));
+    }
+
+    void GeometryPool::compact(uint32_t arena_index) {
+        Arena& arena = *arenas_[arena_index];
+
+        std::vector<AllocationId> live;
+        for (AllocationId id = 0; id < ranges_.size(); id++) {
+            if (ranges_[id].live && ranges_[id].arena == arena_index) live.push_back(id);
+        }
+        std::sort(live.begin(), live.end(), [this](AllocationId a, AllocationId b) {
+            return ranges_[a].base_vertex < ranges_[b].base_vertex;
+        });
+
+        // Into fresh buffers, glCopyBufferSubData can't copy between overlapping ranges
+        GLuint vbo = 0, ebo = 0;
+        glGenBuffers(1, &vbo);
+        glGenBuffers(1, &ebo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(arena.vertices.capacity() * stride_),
+                     nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, arena.vbo);
+        size_t n_vertices = 0;
+        for (auto id: live) {
+            Range& range = ranges_[id];
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                static_cast<GLintptr>(range.base_vertex * stride_),
+                                static_cast<GLintptr>(n_vertices * stride_),
+                                static_cast<GLsizeiptr>(range.vertex_count * stride_));
+            range.base_vertex = n_vertices;
+            n_vertices += range.vertex_count;
+        }
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(arena.indices.capacity() * index_size_),
+                     nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, arena.ebo);
+        size_t n_indices = 0;
+        for (auto id: live) {
+            Range& range = ranges_[id];
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                static_cast<GLintptr>(range.first_index * index_size_),
+                                static_cast<GLintptr>(n_indices * index_size_),
+                                static_cast<GLsizeiptr>(range.index_count * index_size_));
+            range.first_index = n_indices;
+            n_indices += range.index_count;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glBindVertexArray(arena.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        set_vertex_attributes(format_);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glDeleteBuffers(1, &arena.vbo);
+        glDeleteBuffers(1, &arena.ebo);
+        arena.vbo = vbo;
+        arena.ebo = ebo;
+        arena.vertices.reset(n_vertices);
+        arena.indices.reset(n_indices);
+    }
+
+    size_t GeometryPool::defragment() {
+        size_t n_packed = 0;
+        for (uint32_t i = 0; i < arenas_.size(); i++) {
+            if (arenas_[i]->vertices.is_fragmented() || arenas_[i]->indices.is_fragmented()) {
+                compact(i);
+                n_packed++;
+            }
+        }
+        return n_packed;
+    }
+}
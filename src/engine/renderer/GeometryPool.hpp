@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "engine/renderer/GL.hpp"
+#include "engine/renderer/RangeAllocator.hpp"
+
+namespace Renderer {
+    enum class VertexFormat {
+        POSITION_NORMAL_UV,  // vec3, vec3, vec2 floats, interleaved, 32 bytes
+        // 16 bytes: positions as 16-bit snorm in the mesh's bounding box, normals
+        // octahedral-encoded in two 16-bit snorm, UVs as half floats. Shaders get the
+        // normals in `aNormal.xy` and decode them when the draw's flag says so, see
+        // `RenderQueue::DRAW_DATA_TEXELS`.
+        QUANTIZED,
+    };
+
+    constexpr size_t VERTEX_FORMAT_COUNT = 2;
+
+    enum class IndexType {
+        UINT16,  // Meshes of up to 65536 vertices, indices are relative to the base vertex
+        UINT32,
+    };
+
+    size_t vertex_stride(VertexFormat format);
+
+    size_t index_size(IndexType type);
+
+    // Sets up attribute pointers for `format` on the bound VAO, reading the bound GL_ARRAY_BUFFER
+    void set_vertex_attributes(VertexFormat format);
+
+    // Layout meshes are uploaded in, picked once at startup like the backend. Meshes whose
+    // UVs are too large for half floats stay on POSITION_NORMAL_UV either way.
+    inline VertexFormat& preferred_vertex_format() {
+        static VertexFormat format = VertexFormat::QUANTIZED;
+        return format;
+    }
+
+    // Converts `n_vertices` interleaved Pos vec3; Norm vec3; UV vec2 floats to `format`.
+    // `dequantize` maps the stored positions back to mesh space, identity for float layouts.
+    std::vector<unsigned char> pack_vertices(VertexFormat format, const float* data, size_t n_vertices,
+                                             glm::mat4& dequantize);
+
+    // Two components in [-1, 1] for a unit vector, and back
+    glm::vec2 encode_octahedral(const glm::vec3& normal);
+
+    glm::vec3 decode_octahedral(const glm::vec2& encoded);
+
+    uint16_t float_to_half(float value);
+
+    float half_to_float(uint16_t half);
+
+    // Shared vertex and index storage for every mesh of one vertex format and index type. Meshes are
+    // suballocated from a few large arenas, each a VBO + EBO pair with its own VAO, and
+    // drawn with glDrawElementsInstancedBaseVertex. Meshes in the same arena share a VAO, so the
+    // render queue only rebinds when it crosses into another arena.
+    //
+    // An allocation is an id rather than an offset: `defragment()` moves ranges around on
+    // the GPU and only the pool's table has to follow.
+    class GeometryPool {
+    public:
+        using AllocationId = uint32_t;
+        static constexpr AllocationId INVALID_ALLOCATION = UINT32_MAX;
+
+        // Default arena size, 16 MB of vertices and 8 MB of indices for POSITION_NORMAL_UV
+        // and 32-bit indices.
+        // Larger meshes get an arena of their own.
+        static constexpr size_t ARENA_VERTICES = 1 << 19;
+        static constexpr size_t ARENA_INDICES = 1 << 21;
+
+        struct Range {
+            uint32_t arena = 0;
+            size_t base_vertex = 0;
+            size_t vertex_count = 0;
+            size_t first_index = 0;
+            size_t index_count = 0;
+            bool live = false;
+        };
+
+    private:
+        struct Arena {
+            GLuint vao = 0;
+            GLuint vbo = 0;
+            GLuint ebo = 0;
+            RangeAllocator vertices;
+            RangeAllocator indices;
+
+            Arena(size_t n_vertices, size_t n_indices) : vertices(n_vertices), indices(n_indices) {}
+        };
+
+        const VertexFormat format_;
+        const IndexType index_type_;
+        const size_t stride_;
+        const size_t index_size_;
+        std::vector<std::unique_ptr<Arena>> arenas_;
+        std::vector<Range> ranges_;
+        std::vector<AllocationId> free_ids_;
+
+        Arena& create_arena(size_t n_vertices, size_t n_indices);
+
+        void compact(uint32_t arena_index);
+
+    public:
+        GeometryPool(VertexFormat format, IndexType index_type);
+
+        ~GeometryPool() noexcept;
+
+        GeometryPool(const GeometryPool&) = delete;
+
+        GeometryPool& operator=(const GeometryPool&) = delete;
+
+        static GeometryPool& instance(VertexFormat format = VertexFormat::POSITION_NORMAL_UV,
+                                      IndexType index_type = IndexType::UINT32);
+
+        // `defragment()` on every pool that exists. Returns the number of arenas packed.
+        static size_t defragment_all();
+
+        // Copies the mesh into the first arena with room, creating one if needed. The data
+        // is already in the pool's vertex format and index type.
+        AllocationId allocate(const void* vertex_data, size_t n_vertices,
+                              const void* index_data, size_t n_indices);
+
+        void free(AllocationId id);
+
+        const Range& get(AllocationId id) const { return ranges_[id]; }
+
+        GLuint get_vao(AllocationId id) const { return arenas_[ranges_[id].arena]->vao; }
+
+        // The allocation's arena VAO must be bound
+        void draw(AllocationId id, GLsizei instances = 1) const;
+
+        // Packs every fragmented arena into new buffers. Returns the number of arenas packed.
+        size_t defragment();
+
+        size_t arena_count() const { return arenas_.size(); }
+
+        VertexFormat get_format() const { return format_; }
+        IndexType get_index_type() const { return index_type_; }
+    };
+}
@@ -0,0 +1,39 @@
+#include "engine/renderer/GpuTimer.hpp"
+
+namespace Renderer {
+    void GpuTimer::begin() {
+        if (pending_[current_]) {
+            // The GPU is more than RING_SIZE frames behind, drop the oldest measurement
+            // rather than block on it
+            pending_[current_] = false;
+        }
+        glBeginQuery(GL_TIME_ELAPSED, queries_[current_]);
+        active_ = true;
+    }
+
+    void GpuTimer::end() {
+        if (!active_) return;
+        glEndQuery(GL_TIME_ELAPSED);
+        pending_[current_] = true;
+        current_ = (current_ + 1) % RING_SIZE;
+        active_ = false;
+    }
+
+    double GpuTimer::poll_ms() {
+        // Oldest in-flight query is the one `begin()` will reuse next
+        for (size_t i = 0; i < RING_SIZE; i++) {
+            size_t idx = (current_ + i) % RING_SIZE;
+            if (!pending_[idx]) continue;
+
+            GLint available = 0;
+            glGetQueryObjectiv(queries_[idx], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) return -1.0;
+
+            GLuint64 elapsed_ns = 0;
+            glGetQueryObjectui64v(queries_[idx], GL_QUERY_RESULT, &elapsed_ns);
+            pending_[idx] = false;
+            return static_cast<double>(elapsed_ns) / 1.0e6;
+        }
+        return -1.0;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "engine/renderer/GL.hpp"
+
+namespace Renderer {
+    // Measures GPU time with GL_TIME_ELAPSED queries. Results are read back a few frames
+    // late from a ring of queries so polling never stalls the pipeline.
+    class GpuTimer {
+    public:
+        // Also the most frames a result can lag behind the frame it measured
+        static constexpr size_t RING_SIZE = 4;
+
+    private:
+
+        std::array<GLuint, RING_SIZE> queries_{};
+        std::array<bool, RING_SIZE> pending_{};
+        size_t current_ = 0;
+        bool active_ = false;
+
+    public:
+        GpuTimer() { glGenQueries(RING_SIZE, queries_.data()); }
+
+        ~GpuTimer() noexcept { glDeleteQueries(RING_SIZE, queries_.data()); }
+
+        GpuTimer(const GpuTimer&) = delete;
+
+        GpuTimer& operator=(const GpuTimer&) = delete;
+
+        void begin();
+
+        void end();
+
+        // Returns the oldest finished measurement in milliseconds, or a negative value if
+        // none is ready yet.
+        double poll_ms();
+    };
+}
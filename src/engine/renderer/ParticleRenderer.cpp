@@ -0,0 +1,71 @@
+#include "engine/renderer/ParticleRenderer.hpp"
+
+#include <cstddef>
+
+#include "engine/resources/ResourceManager.hpp"
+#include "engine/resources/Shader.hpp"
+
+namespace Renderer {
+    using Instance = Particles::ParticlePool::Instance;
+
+    ParticleRenderer::ParticleRenderer() {
+        shader_ = Managers::shader_manager().get("particle");
+
+        glGenVertexArrays(1, &vao_);
+        glBindVertexArray(vao_);
+        glGenBuffers(1, &instance_vbo_);
+        glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              reinterpret_cast<void*>(offsetof(Instance, x)));
+        glEnableVertexAttribArray(0);
+        glVertexAttribDivisor(0, 1);
+
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance),
+                              reinterpret_cast<void*>(offsetof(Instance, color)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    ParticleRenderer::~ParticleRenderer() noexcept {
+        glDeleteBuffers(1, &instance_vbo_);
+        glDeleteVertexArrays(1, &vao_);
+    }
+
+    void ParticleRenderer::draw(const Particles::ParticlePool& pool, float size, const FrameUniforms& frame) const {
+        if (pool.size() == 0) return;
+
+        const GLsizeiptr bytes = static_cast<GLsizeiptr>(pool.size() * sizeof(Instance));
+        glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+        // Orphan last draw's storage so the driver doesn't wait for the GPU to finish with it
+        glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        auto* instances = static_cast<Instance*>(glMapBufferRange(
+            GL_ARRAY_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (!instances) {
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            return;
+        }
+        pool.write_instances(instances);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        shader_->use();
+        shader_->set_mat4("view", frame.view);
+        shader_->set_mat4("projection", frame.projection);
+        shader_->set_float("size", size);
+
+        glDepthMask(GL_FALSE);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+        glBindVertexArray(vao_);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(pool.size()));
+        glBindVertexArray(0);
+
+        glDisable(GL_BLEND);
+        glDepthMask(GL_TRUE);
+    }
+}
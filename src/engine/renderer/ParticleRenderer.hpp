@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+
+#include "engine/renderer/GL.hpp"
+#include "engine/renderer/RenderQueue.hpp"
+#include "engine/particles/ParticlePool.hpp"
+
+class Shader;
+
+namespace Renderer {
+    // Draws particle pools as camera facing, additively blended billboards, one instanced
+    // draw per pool. The quad corners come from gl_VertexID, so the only vertex data is the
+    // per instance position and color, streamed into an orphaned buffer every draw.
+    // Particles depth test against the scene but don't write depth.
+    class ParticleRenderer {
+    private:
+        std::shared_ptr<Shader> shader_;
+        GLuint vao_ = 0;
+        GLuint instance_vbo_ = 0;
+
+    public:
+        ParticleRenderer();
+
+        ~ParticleRenderer() noexcept;
+
+        ParticleRenderer(const ParticleRenderer&) = delete;
+
+        ParticleRenderer& operator=(const ParticleRenderer&) = delete;
+
+        void draw(const Particles::ParticlePool& pool, float size, const FrameUniforms& frame) const;
+    };
+}
@@ -0,0 +1,77 @@
+#include "engine/renderer/RangeAllocator.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Renderer {
+    RangeAllocator::RangeAllocator(size_t capacity) : capacity_(capacity), free_space_(capacity) {
+        if (capacity > 0) {
+            free_blocks_[0] = capacity;
+        }
+    }
+
+    std::optional<size_t> RangeAllocator::allocate(size_t size) {
+        if (size == 0 || size > free_space_) return std::nullopt;
+
+        auto best = free_blocks_.end();
+        for (auto it = free_blocks_.begin(); it != free_blocks_.end(); ++it) {
+            if (it->second >= size && (best == free_blocks_.end() || it->second < best->second)) {
+                best = it;
+                if (it->second == size) break;
+            }
+        }
+        if (best == free_blocks_.end()) return std::nullopt;
+
+        const size_t offset = best->first;
+        const size_t remaining = best->second - size;
+        free_blocks_.erase(best);
+        if (remaining > 0) {
+            free_blocks_[offset + size] = remaining;
+        }
+        free_space_ -= size;
+        return offset;
+    }
+
+    void RangeAllocator::free(size_t offset, size_t size) {
+        if (size == 0) return;
+        assert(offset + size <= capacity_);
+
+        size_t start = offset;
+        size_t end = offset + size;
+
+        auto next = free_blocks_.lower_bound(offset);
+        assert(next == free_blocks_.end() || next->first >= end);  // Double free
+        if (next != free_blocks_.end() && next->first == end) {
+            end += next->second;
+            next = free_blocks_.erase(next);
+        }
+        if (next != free_blocks_.begin()) {
+            auto previous = std::prev(next);
+            assert(previous->first + previous->second <= start);  // Double free
+            if (previous->first + previous->second == start) {
+                start = previous->first;
+                free_blocks_.erase(previous);
+            }
+        }
+
+        free_blocks_[start] = end - start;
+        free_space_ += size;
+    }
+
+    void RangeAllocator::reset(size_t used) {
+        assert(used <= capacity_);
+        free_blocks_.clear();
+        if (used < capacity_) {
+            free_blocks_[used] = capacity_ - used;
+        }
+        free_space_ = capacity_ - used;
+    }
+
+    size_t RangeAllocator::largest_free_block() const {
+        size_t largest = 0;
+        for (const auto& [offset, size]: free_blocks_) {
+            largest = std::max(largest, size);
+        }
+        return largest;
+    }
+}
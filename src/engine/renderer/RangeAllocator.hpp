@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+
+namespace Renderer {
+    // Hands out [offset, offset + size) ranges of a fixed-size space, in whatever unit the
+    // caller uses (vertices, indices, bytes). Free ranges are kept sorted by offset so a
+    // freed range merges with its free neighbours, and allocation picks the smallest free
+    // range that fits. Nothing here touches GL, see `GeometryPool`.
+    class RangeAllocator {
+    private:
+        size_t capacity_;
+        size_t free_space_;
+        std::map<size_t, size_t> free_blocks_;  // Offset -> size, never adjacent
+
+    public:
+        explicit RangeAllocator(size_t capacity);
+
+        // Returns the offset, or nothing if no single free range is large enough
+        std::optional<size_t> allocate(size_t size);
+
+        void free(size_t offset, size_t size);
+
+        // After the owner packed its live ranges to the front: [0, used) is allocated
+        void reset(size_t used);
+
+        size_t capacity() const { return capacity_; }
+        size_t free_space() const { return free_space_; }
+        size_t free_block_count() const { return free_blocks_.size(); }
+
+        size_t largest_free_block() const;
+
+        // Free space is split up enough that packing would noticeably help
+        bool is_fragmented() const { return free_blocks_.size() > 1 && largest_free_block() < free_space_ / 2; }
+    };
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Shader;
+
+namespace Model {
+    class Mesh;
+    class Material;
+}
+
+namespace Renderer {
+    // One recorded mesh draw. Commands are plain data with no GL calls, so they can be
+    // built on any thread and executed later on the GL thread.
+    struct DrawCommand {
+        uint64_t sort_key = 0;
+        const Shader* shader = nullptr;
+        const Model::Mesh* mesh = nullptr;
+        const Model::Material* material = nullptr;  // nullptr for unlit objects, which use `color`
+        glm::mat4 model{1.0f};
+        glm::vec3 color{1.0f};
+
+        // Orders by shader, then texture, then vertex array, to minimise state changes, and
+        // finally by mesh so instances of one mesh end up next to each other and can be batched
+        static uint64_t make_sort_key(unsigned int shader_id, unsigned int texture_id, unsigned int vao_id,
+                                      unsigned int mesh_id) {
+            return (static_cast<uint64_t>(shader_id & 0xFFFF) << 48) |
+                   (static_cast<uint64_t>(texture_id & 0xFFFF) << 32) |
+                   (static_cast<uint64_t>(vao_id & 0xFF) << 24) |
+                   static_cast<uint64_t>(mesh_id & 0xFFFFFF);
+        }
+    };
+
+    using CommandBuffer = std::vector<DrawCommand>;
+}
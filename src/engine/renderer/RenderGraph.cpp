@@ -0,0 +1,365 @@
+#include "engine/renderer/RenderGraph.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace Renderer {
+    RenderGraph::ResourceId RenderGraph::PassBuilder::create(const std::string& name, const TextureDesc& desc) {
+        return write(graph_.create_texture(name, desc));
+    }
+
+    RenderGraph::ResourceId RenderGraph::PassBuilder::read(ResourceId id) {
+        assert(id < graph_.resources_.size());
+        graph_.passes_[pass_].reads.push_back(id);
+        return id;
+    }
+
+    RenderGraph::ResourceId RenderGraph::PassBuilder::write(ResourceId id) {
+        assert(id < graph_.resources_.size());
+        graph_.passes_[pass_].writes.push_back(id);
+        return id;
+    }
+
+    void RenderGraph::PassBuilder::set_side_effect() {
+        graph_.passes_[pass_].side_effect = true;
+    }
+
+    GLuint RenderGraph::PassResources::get_texture(ResourceId id) const {
+        const Resource& resource = graph_.resources_[id];
+        assert(!resource.imported && resource.physical_slot >= 0);
+        return graph_.slot_textures_[resource.physical_slot];
+    }
+
+    void RenderGraph::PassResources::bind_texture(ResourceId id, unsigned int unit) const {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, get_texture(id));
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    const TextureDesc& RenderGraph::PassResources::get_desc(ResourceId id) const {
+        return graph_.resources_[id].desc;
+    }
+
+    RenderGraph::~RenderGraph() noexcept {
+        for (const auto& [attachments, fbo]: framebuffers_) {
+            glDeleteFramebuffers(1, &fbo);
+        }
+        for (const auto& physical: pool_) {
+            glDeleteTextures(1, &physical.texture);
+        }
+    }
+
+    void RenderGraph::reset() {
+        resources_.clear();
+        passes_.clear();
+        execution_order_.clear();
+        slot_descs_.clear();
+        compiled_ = false;
+    }
+
+    RenderGraph::ResourceId RenderGraph::create_texture(const std::string& name, const TextureDesc& desc) {
+        resources_.push_back({name, desc});
+        return resources_.size() - 1;
+    }
+
+    RenderGraph::ResourceId RenderGraph::import_framebuffer(const std::string& name, GLuint fbo, int width, int height,
+                                                           bool clear_on_first_write) {
+        Resource resource{name, {width, height, GL_RGBA8}};
+        resource.imported = true;
+        resource.imported_fbo = fbo;
+        resource.clear_on_first_write = clear_on_first_write;
+        resources_.push_back(resource);
+        return resources_.size() - 1;
+    }
+
+    RenderGraph::PassId RenderGraph::add_pass(const std::string& name, const SetupFn& setup, ExecuteFn execute) {
+        passes_.push_back({name, {}, {}, std::move(execute)});
+        PassId id = passes_.size() - 1;
+        PassBuilder builder(*this, id);
+        setup(builder);
+        compiled_ = false;
+        return id;
+    }
+
+    void RenderGraph::compile() {
+        const size_t n_passes = passes_.size();
+
+        // Cull. Walking backwards, a pass survives if it has side effects or writes something
+        // a surviving later pass reads, or writes an imported resource.
+        std::vector<bool> needed(resources_.size(), false);
+        for (size_t i = 0; i < resources_.size(); i++) {
+            needed[i] = resources_[i].imported;
+        }
+        for (size_t i = n_passes; i-- > 0;) {
+            Pass& pass = passes_[i];
+            bool alive = pass.side_effect;
+            for (auto id: pass.writes) {
+                alive = alive || needed[id];
+            }
+            pass.culled = !alive;
+            if (alive) {
+                for (auto id: pass.reads) needed[id] = true;
+            }
+        }
+
+        // Order. Dependencies come from submission order: a pass depends on the previous
+        // writer of everything it touches, and a writer depends on earlier readers of what it
+        // overwrites. Ties go to the earliest submitted pass.
+        std::vector<std::vector<PassId>> dependents(n_passes);
+        std::vector<size_t> n_dependencies(n_passes, 0);
+        std::vector<int> last_writer(resources_.size(), -1);
+        std::vector<std::vector<PassId>> readers_since_write(resources_.size());
+
+        auto add_edge = [&](PassId from, PassId to) {
+            if (from == to) return;
+            auto& edges = dependents[from];
+            if (std::find(edges.begin(), edges.end(), to) == edges.end()) {
+                edges.push_back(to);
+                n_dependencies[to]++;
+            }
+        };
+
+        for (PassId p = 0; p < n_passes; p++) {
+            const Pass& pass = passes_[p];
+            if (pass.culled) continue;
+            for (auto id: pass.reads) {
+                if (last_writer[id] >= 0) add_edge(last_writer[id], p);
+                readers_since_write[id].push_back(p);
+            }
+            for (auto id: pass.writes) {
+                if (last_writer[id] >= 0) add_edge(last_writer[id], p);
+                for (auto reader: readers_since_write[id]) add_edge(reader, p);
+                readers_since_write[id].clear();
+                last_writer[id] = static_cast<int>(p);
+            }
+        }
+
+        execution_order_.clear();
+        std::vector<PassId> ready;
+        for (PassId p = 0; p < n_passes; p++) {
+            if (!passes_[p].culled && n_dependencies[p] == 0) ready.push_back(p);
+        }
+        while (!ready.empty()) {
+            auto next = std::min_element(ready.begin(), ready.end());
+            PassId p = *next;
+            ready.erase(next);
+            execution_order_.push_back(p);
+            for (auto dependent: dependents[p]) {
+                if (--n_dependencies[dependent] == 0) ready.push_back(dependent);
+            }
+        }
+
+        // Lifetimes, in execution order positions
+        for (auto& resource: resources_) {
+            resource.first_use = -1;
+            resource.last_use = -1;
+            resource.physical_slot = -1;
+        }
+        for (size_t position = 0; position < execution_order_.size(); position++) {
+            const Pass& pass = passes_[execution_order_[position]];
+            auto touch = [&](ResourceId id) {
+                Resource& resource = resources_[id];
+                if (resource.first_use < 0) resource.first_use = static_cast<int>(position);
+                resource.last_use = static_cast<int>(position);
+            };
+            for (auto id: pass.reads) touch(id);
+            for (auto id: pass.writes) touch(id);
+        }
+
+        // Aliasing. Greedy interval assignment: in order of first use, reuse any slot with the
+        // same description whose previous occupant is already dead.
+        std::vector<ResourceId> transients;
+        for (ResourceId id = 0; id < resources_.size(); id++) {
+            if (!resources_[id].imported && resources_[id].first_use >= 0) transients.push_back(id);
+        }
+        std::stable_sort(transients.begin(), transients.end(), [this](ResourceId a, ResourceId b) {
+            return resources_[a].first_use < resources_[b].first_use;
+        });
+
+        slot_descs_.clear();
+        std::vector<int> slot_free_after;
+        for (auto id: transients) {
+            Resource& resource = resources_[id];
+            int slot = -1;
+            for (size_t s = 0; s < slot_descs_.size(); s++) {
+                if (slot_descs_[s] == resource.desc && slot_free_after[s] < resource.first_use) {
+                    slot = static_cast<int>(s);
+                    break;
+                }
+            }
+            if (slot < 0) {
+                slot_descs_.push_back(resource.desc);
+                slot_free_after.push_back(-1);
+                slot = static_cast<int>(slot_descs_.size() - 1);
+            }
+            slot_free_after[slot] = resource.last_use;
+            resource.physical_slot = slot;
+        }
+
+        compiled_ = true;
+    }
+
+    void RenderGraph::acquire_physical_textures() {
+        for (auto& physical: pool_) {
+            physical.in_use = false;
+        }
+
+        slot_textures_.assign(slot_descs_.size(), 0);
+        for (size_t slot = 0; slot < slot_descs_.size(); slot++) {
+            const TextureDesc& desc = slot_descs_[slot];
+            auto it = std::find_if(pool_.begin(), pool_.end(), [&](const PhysicalTexture& physical) {
+                return !physical.in_use && physical.desc == desc;
+            });
+
+            if (it == pool_.end()) {
+                PhysicalTexture physical{desc};
+                const bool depth = desc.is_depth();
+                glGenTextures(1, &physical.texture);
+                glBindTexture(GL_TEXTURE_2D, physical.texture);
+                glTexImage2D(GL_TEXTURE_2D, 0, desc.internal_format, desc.width, desc.height, 0,
+                             depth ? GL_DEPTH_COMPONENT : GL_RGBA,
+                             depth ? GL_FLOAT : GL_UNSIGNED_BYTE,
+                             nullptr);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, depth ? GL_NEAREST : GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, depth ? GL_NEAREST : GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glBindTexture(GL_TEXTURE_2D, 0);
+                pool_.push_back(physical);
+                it = pool_.end() - 1;
+            }
+
+            it->in_use = true;
+            it->frames_unused = 0;
+            slot_textures_[slot] = it->texture;
+        }
+    }
+
+    void RenderGraph::release_unused_textures() {
+        for (auto it = pool_.begin(); it != pool_.end();) {
+            if (!it->in_use && ++it->frames_unused > MAX_UNUSED_FRAMES) {
+                const GLuint texture = it->texture;
+                for (auto fb = framebuffers_.begin(); fb != framebuffers_.end();) {
+                    if (std::find(fb->first.begin(), fb->first.end(), texture) != fb->first.end()) {
+                        glDeleteFramebuffers(1, &fb->second);
+                        fb = framebuffers_.erase(fb);
+                    } else {
+                        ++fb;
+                    }
+                }
+                glDeleteTextures(1, &texture);
+                it = pool_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    GLuint RenderGraph::get_framebuffer(const std::vector<GLuint>& color, GLuint depth) {
+        // Depth goes last in the key so {color..., depth} identifies the attachment set
+        std::vector<GLuint> key = color;
+        key.push_back(depth);
+
+        auto it = framebuffers_.find(key);
+        if (it != framebuffers_.end()) return it->second;
+
+        GLuint fbo;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        std::vector<GLenum> draw_buffers;
+        for (size_t i = 0; i < color.size(); i++) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, color[i], 0);
+            draw_buffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+        }
+        if (depth) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+        }
+        if (draw_buffers.empty()) {
+            glDrawBuffer(GL_NONE);
+        } else {
+            glDrawBuffers(static_cast<GLsizei>(draw_buffers.size()), draw_buffers.data());
+        }
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glDeleteFramebuffers(1, &fbo);
+            throw std::runtime_error("Render graph framebuffer is incomplete");
+        }
+
+        framebuffers_[key] = fbo;
+        return fbo;
+    }
+
+    void RenderGraph::bind_pass_targets(const Pass& pass, PassId pass_id) {
+        if (pass.writes.empty()) return;
+
+        const int position = static_cast<int>(
+            std::find(execution_order_.begin(), execution_order_.end(), pass_id) - execution_order_.begin());
+        auto clears_here = [&](const Resource& resource) {
+            return resource.clear_on_first_write && resource.first_use == position;
+        };
+
+        const Resource& first = resources_[pass.writes.front()];
+        if (first.imported) {
+            // Imported framebuffers already carry their own attachments
+            for (auto id: pass.writes) {
+                assert(resources_[id].imported && resources_[id].imported_fbo == first.imported_fbo);
+            }
+            glBindFramebuffer(GL_FRAMEBUFFER, first.imported_fbo);
+            glViewport(0, 0, first.desc.width, first.desc.height);
+            if (clears_here(first)) {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            }
+            return;
+        }
+
+        std::vector<GLuint> color;
+        GLuint depth = 0;
+        for (auto id: pass.writes) {
+            const Resource& resource = resources_[id];
+            assert(!resource.imported);
+            const GLuint texture = slot_textures_[resource.physical_slot];
+            if (resource.desc.is_depth()) {
+                depth = texture;
+            } else {
+                color.push_back(texture);
+            }
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, get_framebuffer(color, depth));
+        glViewport(0, 0, first.desc.width, first.desc.height);
+
+        GLint color_index = 0;
+        for (auto id: pass.writes) {
+            const Resource& resource = resources_[id];
+            if (resource.desc.is_depth()) {
+                if (clears_here(resource)) {
+                    const GLfloat clear_depth = 1.0f;
+                    glClearBufferfv(GL_DEPTH, 0, &clear_depth);
+                }
+            } else {
+                if (clears_here(resource)) {
+                    const GLfloat clear_color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                    glClearBufferfv(GL_COLOR, color_index, clear_color);
+                }
+                color_index++;
+            }
+        }
+    }
+
+    void RenderGraph::execute() {
+        if (!compiled_) compile();
+
+        acquire_physical_textures();
+
+        const PassResources resources(*this);
+        for (auto pass_id: execution_order_) {
+            const Pass& pass = passes_[pass_id];
+            bind_pass_targets(pass, pass_id);
+            pass.execute(resources);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        release_unused_textures();
+    }
+}
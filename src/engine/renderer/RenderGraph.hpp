@@ -0,0 +1,183 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "engine/renderer/GL.hpp"
+
+namespace Renderer {
+    struct TextureDesc {
+        int width = 0;
+        int height = 0;
+        GLenum internal_format = GL_RGBA8;
+
+        bool operator==(const TextureDesc& other) const {
+            return width == other.width && height == other.height && internal_format == other.internal_format;
+        }
+
+        bool is_depth() const {
+            return internal_format == GL_DEPTH_COMPONENT16 ||
+                   internal_format == GL_DEPTH_COMPONENT24 ||
+                   internal_format == GL_DEPTH_COMPONENT32F;
+        }
+    };
+
+    // Where a group of scene passes draws: a color and depth resource (the same resource for
+    // an imported framebuffer) and the viewport to use inside them, which may be smaller than
+    // the textures when rendering at a reduced scale.
+    struct RenderTarget {
+        size_t color = 0;
+        size_t depth = 0;
+        int viewport_width = 0;
+        int viewport_height = 0;
+    };
+
+    // Frame graph for offscreen passes. Each frame passes are added with the resources they
+    // read and write, then `compile()`:
+    //  - culls passes whose output nothing consumes,
+    //  - orders the rest by their dependencies,
+    //  - assigns transient textures to pooled physical textures, letting resources with the
+    //    same description share one texture when their lifetimes don't overlap.
+    // `execute()` binds a cached framebuffer holding each pass's attachments and runs it.
+    // Physical textures and framebuffers persist across frames, so a steady-state frame does
+    // no GL allocation.
+    //
+    // Transient resources are cleared on their first write, their contents are undefined
+    // before that.
+    class RenderGraph {
+    public:
+        using ResourceId = size_t;
+        using PassId = size_t;
+
+        class PassResources {
+        private:
+            const RenderGraph& graph_;
+
+        public:
+            explicit PassResources(const RenderGraph& graph) : graph_(graph) {
+            }
+
+            GLuint get_texture(ResourceId id) const;
+
+            void bind_texture(ResourceId id, unsigned int unit) const;
+
+            const TextureDesc& get_desc(ResourceId id) const;
+        };
+
+        class PassBuilder {
+        private:
+            RenderGraph& graph_;
+            PassId pass_;
+
+        public:
+            PassBuilder(RenderGraph& graph, PassId pass) : graph_(graph), pass_(pass) {
+            }
+
+            ResourceId create(const std::string& name, const TextureDesc& desc);
+
+            ResourceId read(ResourceId id);
+
+            ResourceId write(ResourceId id);
+
+            // Writes the target's color and depth
+            void write(const RenderTarget& target) {
+                write(target.color);
+                if (target.depth != target.color) write(target.depth);
+            }
+
+            // Pass is kept even if nothing reads its output
+            void set_side_effect();
+        };
+
+        using SetupFn = std::function<void(PassBuilder&)>;
+        using ExecuteFn = std::function<void(const PassResources&)>;
+
+    private:
+        struct Resource {
+            std::string name;
+            TextureDesc desc;
+            bool imported = false;
+            GLuint imported_fbo = 0;
+            bool clear_on_first_write = true;
+
+            // Filled in by compile()
+            int first_use = -1;
+            int last_use = -1;
+            int physical_slot = -1;
+        };
+
+        struct Pass {
+            std::string name;
+            std::vector<ResourceId> reads;
+            std::vector<ResourceId> writes;
+            ExecuteFn execute;
+            bool side_effect = false;
+            bool culled = false;
+        };
+
+        struct PhysicalTexture {
+            TextureDesc desc;
+            GLuint texture = 0;
+            unsigned int frames_unused = 0;
+            bool in_use = false;
+        };
+
+        // Pooled textures unused for this many frames are released, e.g. after a resize
+        static constexpr unsigned int MAX_UNUSED_FRAMES = 60;
+
+        std::vector<Resource> resources_;
+        std::vector<Pass> passes_;
+        std::vector<PassId> execution_order_;
+        std::vector<TextureDesc> slot_descs_;
+        bool compiled_ = false;
+
+        std::vector<PhysicalTexture> pool_;
+        std::vector<GLuint> slot_textures_;
+        std::map<std::vector<GLuint>, GLuint> framebuffers_;
+
+        void acquire_physical_textures();
+
+        void release_unused_textures();
+
+        GLuint get_framebuffer(const std::vector<GLuint>& color, GLuint depth);
+
+        void bind_pass_targets(const Pass& pass, PassId pass_id);
+
+    public:
+        RenderGraph() = default;
+
+        ~RenderGraph() noexcept;
+
+        RenderGraph(const RenderGraph&) = delete;
+
+        RenderGraph& operator=(const RenderGraph&) = delete;
+
+        // Drops this frame's passes and resources. Pooled GL objects are kept.
+        void reset();
+
+        // Declares a transient texture without a producer, the first pass to write it creates it
+        ResourceId create_texture(const std::string& name, const TextureDesc& desc);
+
+        // Registers an existing framebuffer (e.g. the window, fbo 0). Imported resources are
+        // never culled or aliased.
+        ResourceId import_framebuffer(const std::string& name, GLuint fbo, int width, int height,
+                                      bool clear_on_first_write = true);
+
+        PassId add_pass(const std::string& name, const SetupFn& setup, ExecuteFn execute);
+
+        const TextureDesc& get_desc(ResourceId id) const { return resources_[id].desc; }
+
+        void compile();
+
+        void execute();
+
+        const std::vector<PassId>& get_execution_order() const { return execution_order_; }
+        bool is_culled(PassId pass) const { return passes_[pass].culled; }
+
+        // Physical texture slot a transient resource was assigned, -1 if it is unused or imported
+        int get_physical_slot(ResourceId id) const { return resources_[id].physical_slot; }
+        size_t get_physical_slot_count() const { return slot_descs_.size(); }
+    };
+}
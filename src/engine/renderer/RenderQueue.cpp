@@ -0,0 +1,229 @@
+#include "engine/renderer/RenderQueue.hpp"
+
+#include <algorithm>
+
+#include "engine/renderer/TextureStreamer.hpp"
+#include "engine/scene/Scene.hpp"
+#include "engine/utilities/JobSystem.hpp"
+
+namespace Renderer {
+    FrameUniforms FrameUniforms::from_scene(const Camera& camera, const std::vector<const LightSource*>& lights) {
+        FrameUniforms frame;
+        frame.view = camera.get_view_matrix().to_glm();
+        frame.projection = camera.get_projection_matrix().to_glm();
+        frame.view_pos = camera.get_global_position().to_glm();
+        // The forward shader takes a single light, matching the old per-object loop the last one wins
+        if (!lights.empty()) {
+            frame.light_pos = lights.back()->get_global_position().to_glm();
+            frame.light_color = lights.back()->get_color().to_glm();
+            frame.ambient_strength = lights.back()->get_strength();
+        }
+        return frame;
+    }
+
+    RenderQueue::~RenderQueue() noexcept {
+        if (draw_data_texture_) glDeleteTextures(1, &draw_data_texture_);
+        if (draw_data_buffer_) glDeleteBuffers(1, &draw_data_buffer_);
+    }
+
+    static void write_draw_data(const DrawCommand& command, glm::vec4* out) {
+        // Quantized positions are dequantized by the model matrix itself
+        const glm::mat4 model = command.mesh ? command.model * command.mesh->get_dequantize() : command.model;
+        for (int i = 0; i < 4; i++) {
+            out[i] = model[i];
+        }
+        // Normals need the inverse transpose once the model matrix scales non-uniformly.
+        // The dequantize scale only applies to positions, so it's left out here.
+        const glm::mat4 normal = glm::transpose(glm::inverse(command.model));
+        for (int i = 0; i < 3; i++) {
+            out[4 + i] = glm::vec4(glm::vec3(normal[i]), 0.0f);
+        }
+        out[4].w = command.mesh && command.mesh->has_octahedral_normals() ? 1.0f : 0.0f;
+
+        if (const Model::Material* material = command.material) {
+            out[7] = glm::vec4(material->get_ambient().to_glm(), 0.0f);
+            out[8] = glm::vec4(material->get_diffuse().to_glm(), 0.0f);
+            out[9] = glm::vec4(material->get_specular().to_glm(), material->get_shininess());
+        } else {
+            out[7] = glm::vec4(command.color, 0.0f);
+            out[8] = glm::vec4(command.color, 0.0f);
+            out[9] = glm::vec4(0.0f);
+        }
+    }
+
+    static void request_texture_level(const TextureStreamer& streamer, const DrawCommand& command) {
+        if (!command.mesh || !command.material || !command.material->has_texture()) return;
+        Texture& texture = *command.material->get_texture();
+        if (!texture.streaming) return;
+
+        // World space sphere, scaled by the largest axis scale so it stays conservative
+        const glm::vec4& sphere = command.mesh->get_bounding_sphere();
+        const glm::vec3 center = glm::vec3(command.model * glm::vec4(glm::vec3(sphere), 1.0f));
+        const float scale = std::max({glm::length(glm::vec3(command.model[0])),
+                                      glm::length(glm::vec3(command.model[1])),
+                                      glm::length(glm::vec3(command.model[2]))});
+        streamer.request(texture, center, sphere.w * scale);
+    }
+
+    void RenderQueue::record(const Scene::Scene& scene) {
+        renderables_ = scene.get_renderables();
+
+        // Global transforms are lazily cached on the nodes, so resolve them here before
+        // handing the list to workers
+        transforms_.clear();
+        transforms_.reserve(renderables_.size());
+        for (const auto rendered: renderables_) {
+            transforms_.push_back(rendered->get_global_transform());
+        }
+
+        JobSystem& jobs = JobSystem::instance();
+        worker_buffers_.resize(jobs.worker_count());
+        for (auto& buffer: worker_buffers_) {
+            buffer.clear();
+        }
+
+        jobs.parallel_for(renderables_.size(), MIN_BATCH, [this](size_t begin, size_t end, size_t worker) {
+            CommandBuffer& buffer = worker_buffers_[worker];
+            for (size_t i = begin; i < end; i++) {
+                renderables_[i]->record(buffer, transforms_[i]);
+            }
+        });
+
+        commands_.clear();
+        for (const auto& buffer: worker_buffers_) {
+            commands_.insert(commands_.end(), buffer.begin(), buffer.end());
+        }
+        std::stable_sort(commands_.begin(), commands_.end(), [](const DrawCommand& a, const DrawCommand& b) {
+            return a.sort_key < b.sort_key;
+        });
+
+        TextureStreamer& streamer = TextureStreamer::instance();
+        if (const Camera* camera = scene.get_camera()) {
+            streamer.set_view(camera->get_global_position().to_glm(),
+                              camera->get_projection_matrix().to_glm()[1][1]);
+        }
+
+        // In sorted order, so a batch of commands is also a contiguous range of draw data
+        draw_data_.resize(commands_.size() * DRAW_DATA_TEXELS);
+        jobs.parallel_for(commands_.size(), MIN_BATCH, [this, &streamer](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                write_draw_data(commands_[i], &draw_data_[i * DRAW_DATA_TEXELS]);
+                request_texture_level(streamer, commands_[i]);
+            }
+        });
+    }
+
+    void RenderQueue::bind_draw_data() const {
+        if (!draw_data_buffer_) {
+            // Bound once first, a generated name isn't a buffer object until then
+            glGenBuffers(1, &draw_data_buffer_);
+            glBindBuffer(GL_TEXTURE_BUFFER, draw_data_buffer_);
+            glBindBuffer(GL_TEXTURE_BUFFER, 0);
+            glGenTextures(1, &draw_data_texture_);
+            glBindTexture(GL_TEXTURE_BUFFER, draw_data_texture_);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, draw_data_buffer_);
+
+            // GL 3.3 only guarantees 65536 texels, more draws than fit are drawn in windows
+            GLint max_texels = 0;
+            glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels);
+            max_window_draws_ = std::max<size_t>(1, static_cast<size_t>(max_texels) / DRAW_DATA_TEXELS);
+        }
+        glActiveTexture(GL_TEXTURE0 + DRAW_DATA_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, draw_data_texture_);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void RenderQueue::upload_draw_data(size_t first, size_t count) const {
+        // Orphaned rather than overwritten, the previous window may still be in flight
+        glBindBuffer(GL_TEXTURE_BUFFER, draw_data_buffer_);
+        glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(count * DRAW_DATA_TEXELS * sizeof(glm::vec4)),
+                     &draw_data_[first * DRAW_DATA_TEXELS], GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    static void set_frame_uniforms(const Shader& shader, const FrameUniforms& frame) {
+        shader.set_mat4("view", frame.view);
+        shader.set_mat4("projection", frame.projection);
+        shader.set_vec3("view_pos", frame.view_pos);
+        shader.set_vec3("light_pos", frame.light_pos);
+        shader.set_vec3("light_color", frame.light_color);
+        shader.set_float("ambient_strength", frame.ambient_strength);
+    }
+
+    static bool passes(RenderQueue::Filter filter, const DrawCommand& command) {
+        if (filter == RenderQueue::Filter::LIT) return command.material;
+        if (filter == RenderQueue::Filter::UNLIT) return !command.material;
+        return true;
+    }
+
+    static const Texture* get_texture(const DrawCommand& command) {
+        return command.material && command.material->has_texture() ? command.material->get_texture().get() : nullptr;
+    }
+
+    void RenderQueue::execute(const FrameUniforms& frame, Filter filter, const Shader* override_shader) const {
+        if (commands_.empty()) return;
+
+        // The window of draw data currently in the buffer, empty until the first batch uploads
+        bind_draw_data();
+        size_t window_first = 0;
+        size_t window_end = 0;
+
+        const Shader* bound = nullptr;
+        GLuint bound_vao = 0;
+
+        size_t first = 0;
+        while (first < commands_.size()) {
+            const DrawCommand& command = commands_[first];
+            if (!passes(filter, command)) {
+                first++;
+                continue;
+            }
+
+            // Extend over the following instances of the same mesh, material texture and shader.
+            // Sorting put them next to each other.
+            const Texture* texture = get_texture(command);
+            size_t end = first + 1;
+            while (end < commands_.size() && end - first < max_window_draws_) {
+                const DrawCommand& next = commands_[end];
+                if (!passes(filter, next) || next.mesh != command.mesh || get_texture(next) != texture ||
+                    (!override_shader && next.shader != command.shader)) {
+                    break;
+                }
+                end++;
+            }
+
+            if (end > window_end) {
+                window_first = first;
+                window_end = std::min(commands_.size(), first + max_window_draws_);
+                upload_draw_data(window_first, window_end - window_first);
+            }
+
+            const Shader& shader = override_shader ? *override_shader : *command.shader;
+            if (&shader != bound) {
+                shader.use();
+                set_frame_uniforms(shader, frame);
+                shader.set_int("draw_data", DRAW_DATA_UNIT);
+                shader.set_int("albedoTex", 0);
+                bound = &shader;
+            }
+            shader.set_int("draw_offset", static_cast<int>(first - window_first));
+
+            if (command.material) {
+                shader.set_bool("useTexture", texture != nullptr);
+                if (texture) {
+                    texture->bind(0);
+                }
+            }
+
+            // Meshes share their geometry arena's VAO, and commands are sorted by it
+            const GLuint vao = command.mesh->get_vao();
+            if (vao != bound_vao) {
+                glBindVertexArray(vao);
+                bound_vao = vao;
+            }
+            command.mesh->draw_instances(static_cast<GLsizei>(end - first));
+            first = end;
+        }
+        glBindVertexArray(0);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "engine/renderer/GL.hpp"
+#include "engine/renderer/RenderCommand.hpp"
+#include "engine/math/Transform.hpp"
+
+class Camera;
+class LightSource;
+class RenderedObject;
+class Shader;
+
+namespace Scene {
+    class Scene;
+}
+
+namespace Renderer {
+    // Uniforms shared by every draw in a frame. Set once per program instead of per object.
+    struct FrameUniforms {
+        glm::mat4 view{1.0f};
+        glm::mat4 projection{1.0f};
+        glm::vec3 view_pos{0.0f};
+        glm::vec3 light_pos{0.0f};
+        glm::vec3 light_color{0.0f};
+        float ambient_strength = 0.0f;
+
+        static FrameUniforms from_scene(const Camera& camera, const std::vector<const LightSource*>& lights);
+    };
+
+    // Splits render submission in two. `record()` fans the renderables out over the job
+    // system, where each worker resolves materials and converts matrices into its own
+    // command buffer. `execute()` then runs on the GL thread and only merges, sorts and
+    // issues the commands.
+    //
+    // Nothing per draw goes through uniforms. `record()` also packs every command's
+    // matrices and material into a texture buffer, and `execute()` draws each run of
+    // commands sharing a mesh, shader and texture as one instanced call. The mesh shaders
+    // fetch their draw with `draw_offset + gl_InstanceID`, so between runs only that
+    // offset changes.
+    class RenderQueue {
+    public:
+        enum class Filter {
+            ALL,
+            LIT,    // Commands with a material
+            UNLIT,  // Commands drawn with a flat color, e.g. light sources
+        };
+
+    private:
+        // Objects per job, recording a single object is too little work to hand off
+        static constexpr size_t MIN_BATCH = 16;
+
+    public:
+        // RGBA32F texels per draw: model matrix columns (4), normal matrix columns (3),
+        // ambient, diffuse, specular + shininess. Unlit draws put their color in ambient
+        // and diffuse. The model matrix includes the mesh's dequantize transform, and the
+        // first normal matrix column's w is 1 when `aNormal.xy` is octahedral-encoded.
+        static constexpr size_t DRAW_DATA_TEXELS = 10;
+
+        // Texture unit of the `draw_data` sampler, clear of albedo and G-buffer units
+        static constexpr unsigned int DRAW_DATA_UNIT = 8;
+
+    private:
+
+        std::vector<const RenderedObject*> renderables_;
+        std::vector<Transform> transforms_;
+        std::vector<CommandBuffer> worker_buffers_;
+        CommandBuffer commands_;
+        std::vector<glm::vec4> draw_data_;
+
+        // Created on the first `execute()`, so recording works without a GL context
+        mutable GLuint draw_data_buffer_ = 0;
+        mutable GLuint draw_data_texture_ = 0;
+        mutable size_t max_window_draws_ = 0;
+
+        void bind_draw_data() const;
+
+        void upload_draw_data(size_t first, size_t count) const;
+
+    public:
+        RenderQueue() = default;
+
+        ~RenderQueue() noexcept;
+
+        RenderQueue(const RenderQueue&) = delete;
+
+        RenderQueue& operator=(const RenderQueue&) = delete;
+
+        void record(const Scene::Scene& scene);
+
+        // `override_shader` replaces each command's shader, e.g. for the deferred geometry pass
+        void execute(const FrameUniforms& frame, Filter filter = Filter::ALL,
+                     const Shader* override_shader = nullptr) const;
+
+        const CommandBuffer& get_commands() const { return commands_; }
+
+        // `DRAW_DATA_TEXELS` per command, in command order
+        const std::vector<glm::vec4>& get_draw_data() const { return draw_data_; }
+    };
+}
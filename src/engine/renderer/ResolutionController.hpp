@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cmath>
+
+#include "engine/utilities/Utils.hpp"
+
+namespace Renderer {
+    // Picks a render scale from recent frame times. GPU time is what resolution actually
+    // buys back, so it drives the scale. CPU time is only used to avoid dropping
+    // resolution for frames that are CPU bound, since that would cost quality for nothing.
+    class ResolutionController {
+    private:
+        double budget_ms_;
+        double min_scale_;
+        double max_scale_;
+        double scale_;
+
+        size_t sample_window_ = 8;
+        double high_watermark_ = 0.95;  // Fraction of the budget that triggers a drop
+        double low_watermark_ = 0.75;   // Fraction of the budget that allows a raise
+        double raise_step_ = 0.05;      // Raise slowly so we don't oscillate
+        double max_drop_step_ = 0.2;
+
+        // GPU samples arrive this many frames after the frame they measured
+        size_t sample_latency_;
+        // After a change the scale holds until the window only has samples taken at it,
+        // otherwise the old timings would keep pushing it the same way every frame
+        size_t settled_at_sample_ = 0;
+
+    public:
+        explicit ResolutionController(double budget_ms, double min_scale = 0.5, double max_scale = 1.0,
+                                      size_t sample_latency = 0)
+            : budget_ms_(budget_ms),
+              min_scale_(min_scale),
+              max_scale_(max_scale),
+              scale_(max_scale),
+              sample_latency_(sample_latency) {
+        }
+
+        double get_scale() const { return scale_; }
+
+        void set_budget_ms(double budget_ms) { budget_ms_ = budget_ms; }
+        double get_budget_ms() const { return budget_ms_; }
+
+        // Returns the new scale
+        double update(const Utils::CircularBuffer& cpu_times_ms, const Utils::CircularBuffer& gpu_times_ms) {
+            if (gpu_times_ms.size() < sample_window_) return scale_;
+            if (gpu_times_ms.total_pushed() < settled_at_sample_) return scale_;
+
+            const double gpu_ms = gpu_times_ms.average_value(sample_window_);
+            const double cpu_ms = cpu_times_ms.average_value(sample_window_);
+            const double previous_scale = scale_;
+
+            if (gpu_ms > budget_ms_ * high_watermark_ && gpu_ms >= cpu_ms) {
+                // GPU cost scales with pixel count, i.e. with scale squared
+                double target = scale_ * std::sqrt(budget_ms_ * low_watermark_ / gpu_ms);
+                target = std::max(target, scale_ - max_drop_step_);
+                scale_ = Utils::clamp(target, min_scale_, max_scale_);
+            } else if (gpu_ms < budget_ms_ * low_watermark_) {
+                scale_ = Utils::clamp(scale_ + raise_step_, min_scale_, max_scale_);
+            }
+            if (scale_ != previous_scale) {
+                settled_at_sample_ = gpu_times_ms.total_pushed() + sample_latency_ + sample_window_;
+            }
+            return scale_;
+        }
+    };
+}
@@ -0,0 +1,389 @@
+#include "engine/renderer/SoftwareRasterizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <stb_image_write.h>
+
+#include "engine/math/Simd.hpp"
+#include "engine/scene/Scene.hpp"
+#include "engine/utilities/JobSystem.hpp"
+
+namespace Renderer {
+    namespace {
+        using Math::Float4;
+
+        enum OutCode {
+            OUT_RIGHT = 1 << 0,
+            OUT_LEFT = 1 << 1,
+            OUT_TOP = 1 << 2,
+            OUT_BOTTOM = 1 << 3,
+            OUT_NEAR = 1 << 4,
+            OUT_FAR = 1 << 5,
+        };
+
+        int out_code(const glm::vec4& clip) {
+            int code = 0;
+            if (clip.x > clip.w) code |= OUT_RIGHT;
+            if (clip.x < -clip.w) code |= OUT_LEFT;
+            if (clip.y > clip.w) code |= OUT_TOP;
+            if (clip.y < -clip.w) code |= OUT_BOTTOM;
+            if (clip.z < -clip.w) code |= OUT_NEAR;
+            if (clip.z > clip.w) code |= OUT_FAR;
+            return code;
+        }
+
+        // Textures are sRGB encoded, GL decodes them when sampling
+        float srgb_to_linear(unsigned char value) {
+            static const std::array<float, 256> table = [] {
+                std::array<float, 256> result{};
+                for (int i = 0; i < 256; i++) {
+                    const float c = i / 255.0f;
+                    result[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+                return result;
+            }();
+            return table[value];
+        }
+
+        glm::vec3 fetch_texel(const Texture& texture, int x, int y) {
+            // GL_REPEAT
+            x = ((x % texture.width) + texture.width) % texture.width;
+            y = ((y % texture.height) + texture.height) % texture.height;
+            const unsigned char* texel = &texture.pixels[
+                (static_cast<size_t>(y) * texture.width + x) * texture.channels];
+            const unsigned char r = texel[0];
+            const unsigned char g = texture.channels >= 3 ? texel[1] : r;
+            const unsigned char b = texture.channels >= 3 ? texel[2] : r;
+            if (texture.srgb) {
+                return {srgb_to_linear(r), srgb_to_linear(g), srgb_to_linear(b)};
+            }
+            return glm::vec3(r, g, b) / 255.0f;
+        }
+
+        glm::vec3 sample_bilinear(const Texture& texture, const glm::vec2& uv) {
+            if (texture.pixels.empty()) return glm::vec3(1.0f);
+
+            const float x = uv.x * texture.width - 0.5f;
+            const float y = uv.y * texture.height - 0.5f;
+            const float x_floor = std::floor(x);
+            const float y_floor = std::floor(y);
+            const float tx = x - x_floor;
+            const float ty = y - y_floor;
+            const int x0 = static_cast<int>(x_floor);
+            const int y0 = static_cast<int>(y_floor);
+
+            const glm::vec3 bottom = fetch_texel(texture, x0, y0) * (1.0f - tx) + fetch_texel(texture, x0 + 1, y0) * tx;
+            const glm::vec3 top = fetch_texel(texture, x0, y0 + 1) * (1.0f - tx) + fetch_texel(texture, x0 + 1, y0 + 1) * tx;
+            return bottom * (1.0f - ty) + top * ty;
+        }
+
+        // Mirrors default.frag
+        glm::vec3 shade_phong(const Model::Material& material, const FrameUniforms& frame,
+                              const glm::vec3& frag_pos, const glm::vec3& normal, const glm::vec2& uv) {
+            const glm::vec3 ambient = material.get_ambient().to_glm() * frame.ambient_strength;
+
+            const glm::vec3 norm = glm::normalize(normal);
+            const glm::vec3 light_dir = glm::normalize(frame.light_pos - frag_pos);
+
+            const float diff = std::max(glm::dot(norm, light_dir), 0.0f);
+            const glm::vec3 diffuse = diff * material.get_diffuse().to_glm() * frame.light_color;
+
+            const glm::vec3 view_dir = glm::normalize(frame.view_pos - frag_pos);
+            const glm::vec3 reflect_dir = glm::reflect(-light_dir, norm);
+            const float spec = std::pow(std::max(glm::dot(view_dir, reflect_dir), 0.0f), material.get_shininess());
+            const glm::vec3 specular = material.get_specular().to_glm() * spec * frame.light_color;
+
+            const glm::vec3 tex = material.has_texture()
+                                      ? sample_bilinear(*material.get_texture(), uv)
+                                      : glm::vec3(1.0f);
+
+            return ambient * tex + diffuse * tex + specular;
+        }
+
+        uint32_t pack_color(const glm::vec3& color) {
+            auto channel = [](float c) {
+                return static_cast<uint32_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+            };
+            // Little endian, so the bytes read R, G, B, A in memory
+            return channel(color.r) | (channel(color.g) << 8) | (channel(color.b) << 16) | (0xFFu << 24);
+        }
+    }
+
+    SoftwareRasterizer::SoftwareRasterizer(int width, int height)
+        : width_(width),
+          height_(height),
+          stride_((width + 3) & ~3),
+          tiles_x_((width + TILE_SIZE - 1) / TILE_SIZE),
+          tiles_y_((height + TILE_SIZE - 1) / TILE_SIZE),
+          color_(static_cast<size_t>(stride_) * height),
+          depth_(static_cast<size_t>(stride_) * height),
+          bins_(static_cast<size_t>(tiles_x_) * tiles_y_) {
+        clear();
+    }
+
+    void SoftwareRasterizer::clear() {
+        std::fill(color_.begin(), color_.end(), pack_color(clear_color_));
+        std::fill(depth_.begin(), depth_.end(), 1.0f);
+    }
+
+    void SoftwareRasterizer::render(const Scene::Scene& scene) {
+        clear();
+        const RenderQueue& queue = scene.record_render_queue();
+        draw(queue.get_commands(), FrameUniforms::from_scene(*scene.get_camera(), scene.get_lights()));
+    }
+
+    void SoftwareRasterizer::draw(const CommandBuffer& commands, const FrameUniforms& frame) {
+        const glm::mat4 view_projection = frame.projection * frame.view;
+
+        // Vertex processing and triangle setup, one command per job
+        JobSystem& jobs = JobSystem::instance();
+        worker_vertices_.resize(jobs.worker_count());
+        command_triangles_.resize(commands.size());
+        jobs.parallel_for(commands.size(), 1, [&](size_t begin, size_t end, size_t worker) {
+            for (size_t i = begin; i < end; i++) {
+                command_triangles_[i].clear();
+                setup_triangles(commands[i], view_projection, worker_vertices_[worker], command_triangles_[i]);
+            }
+        });
+
+        triangles_.clear();
+        for (size_t i = 0; i < commands.size(); i++) {
+            triangles_.insert(triangles_.end(), command_triangles_[i].begin(), command_triangles_[i].end());
+        }
+
+        // Binning, in submission order
+        for (auto& bin: bins_) {
+            bin.clear();
+        }
+        for (size_t index = 0; index < triangles_.size(); index++) {
+            const Triangle& triangle = triangles_[index];
+            const int tile_x0 = triangle.min_x / TILE_SIZE;
+            const int tile_x1 = triangle.max_x / TILE_SIZE;
+            const int tile_y0 = triangle.min_y / TILE_SIZE;
+            const int tile_y1 = triangle.max_y / TILE_SIZE;
+            for (int ty = tile_y0; ty <= tile_y1; ty++) {
+                for (int tx = tile_x0; tx <= tile_x1; tx++) {
+                    bins_[static_cast<size_t>(ty) * tiles_x_ + tx].push_back(static_cast<uint32_t>(index));
+                }
+            }
+        }
+
+        jobs.parallel_for(bins_.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t tile = begin; tile < end; tile++) {
+                rasterize_tile(tile, frame);
+            }
+        });
+    }
+
+    void SoftwareRasterizer::setup_triangles(const DrawCommand& command, const glm::mat4& view_projection,
+                                             std::vector<Vertex>& vertices, std::vector<Triangle>& out) const {
+        const Span<float> data = command.mesh->get_vertex_data();
+        const Span<unsigned int> indices = command.mesh->get_indices();
+
+        const glm::mat4 mvp = view_projection * command.model;
+        const glm::mat3 normal_matrix = glm::mat3(glm::transpose(glm::inverse(command.model)));
+
+        const size_t n_vertices = data.size() / 8;
+        vertices.resize(n_vertices);
+        for (size_t i = 0; i < n_vertices; i++) {
+            const float* v = &data[i * 8];
+            const glm::vec4 position(v[0], v[1], v[2], 1.0f);
+            vertices[i].clip = mvp * position;
+            vertices[i].world_pos = glm::vec3(command.model * position);
+            vertices[i].normal = normal_matrix * glm::vec3(v[3], v[4], v[5]);
+            vertices[i].uv = glm::vec2(v[6], v[7]);
+        }
+
+        auto lerp = [](const Vertex& a, const Vertex& b, float t) {
+            Vertex result;
+            result.clip = a.clip + (b.clip - a.clip) * t;
+            result.world_pos = a.world_pos + (b.world_pos - a.world_pos) * t;
+            result.normal = a.normal + (b.normal - a.normal) * t;
+            result.uv = a.uv + (b.uv - a.uv) * t;
+            return result;
+        };
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const Vertex* corners[3] = {&vertices[indices[i]], &vertices[indices[i + 1]], &vertices[indices[i + 2]]};
+            const int codes[3] = {out_code(corners[0]->clip), out_code(corners[1]->clip), out_code(corners[2]->clip)};
+
+            if (codes[0] & codes[1] & codes[2]) continue;  // Entirely outside one plane
+
+            if (!((codes[0] | codes[1] | codes[2]) & OUT_NEAR)) {
+                emit_triangle(*corners[0], *corners[1], *corners[2], command, out);
+                continue;
+            }
+
+            // Clip against the near plane, z >= -w. Crossing points are always interpolated
+            // from the inside vertex so triangles sharing the edge get identical vertices.
+            Vertex clipped[4];
+            int n_clipped = 0;
+            for (int c = 0; c < 3; c++) {
+                const Vertex& a = *corners[c];
+                const Vertex& b = *corners[(c + 1) % 3];
+                const float dist_a = a.clip.z + a.clip.w;
+                const float dist_b = b.clip.z + b.clip.w;
+                if (dist_a >= 0.0f) clipped[n_clipped++] = a;
+                if ((dist_a >= 0.0f) != (dist_b >= 0.0f)) {
+                    clipped[n_clipped++] = dist_a >= 0.0f
+                                               ? lerp(a, b, dist_a / (dist_a - dist_b))
+                                               : lerp(b, a, dist_b / (dist_b - dist_a));
+                }
+            }
+            for (int c = 1; c + 1 < n_clipped; c++) {
+                emit_triangle(clipped[0], clipped[c], clipped[c + 1], command, out);
+            }
+        }
+    }
+
+    void SoftwareRasterizer::emit_triangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                                           const DrawCommand& command, std::vector<Triangle>& out) const {
+        const Vertex* corners[3] = {&v0, &v1, &v2};
+        glm::vec2 screen[3];
+        float depth[3];
+        float inv_w[3];
+        for (int i = 0; i < 3; i++) {
+            const glm::vec4& clip = corners[i]->clip;
+            inv_w[i] = 1.0f / clip.w;
+            // Pixel units, y down so row 0 is the top of the image
+            screen[i].x = (clip.x * inv_w[i] * 0.5f + 0.5f) * width_;
+            screen[i].y = (0.5f - clip.y * inv_w[i] * 0.5f) * height_;
+            depth[i] = clip.z * inv_w[i] * 0.5f + 0.5f;
+        }
+
+        // GL draws both windings, flip negative ones so every triangle has a positive area
+        int order[3] = {0, 1, 2};
+        const float area = (screen[2].x - screen[1].x) * (screen[0].y - screen[1].y) -
+                           (screen[2].y - screen[1].y) * (screen[0].x - screen[1].x);
+        if (!(std::abs(area) > 0.0f)) return;  // Degenerate or NaN
+        if (area < 0.0f) std::swap(order[1], order[2]);
+
+        const float min_x = std::min({screen[0].x, screen[1].x, screen[2].x});
+        const float max_x = std::max({screen[0].x, screen[1].x, screen[2].x});
+        const float min_y = std::min({screen[0].y, screen[1].y, screen[2].y});
+        const float max_y = std::max({screen[0].y, screen[1].y, screen[2].y});
+        if (max_x < 0.0f || max_y < 0.0f || min_x > width_ || min_y > height_) return;
+
+        Triangle& triangle = out.emplace_back();
+        triangle.command = &command;
+        triangle.inv_area = 1.0f / std::abs(area);
+        triangle.min_x = static_cast<int>(std::max(0.0f, std::floor(min_x)));
+        triangle.min_y = static_cast<int>(std::max(0.0f, std::floor(min_y)));
+        triangle.max_x = static_cast<int>(std::min(static_cast<float>(width_ - 1), std::ceil(max_x)));
+        triangle.max_y = static_cast<int>(std::min(static_cast<float>(height_ - 1), std::ceil(max_y)));
+
+        for (int i = 0; i < 3; i++) {
+            const int corner = order[i];
+            triangle.depth[i] = depth[corner];
+            triangle.inv_w[i] = inv_w[corner];
+            triangle.world_pos_w[i] = corners[corner]->world_pos * inv_w[corner];
+            triangle.normal_w[i] = corners[corner]->normal * inv_w[corner];
+            triangle.uv_w[i] = corners[corner]->uv * inv_w[corner];
+
+            // Edge opposite vertex i. A neighbour sharing the edge sees it reversed, which
+            // negates a and b exactly. c is computed from the lower vertex in both so it is
+            // negated exactly too, and every pixel on a shared edge has exactly opposite
+            // values in the two triangles: no cracks and no double blending.
+            const glm::vec2& a = screen[order[(i + 1) % 3]];
+            const glm::vec2& b = screen[order[(i + 2) % 3]];
+            const glm::vec2& base = (a.x < b.x || (a.x == b.x && a.y < b.y)) ? a : b;
+            triangle.edge_a[i] = a.y - b.y;
+            triangle.edge_b[i] = b.x - a.x;
+            triangle.edge_c[i] = -(triangle.edge_a[i] * base.x + triangle.edge_b[i] * base.y);
+            triangle.edge_owned[i] = triangle.edge_a[i] > 0.0f ||
+                                     (triangle.edge_a[i] == 0.0f && triangle.edge_b[i] > 0.0f);
+        }
+    }
+
+    void SoftwareRasterizer::rasterize_tile(size_t tile, const FrameUniforms& frame) {
+        const int tile_x0 = static_cast<int>(tile % tiles_x_) * TILE_SIZE;
+        const int tile_y0 = static_cast<int>(tile / tiles_x_) * TILE_SIZE;
+        const int tile_x1 = std::min(tile_x0 + TILE_SIZE, width_) - 1;
+        const int tile_y1 = std::min(tile_y0 + TILE_SIZE, height_) - 1;
+
+        const Float4 zero = Float4::broadcast(0.0f);
+        const Float4 lane_offsets = Float4::ramp();
+
+        for (auto index: bins_[tile]) {
+            const Triangle& triangle = triangles_[index];
+
+            // Start on a multiple of 4 so the depth loads stay inside the padded row
+            const int x0 = std::max(triangle.min_x, tile_x0) & ~3;
+            const int x1 = std::min(triangle.max_x, tile_x1);
+            const int y0 = std::max(triangle.min_y, tile_y0);
+            const int y1 = std::min(triangle.max_y, tile_y1);
+
+            Float4 edge_a[3], depth_plane[3];
+            for (int i = 0; i < 3; i++) {
+                edge_a[i] = Float4::broadcast(triangle.edge_a[i]);
+                depth_plane[i] = Float4::broadcast(triangle.depth[i] * triangle.inv_area);
+            }
+
+            for (int y = y0; y <= y1; y++) {
+                const float py = y + 0.5f;
+                float* depth_row = &depth_[static_cast<size_t>(y) * stride_];
+                uint32_t* color_row = &color_[static_cast<size_t>(y) * stride_];
+
+                Float4 row_term[3];
+                for (int i = 0; i < 3; i++) {
+                    row_term[i] = Float4::broadcast(triangle.edge_b[i] * py + triangle.edge_c[i]);
+                }
+
+                for (int x = x0; x <= x1; x += 4) {
+                    // Evaluated directly rather than stepped so shared edges stay exact
+                    const Float4 px = Float4::broadcast(x + 0.5f) + lane_offsets;
+                    Float4 weights[3];
+                    int mask = x1 - x >= 3 ? 0xF : (1 << (x1 - x + 1)) - 1;
+                    for (int i = 0; i < 3; i++) {
+                        weights[i] = edge_a[i] * px + row_term[i];
+                        mask &= greater(weights[i], zero) | (triangle.edge_owned[i] ? equal(weights[i], zero) : 0);
+                    }
+                    if (!mask) continue;
+
+                    const Float4 z = weights[0] * depth_plane[0] + weights[1] * depth_plane[1] +
+                                     weights[2] * depth_plane[2];
+                    mask &= less(z, Float4::load(depth_row + x));  // GL_LESS
+                    if (!mask) continue;
+
+                    float z_lanes[4], w0[4], w1[4], w2[4];
+                    z.store(z_lanes);
+                    weights[0].store(w0);
+                    weights[1].store(w1);
+                    weights[2].store(w2);
+
+                    for (int lane = 0; lane < 4; lane++) {
+                        if (!(mask & (1 << lane))) continue;
+                        depth_row[x + lane] = z_lanes[lane];
+
+                        const DrawCommand& command = *triangle.command;
+                        if (!command.material) {
+                            // light_source.frag, light_color and material_color are both the command color
+                            color_row[x + lane] = pack_color(command.color * command.color);
+                            continue;
+                        }
+
+                        const float b0 = w0[lane] * triangle.inv_area;
+                        const float b1 = w1[lane] * triangle.inv_area;
+                        const float b2 = w2[lane] * triangle.inv_area;
+                        const float w = 1.0f / (b0 * triangle.inv_w[0] + b1 * triangle.inv_w[1] + b2 * triangle.inv_w[2]);
+                        const glm::vec3 frag_pos = (b0 * triangle.world_pos_w[0] + b1 * triangle.world_pos_w[1] +
+                                                    b2 * triangle.world_pos_w[2]) * w;
+                        const glm::vec3 normal = (b0 * triangle.normal_w[0] + b1 * triangle.normal_w[1] +
+                                                  b2 * triangle.normal_w[2]) * w;
+                        const glm::vec2 uv = (b0 * triangle.uv_w[0] + b1 * triangle.uv_w[1] +
+                                              b2 * triangle.uv_w[2]) * w;
+
+                        color_row[x + lane] = pack_color(shade_phong(*command.material, frame, frag_pos, normal, uv));
+                    }
+                }
+            }
+        }
+    }
+
+    bool SoftwareRasterizer::write_png(const std::string& path) const {
+        return stbi_write_png(path.c_str(), width_, height_, 4, color_.data(),
+                              stride_ * static_cast<int>(sizeof(uint32_t))) != 0;
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "engine/renderer/RenderCommand.hpp"
+#include "engine/renderer/RenderQueue.hpp"
+
+namespace Scene {
+    class Scene;
+}
+
+namespace Renderer {
+    // CPU implementation of the forward pass for machines without a GPU. Executes the same
+    // recorded draw commands as `RenderQueue::execute()`, shading lit commands with the
+    // default shader's Phong model and unlit ones like `light_source.frag`. Meshes and
+    // textures are read from their CPU copies, see `Backend::SOFTWARE`.
+    //
+    // Triangles are transformed and clipped against the near plane per command, then binned
+    // into screen tiles. Tiles are rasterized in parallel on the job system, evaluating the
+    // edge functions and depth test four pixels at a time (SSE2 or NEON where available).
+    // Each tile walks its triangles in submission order and only one job writes a tile, so
+    // the output doesn't depend on the number of threads.
+    //
+    // Not drawn: the skybox and particles. Textures are sampled bilinearly from the base level.
+    class SoftwareRasterizer {
+    public:
+        static constexpr int TILE_SIZE = 64;
+
+    private:
+        struct Vertex {
+            glm::vec4 clip;
+            glm::vec3 world_pos;
+            glm::vec3 normal;
+            glm::vec2 uv;
+        };
+
+        struct Triangle {
+            // Edge functions w_i = a * x + b * y + c for the edge opposite vertex i, in pixels
+            float edge_a[3];
+            float edge_b[3];
+            float edge_c[3];
+            bool edge_owned[3];  // Pixels exactly on the edge belong to this triangle
+            float inv_area;
+
+            // Per vertex, attributes are pre-divided by w for perspective correct interpolation
+            float depth[3];
+            float inv_w[3];
+            glm::vec3 world_pos_w[3];
+            glm::vec3 normal_w[3];
+            glm::vec2 uv_w[3];
+
+            int min_x, min_y, max_x, max_y;
+            const DrawCommand* command;
+        };
+
+        int width_;
+        int height_;
+        int stride_;  // Row pitch in pixels, padded to a multiple of 4 for the SIMD loads
+        int tiles_x_;
+        int tiles_y_;
+
+        std::vector<uint32_t> color_;  // RGBA8, top row first
+        std::vector<float> depth_;
+        glm::vec3 clear_color_{0.0f};
+
+        std::vector<std::vector<Triangle>> command_triangles_;
+        std::vector<std::vector<Vertex>> worker_vertices_;
+        std::vector<Triangle> triangles_;
+        std::vector<std::vector<uint32_t>> bins_;
+
+        void setup_triangles(const DrawCommand& command, const glm::mat4& view_projection,
+                             std::vector<Vertex>& vertices, std::vector<Triangle>& out) const;
+
+        void emit_triangle(const Vertex& v0, const Vertex& v1, const Vertex& v2, const DrawCommand& command,
+                           std::vector<Triangle>& out) const;
+
+        void rasterize_tile(size_t tile, const FrameUniforms& frame);
+
+    public:
+        SoftwareRasterizer(int width, int height);
+
+        void set_clear_color(const glm::vec3& color) { clear_color_ = color; }
+
+        void clear();
+
+        // Clears, records the scene's render queue and draws it from the scene camera
+        void render(const Scene::Scene& scene);
+
+        void draw(const CommandBuffer& commands, const FrameUniforms& frame);
+
+        int get_width() const { return width_; }
+        int get_height() const { return height_; }
+
+        uint32_t get_pixel(int x, int y) const { return color_[static_cast<size_t>(y) * stride_ + x]; }
+        float get_depth(int x, int y) const { return depth_[static_cast<size_t>(y) * stride_ + x]; }
+
+        // Returns false if the file couldn't be written
+        bool write_png(const std::string& path) const;
+    };
+}
@@ -0,0 +1,112 @@
+#include "engine/renderer/TextureStreamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "engine/resources/Texture.hpp"
+
+namespace Renderer {
+    TextureStreamer& TextureStreamer::instance() {
+        static TextureStreamer instance;
+        return instance;
+    }
+
+    void TextureStreamer::add(Texture* texture) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        textures_.push_back(texture);
+    }
+
+    void TextureStreamer::remove(Texture* texture) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        textures_.erase(std::remove(textures_.begin(), textures_.end(), texture), textures_.end());
+    }
+
+    void TextureStreamer::set_view(const glm::vec3& position, float projection_scale) {
+        view_.position = position;
+        view_.projection_scale = projection_scale;
+    }
+
+    void TextureStreamer::set_viewport_height(int height) {
+        view_.viewport_height = std::max(1, height);
+    }
+
+    int TextureStreamer::desired_level(int texture_size, int level_count, float distance, float radius,
+                                       float projection_scale, int viewport_height) {
+        // Close enough to fill the screen, or inside the sphere
+        if (distance <= radius) return 0;
+        // Diameter on screen, the sphere's angular size over the vertical field of view
+        const float pixels = radius * projection_scale * static_cast<float>(viewport_height) / distance;
+        if (pixels <= 1.0f) return level_count - 1;
+        const float level = std::floor(std::log2(static_cast<float>(texture_size) / pixels));
+        return std::clamp(static_cast<int>(level), 0, level_count - 1);
+    }
+
+    void TextureStreamer::request(Texture& texture, const glm::vec3& center, float radius) const {
+        const int level = desired_level(texture.get_streamed_size(), texture.get_level_count(),
+                                        glm::length(center - view_.position), radius,
+                                        view_.projection_scale, view_.viewport_height);
+        // Finest level any draw asked for wins
+        int requested = texture.requested_level.load(std::memory_order_relaxed);
+        while (level < requested &&
+               !texture.requested_level.compare_exchange_weak(requested, level, std::memory_order_relaxed)) {
+        }
+    }
+
+    size_t TextureStreamer::update(size_t budget) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        struct Want {
+            Texture* texture;
+            int level;
+        };
+        std::vector<Want> wants;
+        for (Texture* texture: textures_) {
+            const int level_count = texture->get_level_count();
+            int wanted = texture->requested_level.exchange(level_count, std::memory_order_relaxed);
+            if (wanted == level_count) {
+                // Not drawn since the last update, keep what it has for a while
+                if (++texture->frames_unseen < RELEASE_FRAMES) continue;
+                wanted = texture->get_tail_level();
+            } else {
+                texture->frames_unseen = 0;
+            }
+            wanted = std::min(wanted, texture->get_tail_level());
+
+            // One level of slack, so a draw hovering around a level boundary doesn't make
+            // its texture upload and drop the same level over and over
+            if (wanted >= texture->resident_level + 2) {
+                texture->trim(wanted - 1);
+            } else if (wanted < texture->resident_level) {
+                wants.push_back({texture, wanted});
+            }
+        }
+
+        // Furthest from what they need first
+        std::stable_sort(wants.begin(), wants.end(), [](const Want& a, const Want& b) {
+            return a.texture->resident_level - a.level > b.texture->resident_level - b.level;
+        });
+
+        // A level at a time round the list, so one texture far off its level doesn't take
+        // the whole budget
+        size_t spent = 0;
+        bool progressed = true;
+        while (progressed) {
+            progressed = false;
+            for (const Want& want: wants) {
+                Texture& texture = *want.texture;
+                if (texture.resident_level <= want.level) continue;
+                const size_t bytes = texture.get_level_size(texture.resident_level - 1);
+                if (spent > 0 && spent + bytes > budget) return spent;
+                texture.upload_level(texture.resident_level - 1);
+                spent += bytes;
+                progressed = true;
+            }
+        }
+        return spent;
+    }
+
+    size_t TextureStreamer::size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return textures_.size();
+    }
+}
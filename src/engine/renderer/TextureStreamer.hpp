@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Texture;
+
+namespace Renderer {
+    // Progressive mip streaming for large compiled textures. A streamed texture uploads only
+    // its tail mips (`TAIL_SIZE` and below) when it loads, so it can be drawn on its first
+    // frame, and keeps its mapped file to upload finer levels later. While recording, the
+    // render queue asks for the level each textured draw needs, from the on-screen size of
+    // the mesh's bounding sphere. Once a frame `update()` uploads the finest requested levels
+    // within a byte budget, the most blurry textures first, and drops levels that are no
+    // longer needed so distant textures don't hold high-res memory.
+    class TextureStreamer {
+    public:
+        static constexpr size_t DEFAULT_FRAME_BUDGET = 4 << 20;
+        // Compiled textures larger than this along either side stream, smaller ones upload whole
+        static constexpr int MIN_STREAMED_SIZE = 512;
+        // Resident from the first frame
+        static constexpr int TAIL_SIZE = 64;
+        // Textures no draw asked for in this many updates fall back to their tail
+        static constexpr unsigned int RELEASE_FRAMES = 120;
+
+    private:
+        struct View {
+            glm::vec3 position{0.0f};
+            float projection_scale = 1.0f;  // projection[1][1], 1 / tan(fov / 2)
+            int viewport_height = 1;
+        };
+
+        mutable std::mutex mutex_;
+        std::vector<Texture*> textures_;
+        View view_;
+        size_t frame_budget_ = DEFAULT_FRAME_BUDGET;
+        bool enabled_ = true;
+
+    public:
+        static TextureStreamer& instance();
+
+        // Whether textures loaded from now on stream, picked once at startup like the vertex format
+        void set_enabled(bool enabled) { enabled_ = enabled; }
+        bool is_enabled() const { return enabled_; }
+
+        // Called by `Texture` when it starts streaming and when it's destroyed
+        void add(Texture* texture);
+
+        void remove(Texture* texture);
+
+        // Camera of the draws requested until the next call, set by the render queue
+        void set_view(const glm::vec3& position, float projection_scale);
+
+        // Height in pixels of the target the scene is drawn to, set by the application each frame
+        void set_viewport_height(int height);
+
+        // Asks for the level `texture` needs drawn on a mesh whose bounding sphere, in world
+        // space, is `center` and `radius`. Safe to call from the recording workers.
+        void request(Texture& texture, const glm::vec3& center, float radius) const;
+
+        // GL thread only. Uploads requested levels until `budget` bytes are spent, always at
+        // least one level so textures with levels larger than the budget still sharpen.
+        // Returns the bytes uploaded.
+        size_t update(size_t budget);
+
+        size_t update() { return update(frame_budget_); }
+
+        void set_frame_budget(size_t bytes) { frame_budget_ = bytes; }
+        size_t get_frame_budget() const { return frame_budget_; }
+
+        size_t size() const;
+
+        // Finest level worth sampling for a texture `texture_size` texels across drawn over
+        // a sphere of `radius` at `distance`, one texel per pixel of its on-screen diameter.
+        // Clamped to [0, `level_count` - 1].
+        static int desired_level(int texture_size, int level_count, float distance, float radius,
+                                 float projection_scale, int viewport_height);
+    };
+}
@@ -0,0 +1,38 @@
+#include "engine/renderer/UploadQueue.hpp"
+
+namespace Renderer {
+    UploadQueue& UploadQueue::instance() {
+        static UploadQueue instance;
+        return instance;
+    }
+
+    void UploadQueue::push(size_t bytes, std::function<void()> upload) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uploads_.push_back({bytes, std::move(upload)});
+    }
+
+    size_t UploadQueue::process(size_t budget) {
+        size_t n_run = 0;
+        size_t spent = 0;
+        while (true) {
+            Upload upload;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (uploads_.empty()) break;
+                if (n_run > 0 && spent + uploads_.front().bytes > budget) break;
+                upload = std::move(uploads_.front());
+                uploads_.pop_front();
+            }
+            // Outside the lock, an upload may request more resources that queue their own
+            upload.run();
+            spent += upload.bytes;
+            n_run++;
+        }
+        return n_run;
+    }
+
+    size_t UploadQueue::size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return uploads_.size();
+    }
+}
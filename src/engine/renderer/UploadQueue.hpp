@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace Renderer {
+    // GL work handed over by loader threads. Any thread can push an upload, and the GL
+    // thread runs a frame's worth of them at the start of each frame. Each upload carries
+    // its size in bytes, so a burst of finished loads is spread over several frames
+    // instead of stalling one.
+    class UploadQueue {
+    public:
+        static constexpr size_t DEFAULT_FRAME_BUDGET = 16 << 20;
+
+    private:
+        struct Upload {
+            size_t bytes = 0;
+            std::function<void()> run;
+        };
+
+        mutable std::mutex mutex_;
+        std::deque<Upload> uploads_;
+        size_t frame_budget_ = DEFAULT_FRAME_BUDGET;
+
+    public:
+        static UploadQueue& instance();
+
+        void push(size_t bytes, std::function<void()> upload);
+
+        // GL thread only. Runs uploads in order until `budget` bytes are spent, always at
+        // least one so uploads larger than the budget still get through. Returns the
+        // number of uploads run.
+        size_t process(size_t budget);
+
+        size_t process_frame() { return process(frame_budget_); }
+
+        void set_frame_budget(size_t bytes) { frame_budget_ = bytes; }
+        size_t get_frame_budget() const { return frame_budget_; }
+
+        size_t size() const;
+    };
+}
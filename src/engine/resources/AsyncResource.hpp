@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <memory>
+
+#include "engine/renderer/UploadQueue.hpp"
+#include "engine/utilities/JobSystem.hpp"
+
+// Load state of a resource that may still be loading in the background. Resources built
+// by their loading constructors are ready right away. `load_in_background()` instead hands
+// out the resource while a job system worker reads it from disk, and the GL thread uploads
+// it later through the `Renderer::UploadQueue`.
+class AsyncResource {
+public:
+    enum class State {
+        LOADING,
+        READY,
+        FAILED,
+    };
+
+private:
+    std::atomic<State> state_;
+
+protected:
+    explicit AsyncResource(State state = State::READY) : state_(state) {}
+
+    AsyncResource(AsyncResource&& other) noexcept : state_(other.get_state()) {}
+
+    AsyncResource& operator=(AsyncResource&& other) noexcept {
+        state_.store(other.get_state(), std::memory_order_release);
+        return *this;
+    }
+
+    ~AsyncResource() = default;
+
+public:
+    // Everything the resource wrote before becoming ready is visible to the caller
+    State get_state() const { return state_.load(std::memory_order_acquire); }
+
+    bool is_ready() const { return get_state() == State::READY; }
+
+    // `read(resource)` runs on a worker and returns the bytes `upload(resource)` will send
+    // to the GPU, which count against the upload queue's frame budget. `upload` runs on
+    // the GL thread. An exception from either marks the resource as failed. Reads only run
+    // on the pool's background threads, the frame's `parallel_for` calls never pick them up.
+    template<class Resource, class Read, class Upload>
+    static void load_in_background(const std::shared_ptr<Resource>& resource, Read read, Upload upload) {
+        JobSystem::instance().submit([resource, read, upload] {
+            size_t bytes = 0;
+            try {
+                bytes = read(*resource);
+            } catch (const std::exception& e) {
+                printf("ERROR — %s\n", e.what());
+                resource->state_.store(State::FAILED, std::memory_order_release);
+                return;
+            }
+
+            Renderer::UploadQueue::instance().push(bytes, [resource, upload] {
+                try {
+                    upload(*resource);
+                    resource->state_.store(State::READY, std::memory_order_release);
+                } catch (const std::exception& e) {
+                    printf("ERROR — %s\n", e.what());
+                    resource->state_.store(State::FAILED, std::memory_order_release);
+                }
+            });
+        });
+    }
+};
@@ -0,0 +1,298 @@
+#include "engine/resources/BlockCompression.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include "engine/utilities/JobSystem.hpp"
+
+namespace BlockCompression {
+    namespace {
+        uint16_t to_565(const float color[3]) {
+            const auto r = static_cast<uint16_t>(std::lround(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f));
+            const auto g = static_cast<uint16_t>(std::lround(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f));
+            const auto b = static_cast<uint16_t>(std::lround(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f));
+            return static_cast<uint16_t>(r << 11 | g << 5 | b);
+        }
+
+        void from_565(uint16_t color, int out[3]) {
+            const int r = color >> 11 & 31, g = color >> 5 & 63, b = color & 31;
+            out[0] = r << 3 | r >> 2;
+            out[1] = g << 2 | g >> 4;
+            out[2] = b << 3 | b >> 2;
+        }
+
+        void write_u16(unsigned char* out, uint16_t value) {
+            out[0] = static_cast<unsigned char>(value);
+            out[1] = static_cast<unsigned char>(value >> 8);
+        }
+
+        uint16_t read_u16(const unsigned char* in) {
+            return static_cast<uint16_t>(in[0] | in[1] << 8);
+        }
+
+        // The four-color palette of two 565 endpoints, as the GPU expands it
+        void color_palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+            from_565(c0, palette[0]);
+            from_565(c1, palette[1]);
+            for (int ch = 0; ch < 3; ch++) {
+                palette[2][ch] = (2 * palette[0][ch] + palette[1][ch]) / 3;
+                palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch]) / 3;
+            }
+        }
+
+        struct ColorFit {
+            uint16_t c0 = 0;
+            uint16_t c1 = 0;
+            uint32_t indices = 0;
+            int error = 0;
+        };
+
+        // Quantizes the endpoints and picks the closest palette entry per texel
+        ColorFit fit_endpoints(const unsigned char texels[64], const float end0[3], const float end1[3]) {
+            ColorFit fit;
+            fit.c0 = to_565(end0);
+            fit.c1 = to_565(end1);
+            // c0 > c1 selects the four-color mode, c0 == c1 is a solid block
+            if (fit.c0 < fit.c1) std::swap(fit.c0, fit.c1);
+            int palette[4][3];
+            color_palette(fit.c0, fit.c1, palette);
+
+            const int n_entries = fit.c0 == fit.c1 ? 1 : 4;
+            for (int i = 0; i < 16; i++) {
+                int best = 0, best_error = INT32_MAX;
+                for (int p = 0; p < n_entries; p++) {
+                    const int dr = texels[i * 4] - palette[p][0];
+                    const int dg = texels[i * 4 + 1] - palette[p][1];
+                    const int db = texels[i * 4 + 2] - palette[p][2];
+                    const int error = dr * dr + dg * dg + db * db;
+                    if (error < best_error) {
+                        best_error = error;
+                        best = p;
+                    }
+                }
+                fit.indices |= static_cast<uint32_t>(best) << (i * 2);
+                fit.error += best_error;
+            }
+            return fit;
+        }
+
+        // Endpoints along the principal axis of the block's colors, pulled in slightly
+        // since the extremes are rarely hit exactly once quantized
+        void encode_color(const unsigned char texels[64], unsigned char out[8]) {
+            float mean[3] = {};
+            for (int i = 0; i < 16; i++) {
+                for (int ch = 0; ch < 3; ch++) mean[ch] += texels[i * 4 + ch];
+            }
+            for (float& m: mean) m /= 16.0f;
+
+            float cov[6] = {};  // rr rg rb gg gb bb
+            for (int i = 0; i < 16; i++) {
+                const float r = texels[i * 4] - mean[0];
+                const float g = texels[i * 4 + 1] - mean[1];
+                const float b = texels[i * 4 + 2] - mean[2];
+                cov[0] += r * r;
+                cov[1] += r * g;
+                cov[2] += r * b;
+                cov[3] += g * g;
+                cov[4] += g * b;
+                cov[5] += b * b;
+            }
+            // Power iteration, a few steps are plenty for a 3x3 matrix
+            float axis[3] = {1.0f, 1.0f, 1.0f};
+            for (int step = 0; step < 8; step++) {
+                const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+                const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+                const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+                const float length = std::max({std::fabs(x), std::fabs(y), std::fabs(z)});
+                if (length < 1e-6f) break;
+                axis[0] = x / length;
+                axis[1] = y / length;
+                axis[2] = z / length;
+            }
+
+            float lo = 0.0f, hi = 0.0f;
+            for (int i = 0; i < 16; i++) {
+                const float t = (texels[i * 4] - mean[0]) * axis[0] + (texels[i * 4 + 1] - mean[1]) * axis[1] +
+                                (texels[i * 4 + 2] - mean[2]) * axis[2];
+                lo = std::min(lo, t);
+                hi = std::max(hi, t);
+            }
+            const float axis_length2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+            const float inset = (hi - lo) / 32.0f;
+            float end0[3], end1[3];
+            for (int ch = 0; ch < 3; ch++) {
+                const float unit = axis_length2 > 0.0f ? axis[ch] / axis_length2 : 0.0f;
+                end0[ch] = mean[ch] + (hi - inset) * unit;
+                end1[ch] = mean[ch] + (lo + inset) * unit;
+            }
+
+            ColorFit best = fit_endpoints(texels, end0, end1);
+
+            // One least squares pass over the endpoints, for the palette weights the indices
+            // picked. Helps blocks whose colors don't lie on a line.
+            if (best.c0 != best.c1) {
+                static const float WEIGHTS[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+                float a = 0.0f, b = 0.0f, c = 0.0f, x[3] = {}, y[3] = {};
+                for (int i = 0; i < 16; i++) {
+                    const float w = WEIGHTS[best.indices >> (i * 2) & 3];
+                    a += w * w;
+                    b += w * (1.0f - w);
+                    c += (1.0f - w) * (1.0f - w);
+                    for (int ch = 0; ch < 3; ch++) {
+                        x[ch] += w * texels[i * 4 + ch];
+                        y[ch] += (1.0f - w) * texels[i * 4 + ch];
+                    }
+                }
+                const float det = a * c - b * b;
+                if (std::fabs(det) > 1e-6f) {
+                    for (int ch = 0; ch < 3; ch++) {
+                        end0[ch] = (c * x[ch] - b * y[ch]) / det;
+                        end1[ch] = (a * y[ch] - b * x[ch]) / det;
+                    }
+                    const ColorFit refined = fit_endpoints(texels, end0, end1);
+                    if (refined.error < best.error) best = refined;
+                }
+            }
+
+            write_u16(out, best.c0);
+            write_u16(out + 2, best.c1);
+            for (int i = 0; i < 4; i++) out[4 + i] = static_cast<unsigned char>(best.indices >> (i * 8));
+        }
+
+        void encode_alpha(const unsigned char texels[64], unsigned char out[8]) {
+            int a0 = 0, a1 = 255;
+            for (int i = 0; i < 16; i++) {
+                a0 = std::max(a0, static_cast<int>(texels[i * 4 + 3]));
+                a1 = std::min(a1, static_cast<int>(texels[i * 4 + 3]));
+            }
+            // a0 > a1 selects the eight-value mode, equal endpoints make every index 0
+            int palette[8] = {a0, a1};
+            for (int p = 1; p < 7; p++) palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+
+            uint64_t indices = 0;
+            if (a0 != a1) {
+                for (int i = 0; i < 16; i++) {
+                    int best = 0, best_error = INT32_MAX;
+                    for (int p = 0; p < 8; p++) {
+                        const int error = std::abs(texels[i * 4 + 3] - palette[p]);
+                        if (error < best_error) {
+                            best_error = error;
+                            best = p;
+                        }
+                    }
+                    indices |= static_cast<uint64_t>(best) << (i * 3);
+                }
+            }
+            out[0] = static_cast<unsigned char>(a0);
+            out[1] = static_cast<unsigned char>(a1);
+            for (int b = 0; b < 6; b++) out[2 + b] = static_cast<unsigned char>(indices >> (b * 8));
+        }
+
+        void decode_color(const unsigned char in[8], bool four_color_only, unsigned char texels[64]) {
+            const uint16_t c0 = read_u16(in), c1 = read_u16(in + 2);
+            int palette[4][3];
+            color_palette(c0, c1, palette);
+            int alpha[4] = {255, 255, 255, 255};
+            if (c0 <= c1 && !four_color_only) {
+                // Three colors and transparent black
+                for (int ch = 0; ch < 3; ch++) {
+                    palette[2][ch] = (palette[0][ch] + palette[1][ch]) / 2;
+                    palette[3][ch] = 0;
+                }
+                alpha[3] = 0;
+            }
+            const uint32_t indices = in[4] | in[5] << 8 | in[6] << 16 | static_cast<uint32_t>(in[7]) << 24;
+            for (int i = 0; i < 16; i++) {
+                const int p = indices >> (i * 2) & 3;
+                for (int ch = 0; ch < 3; ch++) texels[i * 4 + ch] = static_cast<unsigned char>(palette[p][ch]);
+                texels[i * 4 + 3] = static_cast<unsigned char>(alpha[p]);
+            }
+        }
+
+        void decode_alpha(const unsigned char in[8], unsigned char texels[64]) {
+            const int a0 = in[0], a1 = in[1];
+            int palette[8] = {a0, a1};
+            if (a0 > a1) {
+                for (int p = 1; p < 7; p++) palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+            } else {
+                for (int p = 1; p < 5; p++) palette[p + 1] = ((5 - p) * a0 + p * a1) / 5;
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+            uint64_t indices = 0;
+            for (int b = 0; b < 6; b++) indices |= static_cast<uint64_t>(in[2 + b]) << (b * 8);
+            for (int i = 0; i < 16; i++) {
+                texels[i * 4 + 3] = static_cast<unsigned char>(palette[indices >> (i * 3) & 7]);
+            }
+        }
+
+        int blocks_across(int size) { return (size + 3) / 4; }
+    }
+
+    size_t block_bytes(Format format) {
+        switch (format) {
+            case Format::BC1:
+                return 8;
+            case Format::BC3:
+                return 16;
+        }
+        throw std::runtime_error("Unknown block format");
+    }
+
+    size_t image_bytes(Format format, int width, int height) {
+        return static_cast<size_t>(blocks_across(width)) * blocks_across(height) * block_bytes(format);
+    }
+
+    std::vector<unsigned char> compress(const unsigned char* rgba, int width, int height, Format format) {
+        const int blocks_x = blocks_across(width), blocks_y = blocks_across(height);
+        const size_t block_size = block_bytes(format);
+        std::vector<unsigned char> out(image_bytes(format, width, height));
+
+        JobSystem::instance().parallel_for(blocks_y, 4, [&](size_t begin, size_t end, size_t) {
+            unsigned char texels[64];
+            for (size_t by = begin; by < end; by++) {
+                for (int bx = 0; bx < blocks_x; bx++) {
+                    for (int i = 0; i < 16; i++) {
+                        const int x = std::min(bx * 4 + i % 4, width - 1);
+                        const int y = std::min(static_cast<int>(by) * 4 + i / 4, height - 1);
+                        std::copy_n(rgba + (static_cast<size_t>(y) * width + x) * 4, 4, texels + i * 4);
+                    }
+                    unsigned char* block = out.data() + (by * blocks_x + bx) * block_size;
+                    if (format == Format::BC3) {
+                        encode_alpha(texels, block);
+                        block += 8;
+                    }
+                    encode_color(texels, block);
+                }
+            }
+        });
+        return out;
+    }
+
+    std::vector<unsigned char> decompress(const unsigned char* blocks, int width, int height, Format format) {
+        const int blocks_x = blocks_across(width), blocks_y = blocks_across(height);
+        const size_t block_size = block_bytes(format);
+        std::vector<unsigned char> out(static_cast<size_t>(width) * height * 4);
+
+        unsigned char texels[64];
+        for (int by = 0; by < blocks_y; by++) {
+            for (int bx = 0; bx < blocks_x; bx++) {
+                const unsigned char* block = blocks + (static_cast<size_t>(by) * blocks_x + bx) * block_size;
+                if (format == Format::BC3) {
+                    decode_color(block + 8, true, texels);
+                    decode_alpha(block, texels);
+                } else {
+                    decode_color(block, false, texels);
+                }
+                for (int i = 0; i < 16; i++) {
+                    const int x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                    if (x >= width || y >= height) continue;
+                    std::copy_n(texels + i * 4, 4, out.data() + (static_cast<size_t>(y) * width + x) * 4);
+                }
+            }
+        }
+        return out;
+    }
+}
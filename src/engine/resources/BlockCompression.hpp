@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// CPU encoder and decoder for the S3TC block formats every desktop GL driver samples
+// natively. Images are split into 4x4 texel blocks, with edge blocks padded by repeating
+// the last row and column.
+//   BC1: 8 bytes per block, RGB at 4 bits per texel
+//   BC3: 16 bytes per block, BC1 color plus an interpolated alpha block, 8 bits per texel
+namespace BlockCompression {
+    enum class Format : unsigned int {
+        BC1 = 1,
+        BC3 = 3,
+    };
+
+    size_t block_bytes(Format format);
+
+    // Bytes of a `width` x `height` image in `format`
+    size_t image_bytes(Format format, int width, int height);
+
+    // `rgba` is tightly packed RGBA8. Blocks are encoded in parallel on the job system.
+    std::vector<unsigned char> compress(const unsigned char* rgba, int width, int height, Format format);
+
+    // Back to tightly packed RGBA8, for the software backend and drivers without S3TC
+    std::vector<unsigned char> decompress(const unsigned char* blocks, int width, int height, Format format);
+}
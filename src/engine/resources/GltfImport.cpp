@@ -0,0 +1,375 @@
+#include "engine/resources/Model.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+#include "engine/math/Quaternion.hpp"
+#include "engine/math/Simd.hpp"
+#include "engine/utilities/Json.hpp"
+
+// Reads the subset of glTF 2.0 our assets use straight from the files: the JSON is parsed
+// from a mapping of the .gltf and the .bin buffers are mapped, so accessor data is only
+// touched once, while it's interleaved into the engine's vertex layout. 32-bit index
+// accessors aren't even copied, the meshes borrow them from the mapping.
+//
+// Anything that would change what assimp imports (other primitive modes, non-float or
+// missing normals and positions, sparse accessors, embedded buffers or images, required
+// extensions, ...) makes `import_gltf()` return false, and the model goes through assimp.
+namespace Model {
+    namespace {
+        constexpr int GLTF_UNSIGNED_BYTE = 5121;
+        constexpr int GLTF_UNSIGNED_SHORT = 5123;
+        constexpr int GLTF_UNSIGNED_INT = 5125;
+        constexpr int GLTF_FLOAT = 5126;
+        constexpr int GLTF_TRIANGLES = 4;
+
+        // Extensions that change geometry or materials in ways the fast path doesn't replicate
+        constexpr const char* UNSUPPORTED_EXTENSIONS[] = {
+            "KHR_materials_pbrSpecularGlossiness",
+            "KHR_texture_transform",
+            "KHR_mesh_quantization",
+        };
+
+        struct Accessor {
+            const unsigned char* data = nullptr;
+            size_t count = 0;
+            size_t stride = 0;
+            int component_type = 0;
+
+            void read(size_t index, float* out, int components) const {
+                std::memcpy(out, data + index * stride, components * sizeof(float));
+            }
+
+            const float* floats(size_t index) const {
+                return reinterpret_cast<const float*>(data + index * stride);
+            }
+        };
+
+        // Thrown for files we could parse but don't handle, caught in `import_gltf()`
+        struct Unsupported {};
+
+        class GltfImporter {
+        private:
+            const std::string& path_;
+            const Json& json_;
+            std::vector<std::unique_ptr<MappedFile>>& buffers_;
+
+            std::runtime_error invalid(const std::string& reason) const {
+                return std::runtime_error("Invalid glTF file " + path_ + ": " + reason);
+            }
+
+            const MappedFile& buffer(size_t buffer_index) {
+                const Json& buffer = json_["buffers"][buffer_index];
+                if (!buffer.is_object()) throw invalid("buffer out of range");
+                if (buffer_index < buffers_.size() && buffers_[buffer_index]) return *buffers_[buffer_index];
+
+                const std::string& uri = buffer["uri"].as_string();
+                if (uri.empty() || uri.rfind("data:", 0) == 0 || uri.find('%') != std::string::npos) {
+                    throw Unsupported();
+                }
+                const auto bin_path = std::filesystem::path(path_).parent_path() / uri;
+                auto mapping = std::make_unique<MappedFile>(bin_path.string());
+                if (mapping->size() < index(buffer["byteLength"], 0)) throw invalid("buffer truncated");
+
+                if (buffers_.size() <= buffer_index) buffers_.resize(buffer_index + 1);
+                buffers_[buffer_index] = std::move(mapping);
+                return *buffers_[buffer_index];
+            }
+
+        public:
+            GltfImporter(const std::string& path, const Json& json, std::vector<std::unique_ptr<MappedFile>>& buffers)
+                : path_(path), json_(json), buffers_(buffers) {
+            }
+
+            // Non-negative integer field, `fallback` if absent
+            size_t index(const Json& value, size_t fallback = SIZE_MAX) const {
+                if (value.is_null()) return fallback;
+                const double number = value.as_number(-1.0);
+                if (number < 0.0 || number != std::floor(number) || number > 4294967295.0) throw invalid("bad index");
+                return static_cast<size_t>(number);
+            }
+
+            // Every element is checked to lie inside its buffer view and buffer
+            Accessor accessor(size_t accessor_index, int components) {
+                const Json& accessor = json_["accessors"][accessor_index];
+                if (!accessor.is_object()) throw invalid("accessor out of range");
+                if (accessor.contains("sparse") || !accessor.contains("bufferView")) throw Unsupported();
+
+                static const char* const TYPES[] = {"", "SCALAR", "VEC2", "VEC3", "VEC4"};
+                if (accessor["type"].as_string() != TYPES[components]) throw Unsupported();
+
+                Accessor out;
+                out.component_type = static_cast<int>(accessor["componentType"].as_number());
+                size_t component_size = 0;
+                switch (out.component_type) {
+                    case GLTF_UNSIGNED_BYTE: component_size = 1; break;
+                    case GLTF_UNSIGNED_SHORT: component_size = 2; break;
+                    case GLTF_UNSIGNED_INT:
+                    case GLTF_FLOAT: component_size = 4; break;
+                    default: throw Unsupported();
+                }
+                if (accessor["normalized"].as_bool()) throw Unsupported();
+
+                const Json& view = json_["bufferViews"][index(accessor["bufferView"])];
+                if (!view.is_object()) throw invalid("buffer view out of range");
+                const MappedFile& mapping = buffer(index(view["buffer"]));
+                const size_t view_offset = index(view["byteOffset"], 0);
+                const size_t view_length = index(view["byteLength"]);
+                if (view_offset > mapping.size() || view_length > mapping.size() - view_offset) {
+                    throw invalid("buffer view out of range");
+                }
+
+                const size_t element_size = components * component_size;
+                const size_t offset = index(accessor["byteOffset"], 0);
+                out.count = index(accessor["count"]);
+                out.stride = index(view["byteStride"], element_size);
+                if (out.stride < element_size) throw invalid("stride smaller than element");
+                if (out.count > 0 && (offset > view_length || element_size > view_length - offset ||
+                                      (out.count - 1) > (view_length - offset - element_size) / out.stride)) {
+                    throw invalid("accessor out of range");
+                }
+                out.data = mapping.data() + view_offset + offset;
+                return out;
+            }
+        };
+
+        // Pos vec3; Norm vec3; UV vec2 per vertex, with V flipped to GL's bottom-left origin
+        // like assimp's glTF importer does
+        void interleave(const Accessor& positions, const Accessor& normals, const Accessor* uvs, float* out) {
+            const size_t count = positions.count;
+            size_t i = 0;
+            // Four-float loads read one float past each vec3. That's still inside the buffer
+            // view for every vertex but the last, the stride is at least 12 bytes.
+            for (; i + 1 < count; i++) {
+                float* vertex = out + i * 8;
+                Math::Float4::load(positions.floats(i)).store(vertex);
+                // Overwrites the junk 4th lane of the position
+                Math::Float4::load(normals.floats(i)).store(vertex + 3);
+                if (uvs) {
+                    uvs->read(i, vertex + 6, 2);
+                    vertex[7] = 1.0f - vertex[7];
+                } else {
+                    vertex[6] = 0.0f;
+                    vertex[7] = 0.0f;
+                }
+            }
+            for (; i < count; i++) {
+                float* vertex = out + i * 8;
+                positions.read(i, vertex, 3);
+                normals.read(i, vertex + 3, 3);
+                if (uvs) {
+                    uvs->read(i, vertex + 6, 2);
+                    vertex[7] = 1.0f - vertex[7];
+                } else {
+                    vertex[6] = 0.0f;
+                    vertex[7] = 0.0f;
+                }
+            }
+        }
+
+        template<class Index>
+        void widen_indices(const Accessor& accessor, std::vector<unsigned int>& out) {
+            out.resize(accessor.count);
+            for (size_t i = 0; i < accessor.count; i++) {
+                Index index;
+                std::memcpy(&index, accessor.data + i * accessor.stride, sizeof(Index));
+                out[i] = index;
+            }
+        }
+
+        Transform node_transform(const Json& node) {
+            Transform transform;
+            const Json& matrix = node["matrix"];
+            if (matrix.size() == 16) {
+                // glTF matrices are column major
+                for (size_t column = 0; column < 4; column++) {
+                    for (size_t row = 0; row < 4; row++) {
+                        transform.at(row, column) = matrix[column * 4 + row].as_number();
+                    }
+                }
+                return transform;
+            }
+
+            const Json& t = node["translation"];
+            const Json& r = node["rotation"];  // x, y, z, w
+            const Json& s = node["scale"];
+            Transform translation, scale;
+            translation.at(0, 3) = t[0].as_number();
+            translation.at(1, 3) = t[1].as_number();
+            translation.at(2, 3) = t[2].as_number();
+            scale.at(0, 0) = s[0].as_number(1.0);
+            scale.at(1, 1) = s[1].as_number(1.0);
+            scale.at(2, 2) = s[2].as_number(1.0);
+            const Quaternion rotation(r[0].as_number(), r[1].as_number(), r[2].as_number(), r[3].as_number(1.0));
+            return translation * Transform(rotation) * scale;
+        }
+    }
+
+    bool Model::import_gltf(const std::string& gltf_path) {
+        const MappedFile file(gltf_path);
+        const Json json = Json::parse(std::string_view(reinterpret_cast<const char*>(file.data()), file.size()));
+
+        if (json["extensionsRequired"].size() > 0 || !json["scenes"].is_array()) return false;
+        for (size_t i = 0; i < json["extensionsUsed"].size(); i++) {
+            for (const char* extension: UNSUPPORTED_EXTENSIONS) {
+                if (json["extensionsUsed"][i].as_string() == extension) return false;
+            }
+        }
+
+        // Built on the side, the model is only touched once the whole file is accepted
+        std::vector<std::unique_ptr<MappedFile>> buffers;
+        std::vector<Mesh> meshes;
+        std::vector<Material> materials;
+        std::vector<MeshInstance> instances;
+        GltfImporter importer(gltf_path, json, buffers);
+
+        try {
+            const Json& gltf_materials = json["materials"];
+            materials.reserve(gltf_materials.size() + 1);
+            for (size_t i = 0; i < gltf_materials.size(); i++) {
+                const Json& pbr = gltf_materials[i]["pbrMetallicRoughness"];
+                const Json& color = pbr["baseColorFactor"];
+                const Vector3 base_color(color[0].as_number(1.0), color[1].as_number(1.0), color[2].as_number(1.0));
+                // Same roughness to shininess mapping as assimp
+                const double smoothness = 1.0 - pbr["roughnessFactor"].as_number(1.0);
+                const float shininess = static_cast<float>(smoothness * smoothness * 1000.0);
+
+                std::string texture_name;
+                const Json& texture_info = pbr["baseColorTexture"];
+                if (texture_info.is_object()) {
+                    const Json& texture = json["textures"][importer.index(texture_info["index"])];
+                    const Json& image = json["images"][importer.index(texture["source"])];
+                    if (!image["uri"].is_string()) return false;
+                    texture_name = std::filesystem::path(image["uri"].as_string()).filename().string();
+                }
+                materials.emplace_back(base_color, shininess, std::move(texture_name));
+            }
+            // Primitives without a material get glTF's default one, appended when first needed
+            const unsigned int default_material = static_cast<unsigned int>(materials.size());
+
+            // glTF meshes are lists of primitives, each primitive becomes one of our meshes
+            const Json& gltf_meshes = json["meshes"];
+            std::vector<std::pair<unsigned int, unsigned int>> primitive_ranges(gltf_meshes.size());
+            for (size_t i = 0; i < gltf_meshes.size(); i++) {
+                const Json& primitives = gltf_meshes[i]["primitives"];
+                primitive_ranges[i] = {static_cast<unsigned int>(meshes.size()),
+                                       static_cast<unsigned int>(primitives.size())};
+                for (size_t p = 0; p < primitives.size(); p++) {
+                    const Json& primitive = primitives[p];
+                    if (primitive["mode"].as_number(GLTF_TRIANGLES) != GLTF_TRIANGLES) return false;
+
+                    const Json& attributes = primitive["attributes"];
+                    if (!attributes.contains("POSITION") || !attributes.contains("NORMAL")) return false;
+                    const Accessor positions = importer.accessor(
+                        importer.index(attributes["POSITION"]), 3);
+                    const Accessor normals = importer.accessor(
+                        importer.index(attributes["NORMAL"]), 3);
+                    std::optional<Accessor> uvs;
+                    if (attributes.contains("TEXCOORD_0")) {
+                        uvs = importer.accessor(importer.index(attributes["TEXCOORD_0"]), 2);
+                    }
+                    if (positions.component_type != GLTF_FLOAT || normals.component_type != GLTF_FLOAT ||
+                        (uvs && uvs->component_type != GLTF_FLOAT)) {
+                        return false;
+                    }
+                    if (normals.count != positions.count || (uvs && uvs->count != positions.count)) {
+                        throw std::runtime_error("Invalid glTF file " + gltf_path + ": attribute counts differ");
+                    }
+
+                    std::vector<float> vertex_data(positions.count * 8);
+                    interleave(positions, normals, uvs ? &*uvs : nullptr, vertex_data.data());
+
+                    std::vector<unsigned int> index_data;
+                    Span<unsigned int> index_view;
+                    if (primitive.contains("indices")) {
+                        const Accessor indices = importer.accessor(
+                            importer.index(primitive["indices"]), 1);
+                        if (indices.component_type == GLTF_UNSIGNED_INT &&
+                            reinterpret_cast<uintptr_t>(indices.data) % alignof(unsigned int) == 0) {
+                            index_view = Span<unsigned int>(reinterpret_cast<const unsigned int*>(indices.data),
+                                                            indices.count);
+                        } else if (indices.component_type == GLTF_UNSIGNED_INT) {
+                            widen_indices<uint32_t>(indices, index_data);
+                        } else if (indices.component_type == GLTF_UNSIGNED_SHORT) {
+                            widen_indices<uint16_t>(indices, index_data);
+                        } else if (indices.component_type == GLTF_UNSIGNED_BYTE) {
+                            widen_indices<uint8_t>(indices, index_data);
+                        } else {
+                            return false;
+                        }
+                    } else {
+                        index_data.resize(positions.count);
+                        for (size_t v = 0; v < positions.count; v++) index_data[v] = static_cast<unsigned int>(v);
+                    }
+                    if (index_view.empty()) index_view = index_data;
+                    if (index_view.size() % 3 != 0) return false;
+                    for (unsigned int index: index_view) {
+                        if (index >= positions.count) {
+                            throw std::runtime_error("Invalid glTF file " + gltf_path + ": index out of range");
+                        }
+                    }
+
+                    unsigned int material_index = default_material;
+                    if (primitive.contains("material")) {
+                        material_index = static_cast<unsigned int>(importer.index(primitive["material"]));
+                        if (material_index >= default_material) {
+                            throw std::runtime_error("Invalid glTF file " + gltf_path + ": material out of range");
+                        }
+                    } else if (materials.size() == default_material) {
+                        materials.emplace_back(Vector3(1.0), 0.0f, "");
+                    }
+
+                    if (index_data.empty()) {
+                        meshes.emplace_back(std::move(vertex_data), index_view, material_index);
+                    } else {
+                        meshes.emplace_back(std::move(vertex_data), std::move(index_data), material_index);
+                    }
+                }
+            }
+
+            // Flatten the default scene's node trees, glTF nodes can't form cycles but a
+            // broken file could, so the depth is capped at the node count
+            const Json& nodes = json["nodes"];
+            const Json& scene = json["scenes"][importer.index(json["scene"], 0)];
+            auto flatten = [&](auto&& self, size_t node_index, const Transform& parent, size_t depth) -> void {
+                const Json& node = nodes[node_index];
+                if (!node.is_object() || depth > nodes.size()) {
+                    throw std::runtime_error("Invalid glTF file " + gltf_path + ": bad node hierarchy");
+                }
+                const Transform transform = parent * node_transform(node);
+                if (node.contains("mesh")) {
+                    const glm::mat4 model_space = transform.to_glm();
+                    const size_t mesh_index = importer.index(node["mesh"]);
+                    if (mesh_index >= primitive_ranges.size()) {
+                        throw std::runtime_error("Invalid glTF file " + gltf_path + ": mesh out of range");
+                    }
+                    const auto [first, count] = primitive_ranges[mesh_index];
+                    for (unsigned int m = first; m < first + count; m++) instances.push_back({m, model_space});
+                }
+                const Json& children = node["children"];
+                for (size_t c = 0; c < children.size(); c++) {
+                    self(self, importer.index(children[c]), transform, depth + 1);
+                }
+            };
+            const Json& roots = scene["nodes"];
+            for (size_t r = 0; r < roots.size(); r++) {
+                flatten(flatten, importer.index(roots[r]), Transform(), 0);
+            }
+        } catch (const Unsupported&) {
+            return false;
+        }
+
+        meshes_ = std::move(meshes);
+        materials_ = std::move(materials);
+        instances_ = std::move(instances);
+        for (auto& buffer: buffers) {
+            if (buffer) mappings_.push_back(std::move(buffer));
+        }
+        return true;
+    }
+}
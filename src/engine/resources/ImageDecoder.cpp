@@ -0,0 +1,98 @@
+#include "engine/resources/ImageDecoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+#include <stb_image.h>
+
+#include "engine/utilities/AssetArchive.hpp"
+
+namespace ImageDecoder {
+    namespace {
+        struct Pool {
+            std::mutex mutex;
+            std::vector<std::vector<unsigned char>> buffers;
+            size_t bytes = 0;
+        };
+
+        Pool& pool() {
+            static Pool pool;
+            return pool;
+        }
+    }
+
+    Image decode(const std::string& path, bool flip_vertically, int desired_channels) {
+        Image image;
+        unsigned char* data = nullptr;
+        if (const auto packed = AssetArchive::find_mounted(path)) {
+            data = stbi_load_from_memory(packed->data(), static_cast<int>(packed->size()),
+                                         &image.width, &image.height, &image.channels, desired_channels);
+        } else {
+            data = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, desired_channels);
+        }
+        if (!data) throw std::runtime_error("Failed to load image: " + path);
+        if (desired_channels != 0) image.channels = desired_channels;
+
+        const size_t row_bytes = static_cast<size_t>(image.width) * image.channels;
+        image.pixels = acquire_buffer(row_bytes * image.height);
+        if (flip_vertically) {
+            for (int row = 0; row < image.height; row++) {
+                std::memcpy(&image.pixels[(image.height - 1 - row) * row_bytes], data + row * row_bytes, row_bytes);
+            }
+        } else {
+            std::memcpy(image.pixels.data(), data, row_bytes * image.height);
+        }
+        stbi_image_free(data);
+        return image;
+    }
+
+    std::vector<unsigned char> acquire_buffer(size_t size) {
+        std::vector<unsigned char> buffer;
+        {
+            Pool& p = pool();
+            std::lock_guard<std::mutex> lock(p.mutex);
+            // Smallest that fits, so large buffers stay around for large images
+            auto best = p.buffers.end();
+            for (auto it = p.buffers.begin(); it != p.buffers.end(); ++it) {
+                if (it->capacity() < size || it->capacity() / MAX_REUSE_FACTOR > size) continue;
+                if (best == p.buffers.end() || it->capacity() < best->capacity()) {
+                    best = it;
+                }
+            }
+            if (best != p.buffers.end()) {
+                p.bytes -= best->capacity();
+                std::swap(*best, p.buffers.back());
+                buffer = std::move(p.buffers.back());
+                p.buffers.pop_back();
+            }
+        }
+        // Within the capacity this doesn't reallocate
+        buffer.resize(size);
+        return buffer;
+    }
+
+    void release_buffer(std::vector<unsigned char>&& buffer) {
+        std::vector<unsigned char> released = std::move(buffer);
+        if (released.capacity() == 0) return;
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        if (p.bytes + released.capacity() > MAX_POOLED_BYTES) return;
+        p.bytes += released.capacity();
+        p.buffers.push_back(std::move(released));
+    }
+
+    size_t pooled_bytes() {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        return p.bytes;
+    }
+
+    void clear_pool() {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        p.buffers.clear();
+        p.bytes = 0;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Image decoding that is safe on any number of threads at once. stb_image's vertical flip
+// is a process-wide setting, so nothing here touches it: images are decoded top down and
+// flipped, when asked, while their rows are copied out of stb's buffer. The copies land in
+// buffers recycled through a pool, so a stream of texture loads reuses the pixel buffers
+// of textures already uploaded instead of allocating new ones.
+namespace ImageDecoder {
+    // Released buffers are kept up to this many bytes, larger ones are freed
+    constexpr size_t MAX_POOLED_BYTES = 64 << 20;
+    // Pooled buffers are only reused for images at least 1/Nth their size, since textures
+    // keep (and memory accounting counts) the whole capacity
+    constexpr size_t MAX_REUSE_FACTOR = 2;
+
+    struct Image {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        std::vector<unsigned char> pixels;  // Rows bottom up when flipped, from the pool
+    };
+
+    // Decodes the image at `path`, or its entry in the mounted `AssetArchive`, with
+    // `desired_channels` channels, or the file's with 0. Throws if it can't be read or decoded.
+    Image decode(const std::string& path, bool flip_vertically, int desired_channels = 0);
+
+    // A buffer of `size` bytes, reusing a released one when one is large enough but not
+    // more than `MAX_REUSE_FACTOR` times too large. The contents are undefined.
+    std::vector<unsigned char> acquire_buffer(size_t size);
+
+    // Hands `buffer` back once its pixels are no longer needed, e.g. after the GL upload
+    void release_buffer(std::vector<unsigned char>&& buffer);
+
+    // Capacity of the buffers waiting in the pool
+    size_t pooled_bytes();
+
+    // Frees every pooled buffer
+    void clear_pool();
+}
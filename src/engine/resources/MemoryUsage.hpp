@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+// Bytes a resource holds in system memory (decoded data, mapped files) and in GPU memory
+struct MemoryUsage {
+    size_t cpu_bytes = 0;
+    size_t gpu_bytes = 0;
+
+    size_t total() const { return cpu_bytes + gpu_bytes; }
+
+    MemoryUsage& operator+=(const MemoryUsage& other) {
+        cpu_bytes += other.cpu_bytes;
+        gpu_bytes += other.gpu_bytes;
+        return *this;
+    }
+};
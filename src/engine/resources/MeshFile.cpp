@@ -0,0 +1,205 @@
+#include "engine/resources/MeshFile.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "engine/resources/Model.hpp"
+
+namespace Model {
+    namespace MeshFile {
+        static_assert(sizeof(Header) == 88, "Header layout changed, bump VERSION");
+        static_assert(sizeof(MeshRecord) == 56, "MeshRecord layout changed, bump VERSION");
+        static_assert(sizeof(MaterialRecord) == 48, "MaterialRecord layout changed, bump VERSION");
+        static_assert(sizeof(InstanceRecord) == 80, "InstanceRecord layout changed, bump VERSION");
+
+        static size_t align(size_t offset) {
+            return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        }
+
+        static void copy_vec3(const glm::vec3& v, float* out) {
+            out[0] = v.x;
+            out[1] = v.y;
+            out[2] = v.z;
+        }
+
+        static void copy_vec3(const Vector3& v, float* out) {
+            out[0] = static_cast<float>(v.x);
+            out[1] = static_cast<float>(v.y);
+            out[2] = static_cast<float>(v.z);
+        }
+
+        void write(const Model& model, const std::string& path) {
+            const auto& meshes = model.get_meshes();
+            const auto& materials = model.get_materials();
+            const auto& instances = model.get_instances();
+
+            std::string strings;
+            std::vector<MaterialRecord> material_records(materials.size());
+            for (size_t i = 0; i < materials.size(); i++) {
+                const Material& material = materials[i];
+                MaterialRecord& record = material_records[i];
+                copy_vec3(material.get_ambient(), record.ambient);
+                copy_vec3(material.get_diffuse(), record.diffuse);
+                copy_vec3(material.get_specular(), record.specular);
+                record.shininess = material.get_shininess();
+                record.texture_name_offset = static_cast<uint32_t>(strings.size());
+                record.texture_name_length = static_cast<uint32_t>(material.get_texture_name().size());
+                strings += material.get_texture_name();
+            }
+
+            std::vector<InstanceRecord> instance_records(instances.size());
+            for (size_t i = 0; i < instances.size(); i++) {
+                instance_records[i].mesh_index = instances[i].mesh_index;
+                for (int column = 0; column < 4; column++) {
+                    for (int row = 0; row < 4; row++) {
+                        instance_records[i].transform[column * 4 + row] = instances[i].transform[column][row];
+                    }
+                }
+            }
+
+            Header header;
+            header.mesh_count = static_cast<uint32_t>(meshes.size());
+            header.material_count = static_cast<uint32_t>(materials.size());
+            header.instance_count = static_cast<uint32_t>(instances.size());
+            header.string_table_size = static_cast<uint32_t>(strings.size());
+            header.meshes_offset = align(sizeof(Header));
+            header.materials_offset = align(header.meshes_offset + meshes.size() * sizeof(MeshRecord));
+            header.instances_offset = align(header.materials_offset + materials.size() * sizeof(MaterialRecord));
+            header.strings_offset = align(header.instances_offset + instances.size() * sizeof(InstanceRecord));
+            copy_vec3(model.get_bounds().min, header.bounds_min);
+            copy_vec3(model.get_bounds().max, header.bounds_max);
+
+            // Blobs go after the tables, each starting on an aligned offset
+            size_t offset = align(header.strings_offset + strings.size());
+            std::vector<MeshRecord> mesh_records(meshes.size());
+            for (size_t i = 0; i < meshes.size(); i++) {
+                const Mesh& mesh = meshes[i];
+                MeshRecord& record = mesh_records[i];
+                record.vertex_count = static_cast<uint32_t>(mesh.get_vertex_data().size() / 8);
+                record.index_count = static_cast<uint32_t>(mesh.get_indices().size());
+                record.material_index = mesh.get_material_index();
+                record.vertex_format = static_cast<uint32_t>(Renderer::VertexFormat::POSITION_NORMAL_UV);
+                const Bounds bounds = mesh.compute_bounds();
+                copy_vec3(bounds.min, record.bounds_min);
+                copy_vec3(bounds.max, record.bounds_max);
+
+                record.vertex_offset = offset;
+                offset = align(offset + mesh.get_vertex_data().size() * sizeof(float));
+                record.index_offset = offset;
+                offset = align(offset + mesh.get_indices().size() * sizeof(unsigned int));
+            }
+            header.file_size = offset;
+
+            std::vector<unsigned char> bytes(offset, 0);
+            auto put = [&bytes](size_t at, const void* data, size_t size) {
+                if (size > 0) std::memcpy(bytes.data() + at, data, size);
+            };
+            put(0, &header, sizeof(Header));
+            put(header.meshes_offset, mesh_records.data(), mesh_records.size() * sizeof(MeshRecord));
+            put(header.materials_offset, material_records.data(), material_records.size() * sizeof(MaterialRecord));
+            put(header.instances_offset, instance_records.data(), instance_records.size() * sizeof(InstanceRecord));
+            put(header.strings_offset, strings.data(), strings.size());
+            for (size_t i = 0; i < meshes.size(); i++) {
+                put(mesh_records[i].vertex_offset, meshes[i].get_vertex_data().data(),
+                    meshes[i].get_vertex_data().size() * sizeof(float));
+                put(mesh_records[i].index_offset, meshes[i].get_indices().data(),
+                    meshes[i].get_indices().size() * sizeof(unsigned int));
+            }
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!file) throw std::runtime_error("Failed to write mesh file: " + path);
+        }
+    }
+
+    void Model::import_mesh_file(const std::string& mesh_path) {
+        using namespace MeshFile;
+
+        const MappedFile& mapping = *mappings_.emplace_back(std::make_unique<MappedFile>(mesh_path));
+        const unsigned char* base = mapping.data();
+        const size_t size = mapping.size();
+        auto invalid = [&mesh_path](const char* reason) {
+            return std::runtime_error("Invalid mesh file " + mesh_path + ": " + reason);
+        };
+        // Every range is checked against the mapping before it's read
+        auto in_file = [size](uint64_t offset, uint64_t count, size_t element_size) {
+            return offset <= size && count <= (size - offset) / element_size;
+        };
+
+        if (size < sizeof(Header)) throw invalid("truncated header");
+        const Header& header = *reinterpret_cast<const Header*>(base);
+        if (header.magic != MAGIC) throw invalid("bad magic");
+        if (header.version != VERSION) throw invalid("unsupported version");
+        if (header.file_size != size) throw invalid("truncated");
+        if (!in_file(header.meshes_offset, header.mesh_count, sizeof(MeshRecord)) ||
+            !in_file(header.materials_offset, header.material_count, sizeof(MaterialRecord)) ||
+            !in_file(header.instances_offset, header.instance_count, sizeof(InstanceRecord)) ||
+            !in_file(header.strings_offset, header.string_table_size, 1)) {
+            throw invalid("table out of range");
+        }
+
+        const auto* material_records = reinterpret_cast<const MaterialRecord*>(base + header.materials_offset);
+        const char* strings = reinterpret_cast<const char*>(base + header.strings_offset);
+        materials_.reserve(header.material_count);
+        for (uint32_t i = 0; i < header.material_count; i++) {
+            const MaterialRecord& record = material_records[i];
+            if (static_cast<uint64_t>(record.texture_name_offset) + record.texture_name_length >
+                header.string_table_size) {
+                throw invalid("texture name out of range");
+            }
+            auto vec3 = [](const float* v) { return Vector3(v[0], v[1], v[2]); };
+            materials_.emplace_back(vec3(record.ambient), vec3(record.diffuse), vec3(record.specular),
+                                    record.shininess,
+                                    std::string(strings + record.texture_name_offset, record.texture_name_length));
+        }
+
+        const auto* mesh_records = reinterpret_cast<const MeshRecord*>(base + header.meshes_offset);
+        meshes_.reserve(header.mesh_count);
+        for (uint32_t i = 0; i < header.mesh_count; i++) {
+            const MeshRecord& record = mesh_records[i];
+            if (record.vertex_format != static_cast<uint32_t>(Renderer::VertexFormat::POSITION_NORMAL_UV)) {
+                throw invalid("unsupported vertex format");
+            }
+            if (!in_file(record.vertex_offset, record.vertex_count, 8 * sizeof(float)) ||
+                !in_file(record.index_offset, record.index_count, sizeof(unsigned int)) ||
+                record.vertex_offset % ALIGNMENT != 0 || record.index_offset % ALIGNMENT != 0) {
+                throw invalid("mesh data out of range");
+            }
+            if (record.material_index >= header.material_count) throw invalid("material index out of range");
+            if (record.vertex_count == 0 && record.index_count > 0) throw invalid("indices without vertices");
+
+            // Borrowed straight from the mapping, the upload reads the mapped pages
+            const Span<unsigned int> index_view(reinterpret_cast<const unsigned int*>(base + record.index_offset),
+                                                record.index_count);
+            for (const unsigned int index: index_view) {
+                if (index >= record.vertex_count) throw invalid("index out of range");
+            }
+            meshes_.emplace_back(
+                Span<float>(reinterpret_cast<const float*>(base + record.vertex_offset),
+                            static_cast<size_t>(record.vertex_count) * 8),
+                index_view,
+                record.material_index
+            );
+        }
+
+        const auto* instance_records = reinterpret_cast<const InstanceRecord*>(base + header.instances_offset);
+        instances_.reserve(header.instance_count);
+        for (uint32_t i = 0; i < header.instance_count; i++) {
+            const InstanceRecord& record = instance_records[i];
+            if (record.mesh_index >= header.mesh_count) throw invalid("mesh index out of range");
+            MeshInstance instance;
+            instance.mesh_index = record.mesh_index;
+            for (int column = 0; column < 4; column++) {
+                for (int row = 0; row < 4; row++) {
+                    instance.transform[column][row] = record.transform[column * 4 + row];
+                }
+            }
+            instances_.push_back(instance);
+        }
+
+        bounds_.min = glm::vec3(header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]);
+        bounds_.max = glm::vec3(header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]);
+    }
+}
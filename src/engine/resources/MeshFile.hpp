@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Model {
+    class Model;
+
+    // Compiled model format, written by the mesh_compiler tool and preferred by `ModelLoader`
+    // over the source file when present. The file is a header, fixed-size record tables
+    // and then the vertex and index blobs, every section aligned to `ALIGNMENT` bytes, so
+    // loading maps the file and hands the blobs to GL straight from the mapped pages.
+    //
+    // Offsets are bytes from the start of the file. All fields are little endian, which
+    // every platform we build for is.
+    namespace MeshFile {
+        constexpr uint32_t MAGIC = 0x4D444C47;  // "GLDM"
+        constexpr uint32_t VERSION = 1;
+        constexpr size_t ALIGNMENT = 16;
+
+        struct Header {
+            uint32_t magic = MAGIC;
+            uint32_t version = VERSION;
+            uint32_t mesh_count = 0;
+            uint32_t material_count = 0;
+            uint32_t instance_count = 0;
+            uint32_t string_table_size = 0;
+            uint64_t file_size = 0;  // Catches truncated files
+            uint64_t meshes_offset = 0;
+            uint64_t materials_offset = 0;
+            uint64_t instances_offset = 0;
+            uint64_t strings_offset = 0;
+            float bounds_min[3] = {};  // Model space, over every mesh instance
+            float bounds_max[3] = {};
+        };
+
+        struct MeshRecord {
+            uint64_t vertex_offset = 0;
+            uint64_t index_offset = 0;
+            uint32_t vertex_count = 0;
+            uint32_t index_count = 0;
+            uint32_t material_index = 0;
+            uint32_t vertex_format = 0;  // `Renderer::VertexFormat`
+            float bounds_min[3] = {};    // Mesh space
+            float bounds_max[3] = {};
+        };
+
+        struct MaterialRecord {
+            float ambient[3] = {};
+            float diffuse[3] = {};
+            float specular[3] = {};
+            float shininess = 0.0f;
+            uint32_t texture_name_offset = 0;  // Into the string table, no texture if the length is 0
+            uint32_t texture_name_length = 0;
+        };
+
+        struct InstanceRecord {
+            float transform[16] = {};  // Column major
+            uint32_t mesh_index = 0;
+            uint32_t padding[3] = {};
+        };
+
+        // Throws if the file can't be written
+        void write(const Model& model, const std::string& path);
+    }
+}
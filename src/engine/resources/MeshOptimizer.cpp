@@ -0,0 +1,302 @@
+#include "engine/resources/MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+#include <glm/glm.hpp>
+
+namespace MeshOptimizer {
+    namespace {
+        constexpr unsigned int NONE = std::numeric_limits<unsigned int>::max();
+
+        // FIFO cache simulation. An entry is still cached while fewer than `size` misses
+        // have happened since it was inserted, so flushing is just skipping time ahead.
+        class FifoCache {
+        private:
+            std::vector<unsigned int> timestamps_;
+            unsigned int size_;
+            unsigned int time_;
+
+        public:
+            FifoCache(size_t n_vertices, unsigned int size)
+                : timestamps_(n_vertices, 0), size_(size), time_(size + 1) {
+            }
+
+            bool miss(unsigned int vertex) {
+                if (time_ - timestamps_[vertex] <= size_) return false;
+                timestamps_[vertex] = time_++;
+                return true;
+            }
+
+            unsigned int triangle_misses(const unsigned int* triangle) {
+                return miss(triangle[0]) + miss(triangle[1]) + miss(triangle[2]);
+            }
+
+            void flush() { time_ += size_ + 1; }
+        };
+
+        // Forsyth's scoring. The cache modelled here is a larger LRU than the FIFO the
+        // analysis assumes, which orders well across cache sizes.
+        constexpr unsigned int SCORE_CACHE_SIZE = 32;
+        constexpr float CACHE_DECAY_POWER = 1.5f;
+        constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+        constexpr float VALENCE_BOOST_SCALE = 2.0f;
+        constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+        float vertex_score(int cache_position, unsigned int live_triangles) {
+            // Vertices with nothing left to draw shouldn't attract anything
+            if (live_triangles == 0) return -1.0f;
+
+            float score = 0.0f;
+            if (cache_position >= 0) {
+                if (cache_position < 3) {
+                    // Fixed score for the triangle just drawn, so the next one isn't biased
+                    // towards whichever of its vertices went in first
+                    score = LAST_TRIANGLE_SCORE;
+                } else {
+                    const float scaled = 1.0f - static_cast<float>(cache_position - 3) / (SCORE_CACHE_SIZE - 3);
+                    score = std::pow(scaled, CACHE_DECAY_POWER);
+                }
+            }
+            // Vertices with few triangles left get finished off first, so they leave for good
+            return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(live_triangles), -VALENCE_BOOST_POWER);
+        }
+    }
+
+    CacheStats analyze_vertex_cache(const unsigned int* indices, size_t n_indices, size_t n_vertices,
+                                    unsigned int cache_size) {
+        CacheStats stats;
+        const size_t n_triangles = n_indices / 3;
+        if (n_triangles == 0 || n_vertices == 0) return stats;
+
+        FifoCache cache(n_vertices, cache_size);
+        size_t misses = 0;
+        for (size_t t = 0; t < n_triangles; t++) {
+            misses += cache.triangle_misses(&indices[t * 3]);
+        }
+        stats.acmr = static_cast<float>(misses) / static_cast<float>(n_triangles);
+        stats.atvr = static_cast<float>(misses) / static_cast<float>(n_vertices);
+        return stats;
+    }
+
+    void optimize_vertex_cache(unsigned int* indices, size_t n_indices, size_t n_vertices) {
+        const size_t n_triangles = n_indices / 3;
+        if (n_triangles == 0) return;
+
+        // Triangles using each vertex, those not drawn yet come first in its range
+        std::vector<unsigned int> live(n_vertices, 0);
+        for (size_t i = 0; i < n_triangles * 3; i++) {
+            assert(indices[i] < n_vertices);
+            live[indices[i]]++;
+        }
+        std::vector<unsigned int> offsets(n_vertices + 1, 0);
+        for (size_t v = 0; v < n_vertices; v++) offsets[v + 1] = offsets[v] + live[v];
+        std::vector<unsigned int> adjacency(n_triangles * 3);
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < n_triangles * 3; i++) {
+            adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+
+        std::vector<int> cache_position(n_vertices, -1);
+        std::vector<float> vertex_scores(n_vertices);
+        for (size_t v = 0; v < n_vertices; v++) vertex_scores[v] = vertex_score(-1, live[v]);
+        std::vector<float> triangle_scores(n_triangles);
+        for (size_t t = 0; t < n_triangles; t++) {
+            triangle_scores[t] = vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] +
+                                 vertex_scores[indices[t * 3 + 2]];
+        }
+        std::vector<bool> emitted(n_triangles, false);
+
+        std::vector<unsigned int> output;
+        output.reserve(n_triangles * 3);
+        std::vector<unsigned int> cache, next_cache;
+        cache.reserve(SCORE_CACHE_SIZE + 3);
+        next_cache.reserve(SCORE_CACHE_SIZE + 3);
+
+        unsigned int best = static_cast<unsigned int>(
+            std::max_element(triangle_scores.begin(), triangle_scores.end()) - triangle_scores.begin());
+        size_t cursor = 0;
+        while (true) {
+            if (best == NONE) {
+                // Dead end, nothing in the cache has triangles left. Restart from the
+                // first triangle not drawn yet rather than searching for the best score.
+                while (cursor < n_triangles && emitted[cursor]) cursor++;
+                if (cursor == n_triangles) break;
+                best = static_cast<unsigned int>(cursor);
+            }
+
+            const unsigned int* triangle = &indices[best * 3];
+            output.insert(output.end(), triangle, triangle + 3);
+            emitted[best] = true;
+
+            next_cache.clear();
+            for (int k = 0; k < 3; k++) {
+                const unsigned int v = triangle[k];
+                // Drop the triangle from the vertex's live range
+                unsigned int* begin = &adjacency[offsets[v]];
+                unsigned int* end = begin + live[v];
+                unsigned int* found = std::find(begin, end, best);
+                if (found != end) {
+                    std::swap(*found, *(end - 1));
+                    live[v]--;
+                }
+                if (std::find(next_cache.begin(), next_cache.end(), v) == next_cache.end()) next_cache.push_back(v);
+            }
+            for (const unsigned int v: cache) {
+                if (std::find(next_cache.begin(), next_cache.end(), v) == next_cache.end()) next_cache.push_back(v);
+            }
+
+            // Rescore everything that moved, including vertices pushed out of the cache
+            for (size_t i = 0; i < next_cache.size(); i++) {
+                const unsigned int v = next_cache[i];
+                cache_position[v] = i < SCORE_CACHE_SIZE ? static_cast<int>(i) : -1;
+                const float score = vertex_score(cache_position[v], live[v]);
+                const float delta = score - vertex_scores[v];
+                vertex_scores[v] = score;
+                for (unsigned int a = offsets[v]; a < offsets[v] + live[v]; a++) {
+                    triangle_scores[adjacency[a]] += delta;
+                }
+            }
+            if (next_cache.size() > SCORE_CACHE_SIZE) next_cache.resize(SCORE_CACHE_SIZE);
+            std::swap(cache, next_cache);
+
+            // Only triangles touching the cache gained score, so the best is among them
+            best = NONE;
+            float best_score = -std::numeric_limits<float>::max();
+            for (const unsigned int v: cache) {
+                for (unsigned int a = offsets[v]; a < offsets[v] + live[v]; a++) {
+                    const unsigned int t = adjacency[a];
+                    if (triangle_scores[t] > best_score) {
+                        best_score = triangle_scores[t];
+                        best = t;
+                    }
+                }
+            }
+        }
+
+        std::memcpy(indices, output.data(), output.size() * sizeof(unsigned int));
+    }
+
+    void optimize_overdraw(unsigned int* indices, size_t n_indices, const float* vertices, size_t n_vertices,
+                           size_t stride, float threshold) {
+        const size_t n_triangles = n_indices / 3;
+        if (n_triangles < 2) return;
+
+        // Hard boundaries, where the cache order starts over with all three vertices missing.
+        // Reordering whole runs between them costs nothing in cache efficiency.
+        std::vector<size_t> hard;
+        FifoCache cache(n_vertices, CACHE_SIZE);
+        for (size_t t = 0; t < n_triangles; t++) {
+            if (cache.triangle_misses(&indices[t * 3]) == 3) hard.push_back(t);
+        }
+        hard.push_back(n_triangles);
+
+        // Soft boundaries split those runs further, wherever a prefix on its own (with a
+        // cold cache) is already within `threshold` of the run's ACMR
+        std::vector<size_t> clusters;
+        for (size_t h = 0; h + 1 < hard.size(); h++) {
+            const size_t begin = hard[h], end = hard[h + 1];
+            cache.flush();
+            size_t run_misses = 0;
+            for (size_t t = begin; t < end; t++) run_misses += cache.triangle_misses(&indices[t * 3]);
+            const float run_acmr = static_cast<float>(run_misses) / static_cast<float>(end - begin);
+
+            cache.flush();
+            size_t start = begin, misses = 0;
+            clusters.push_back(begin);
+            for (size_t t = begin; t < end; t++) {
+                misses += cache.triangle_misses(&indices[t * 3]);
+                const float acmr = static_cast<float>(misses) / static_cast<float>(t + 1 - start);
+                if (t + 1 < end && acmr <= run_acmr * threshold) {
+                    start = t + 1;
+                    misses = 0;
+                    clusters.push_back(start);
+                    cache.flush();
+                }
+            }
+        }
+        clusters.push_back(n_triangles);
+        const size_t n_clusters = clusters.size() - 1;
+
+        // Area weighted centroid and normal per cluster
+        auto position = [vertices, stride](unsigned int v) {
+            return glm::vec3(vertices[v * stride], vertices[v * stride + 1], vertices[v * stride + 2]);
+        };
+        std::vector<glm::vec3> centroids(n_clusters), normals(n_clusters);
+        glm::vec3 mesh_centroid(0.0f);
+        float mesh_area = 0.0f;
+        for (size_t cluster = 0; cluster < n_clusters; cluster++) {
+            glm::vec3 centroid(0.0f), normal(0.0f);
+            float area = 0.0f;
+            for (size_t t = clusters[cluster]; t < clusters[cluster + 1]; t++) {
+                const glm::vec3 a = position(indices[t * 3]);
+                const glm::vec3 b = position(indices[t * 3 + 1]);
+                const glm::vec3 c = position(indices[t * 3 + 2]);
+                const glm::vec3 cross = glm::cross(b - a, c - a);
+                const float triangle_area = glm::length(cross);
+                centroid += (a + b + c) * (triangle_area / 3.0f);
+                normal += cross;
+                area += triangle_area;
+            }
+            mesh_centroid += centroid;
+            mesh_area += area;
+            centroids[cluster] = area > 0.0f ? centroid / area : centroid;
+            normals[cluster] = normal;
+        }
+        if (mesh_area > 0.0f) mesh_centroid = mesh_centroid / mesh_area;
+
+        // Clusters facing away from the middle of the mesh are the likely occluders
+        std::vector<float> keys(n_clusters);
+        for (size_t cluster = 0; cluster < n_clusters; cluster++) {
+            const float length = glm::length(normals[cluster]);
+            keys[cluster] = length > 0.0f
+                                ? glm::dot(centroids[cluster] - mesh_centroid, normals[cluster] / length)
+                                : 0.0f;
+        }
+        std::vector<size_t> order(n_clusters);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+        std::vector<unsigned int> output;
+        output.reserve(n_triangles * 3);
+        for (const size_t cluster: order) {
+            output.insert(output.end(), indices + clusters[cluster] * 3, indices + clusters[cluster + 1] * 3);
+        }
+        std::memcpy(indices, output.data(), output.size() * sizeof(unsigned int));
+    }
+
+    void optimize_vertex_fetch(std::vector<float>& vertices, size_t stride, unsigned int* indices, size_t n_indices) {
+        const size_t n_vertices = vertices.size() / stride;
+        std::vector<unsigned int> remap(n_vertices, NONE);
+        unsigned int next = 0;
+        for (size_t i = 0; i < n_indices; i++) {
+            unsigned int& index = indices[i];
+            if (remap[index] == NONE) remap[index] = next++;
+            index = remap[index];
+        }
+
+        std::vector<float> reordered(static_cast<size_t>(next) * stride);
+        for (size_t v = 0; v < n_vertices; v++) {
+            if (remap[v] == NONE) continue;
+            std::memcpy(&reordered[remap[v] * stride], &vertices[v * stride], stride * sizeof(float));
+        }
+        vertices.swap(reordered);
+    }
+
+    Report optimize(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+        constexpr size_t STRIDE = 8;
+        Report report;
+        report.before = analyze_vertex_cache(indices.data(), indices.size(), vertices.size() / STRIDE);
+
+        optimize_vertex_cache(indices.data(), indices.size(), vertices.size() / STRIDE);
+        optimize_overdraw(indices.data(), indices.size(), vertices.data(), vertices.size() / STRIDE, STRIDE);
+        optimize_vertex_fetch(vertices, STRIDE, indices.data(), indices.size());
+
+        report.after = analyze_vertex_cache(indices.data(), indices.size(), vertices.size() / STRIDE);
+        return report;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Import-time reordering of indexed triangle lists for the GPU. None of the passes change
+// what is drawn, only the order it's drawn in:
+//   vertex cache: triangles reordered so they reuse recently transformed vertices
+//                 (Forsyth's linear-speed vertex cache optimization)
+//   overdraw:     runs of the cache order that start with a cold cache are sorted so
+//                 outward facing ones draw first and occlude the rest
+//   vertex fetch: vertices reordered by first use, so fetches walk the buffer forwards
+namespace MeshOptimizer {
+    // Post-transform cache entries assumed by the analysis, a conservative FIFO size
+    constexpr unsigned int CACHE_SIZE = 16;
+
+    struct CacheStats {
+        float acmr = 0.0f;  // Average cache miss ratio, vertices transformed per triangle (0.5 - 3)
+        float atvr = 0.0f;  // Average transformed to vertex ratio, vertices transformed per vertex (1+)
+    };
+
+    struct Report {
+        CacheStats before;
+        CacheStats after;
+    };
+
+    // Simulates a FIFO cache of `cache_size` entries over the index list
+    CacheStats analyze_vertex_cache(const unsigned int* indices, size_t n_indices, size_t n_vertices,
+                                    unsigned int cache_size = CACHE_SIZE);
+
+    void optimize_vertex_cache(unsigned int* indices, size_t n_indices, size_t n_vertices);
+
+    // `indices` should already be in vertex cache order, clusters whose ACMR is within
+    // `threshold` of the cache order's are split out to sort. `vertices` holds
+    // `stride` floats per vertex, starting with the position.
+    void optimize_overdraw(unsigned int* indices, size_t n_indices, const float* vertices, size_t n_vertices,
+                           size_t stride, float threshold = 1.05f);
+
+    // Rewrites `vertices` in first use order, dropping unreferenced ones, and remaps
+    // `indices` to match
+    void optimize_vertex_fetch(std::vector<float>& vertices, size_t stride, unsigned int* indices, size_t n_indices);
+
+    // All three passes in order over Pos vec3; Norm vec3; UV vec2 vertices
+    Report optimize(std::vector<float>& vertices, std::vector<unsigned int>& indices);
+}
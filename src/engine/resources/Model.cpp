@@ -4,19 +4,53 @@
 
 #include "Model.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
+#include <assimp/MemoryIOWrapper.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
 #include "engine/resources/ResourceManager.hpp"
+#include "engine/renderer/Backend.hpp"
+#include "engine/math/Simd.hpp"
+#include "engine/utilities/AssetArchive.hpp"
+#include "engine/utilities/JobSystem.hpp"
 
 namespace Model {
+    // Serves files from the mounted asset archive to assimp, including the ones a model
+    // refers to (glTF buffers, OBJ materials), and everything else from disk
+    class ArchiveIOSystem : public Assimp::DefaultIOSystem {
+    public:
+        bool Exists(const char* path) const override {
+            return AssetArchive::find_mounted(path).has_value() || DefaultIOSystem::Exists(path);
+        }
+
+        Assimp::IOStream* Open(const char* path, const char* mode) override {
+            if (const auto packed = AssetArchive::find_mounted(path)) {
+                return new Assimp::MemoryIOStream(packed->data(), packed->size());
+            }
+            return DefaultIOSystem::Open(path, mode);
+        }
+    };
+
+    static Vector3 ambient_from_diffuse(const Vector3& diffuse) {
+        float target = 0.4;
+        float blend = 0.4f;
+        return Vector3(diffuse.x + (target - diffuse.x) * blend,
+                       diffuse.y + (target - diffuse.y) * blend,
+                       diffuse.z + (target - diffuse.z) * blend);
+    }
+
     Material::Material(aiMaterial* ai_material) {
         if (ai_material->GetTextureCount(aiTextureType_DIFFUSE)) {
             aiString texture_path;
             ai_material->GetTexture(aiTextureType_DIFFUSE, 0, &texture_path);
             std::filesystem::path path = texture_path.C_Str();
-            texture_ = Managers::texture_manager().get(path.filename());
+            texture_name_ = path.filename().string();
         }
 
         // TODO Blender uses PBR, not Phong lighting
@@ -36,11 +70,7 @@ namespace Model {
         diffuse_.y = diffuse.g;
         diffuse_.z = diffuse.b;
 
-        float target = 0.4;
-        float blend = 0.4f;
-        ambient_.x = diffuse.r + (target - diffuse.r) * blend;
-        ambient_.y = diffuse.g + (target - diffuse.g) * blend;
-        ambient_.z = diffuse.b + (target - diffuse.b) * blend;
+        ambient_ = ambient_from_diffuse(diffuse_);
 
         specular_ = Vector3(1.0);
 
@@ -51,24 +81,98 @@ namespace Model {
         shininess_ = shininess;
     }
 
+    Material::Material(const Vector3& base_color, float shininess, std::string texture_name)
+        : texture_name_(std::move(texture_name)),
+          ambient_(ambient_from_diffuse(base_color)),
+          diffuse_(base_color),
+          specular_(1.0),
+          shininess_(shininess) {
+    }
 
-    Node* create_node_tree(aiNode* ai_node) {
-        std::vector<unsigned int> mesh_indices;
-        mesh_indices.reserve(ai_node->mNumMeshes);
-        for (unsigned int n_mesh = 0; n_mesh < ai_node->mNumMeshes; n_mesh++) {
-            mesh_indices.push_back(ai_node->mMeshes[n_mesh]);
-        }
-        Node* new_node = new Node(mesh_indices, ai_node->mTransformation);
-        if (ai_node->mNumChildren) {
-            for (unsigned int n_child = 0; n_child < ai_node->mNumChildren; n_child++) {
-                new_node->add_child(create_node_tree(ai_node->mChildren[n_child]));
+    void Material::load_texture(bool async) {
+        if (texture_name_.empty()) return;
+        texture_ = async
+                       ? Managers::texture_manager().get_async(texture_name_)
+                       : Managers::texture_manager().get(texture_name_);
+    }
+
+
+    // Composes transforms on the way down, so each instance ends up in model space
+    void flatten_node_tree(const aiNode* ai_node, const Transform& parent_transform,
+                           std::vector<MeshInstance>& out) {
+        const Transform transform = parent_transform * Transform(ai_node->mTransformation);
+        if (ai_node->mNumMeshes) {
+            const glm::mat4 model_space = transform.to_glm();
+            for (unsigned int n_mesh = 0; n_mesh < ai_node->mNumMeshes; n_mesh++) {
+                out.push_back({ai_node->mMeshes[n_mesh], model_space});
             }
         }
-        return new_node;
+        for (unsigned int n_child = 0; n_child < ai_node->mNumChildren; n_child++) {
+            flatten_node_tree(ai_node->mChildren[n_child], transform, out);
+        }
     }
 
     Model::Model(const std::string& model_path) {
+        import(model_path);
+        upload(false);
+    }
+
+    void Model::import(const std::string& model_path) {
+        const auto extension = std::filesystem::path(model_path).extension();
+        if (extension == ".mesh") {
+            import_mesh_file(model_path);
+            return;
+        }
+        if (extension != ".gltf" || !import_gltf(model_path)) {
+            import_assimp(model_path);
+        }
+
+        // Meshes are independent, one job each. Only `gl_init()` is left for the GL thread.
+        optimization_report_.resize(meshes_.size());
+        std::vector<Bounds> mesh_bounds(meshes_.size());
+        JobSystem::instance().parallel_for(meshes_.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                optimization_report_[i] = meshes_[i].optimize();
+                mesh_bounds[i] = meshes_[i].compute_bounds();
+                meshes_[i].set_bounding_sphere(mesh_bounds[i]);
+            }
+        });
+        compute_bounds(mesh_bounds);
+    }
+
+    // Pos vec3; Norm vec3; UV vec2 per vertex from assimp's separate arrays. Each attribute
+    // is copied with one four float load and store, the store spilling into the next
+    // attribute or vertex, which is written afterwards. The last vertex would spill past
+    // the end, so it's copied per float.
+    static void interleave(const aiMesh* ai_mesh, float* out) {
+        static_assert(sizeof(aiVector3D) == 3 * sizeof(float), "Assimp built with double precision");
+        const size_t n_vertices = ai_mesh->mNumVertices;
+        if (n_vertices == 0) return;
+        const float* positions = &ai_mesh->mVertices[0].x;
+        const float* normals = ai_mesh->mNormals ? &ai_mesh->mNormals[0].x : nullptr;
+        const float* uvs = ai_mesh->mTextureCoords[0] ? &ai_mesh->mTextureCoords[0][0].x : nullptr;
+
+        const Math::Float4 zero = Math::Float4::broadcast(0.0f);
+        for (size_t v = 0; v + 1 < n_vertices; v++) {
+            float* vertex = out + v * 8;
+            Math::Float4::load(positions + v * 3).store(vertex);
+            (normals ? Math::Float4::load(normals + v * 3) : zero).store(vertex + 3);
+            (uvs ? Math::Float4::load(uvs + v * 3) : zero).store(vertex + 6);
+        }
+
+        const size_t last = n_vertices - 1;
+        float* vertex = out + last * 8;
+        for (int axis = 0; axis < 3; axis++) {
+            vertex[axis] = positions[last * 3 + axis];
+            vertex[3 + axis] = normals ? normals[last * 3 + axis] : 0.0f;
+        }
+        vertex[6] = uvs ? uvs[last * 3] : 0.0f;
+        vertex[7] = uvs ? uvs[last * 3 + 1] : 0.0f;
+    }
+
+    void Model::import_assimp(const std::string& model_path) {
         Assimp::Importer importer;
+        if (AssetArchive::mounted()) importer.SetIOHandler(new ArchiveIOSystem());
 
         const aiScene* scene = importer.ReadFile(model_path,
                                                  aiProcess_CalcTangentSpace |
@@ -88,153 +192,229 @@ namespace Model {
             materials_.emplace_back(scene->mMaterials[i]);
         }
 
-        // Load meshes
-        for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
-            std::vector<float> mesh_data;
-            mesh_data.reserve(scene->mMeshes[i]->mNumVertices * 8);
+        // One job per mesh into pre-sized buffers, moved into the meshes afterwards
+        const size_t n_meshes = scene->mNumMeshes;
+        std::vector<std::vector<float>> vertex_data(n_meshes);
+        std::vector<std::vector<unsigned int>> index_data(n_meshes);
+        JobSystem::instance().parallel_for(n_meshes, 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                const aiMesh* ai_mesh = scene->mMeshes[i];
+                vertex_data[i].resize(static_cast<size_t>(ai_mesh->mNumVertices) * 8);
+                interleave(ai_mesh, vertex_data[i].data());
+
+                size_t n_indices = 0;
+                for (unsigned int f = 0; f < ai_mesh->mNumFaces; f++) n_indices += ai_mesh->mFaces[f].mNumIndices;
+                index_data[i].resize(n_indices);
+                unsigned int* out = index_data[i].data();
+                for (unsigned int f = 0; f < ai_mesh->mNumFaces; f++) {
+                    const aiFace& face = ai_mesh->mFaces[f];
+                    out = std::copy(face.mIndices, face.mIndices + face.mNumIndices, out);
+                }
+            }
+        });
 
-            for (unsigned int i_v = 0; i_v < scene->mMeshes[i]->mNumVertices; i_v++) {
-                mesh_data.push_back(scene->mMeshes[i]->mVertices[i_v].x);
-                mesh_data.push_back(scene->mMeshes[i]->mVertices[i_v].y);
-                mesh_data.push_back(scene->mMeshes[i]->mVertices[i_v].z);
+        meshes_.reserve(n_meshes);
+        for (size_t i = 0; i < n_meshes; i++) {
+            meshes_.emplace_back(std::move(vertex_data[i]), std::move(index_data[i]),
+                                 scene->mMeshes[i]->mMaterialIndex);
+        }
 
-                mesh_data.push_back(scene->mMeshes[i]->mNormals[i_v].x);
-                mesh_data.push_back(scene->mMeshes[i]->mNormals[i_v].y);
-                mesh_data.push_back(scene->mMeshes[i]->mNormals[i_v].z);
+        // Flatten the node hierarchy into mesh instances
+        if (scene->mRootNode) {
+            flatten_node_tree(scene->mRootNode, Transform(), instances_);
+        }
+    }
 
-                if (scene->mMeshes[i]->mTextureCoords[0]) {
-                    mesh_data.push_back(scene->mMeshes[i]->mTextureCoords[0][i_v].x);
-                    mesh_data.push_back(scene->mMeshes[i]->mTextureCoords[0][i_v].y);
-                } else {
-                    mesh_data.push_back(0.0f);
-                    mesh_data.push_back(0.0f);
-                }
+    void Model::compute_bounds(const std::vector<Bounds>& mesh_bounds_list) {
+        // Box of the transformed mesh boxes, looser than transforming every vertex but cheap
+        for (const auto& instance: instances_) {
+            const Bounds& mesh_bounds = mesh_bounds_list[instance.mesh_index];
+            if (mesh_bounds.min.x > mesh_bounds.max.x) continue;
+            for (int corner = 0; corner < 8; corner++) {
+                const glm::vec4 point(corner & 1 ? mesh_bounds.max.x : mesh_bounds.min.x,
+                                      corner & 2 ? mesh_bounds.max.y : mesh_bounds.min.y,
+                                      corner & 4 ? mesh_bounds.max.z : mesh_bounds.min.z, 1.0f);
+                bounds_.extend(glm::vec3(instance.transform * point));
             }
-            std::vector<unsigned int> index_data;
+        }
+    }
 
-            for (unsigned int i_i = 0; i_i < scene->mMeshes[i]->mNumFaces; i_i++) {
-                for (unsigned int n_face = 0; n_face < scene->mMeshes[i]->mFaces[i_i].mNumIndices; n_face++) {
-                    index_data.push_back(scene->mMeshes[i]->mFaces[i_i].mIndices[n_face]);
-                }
-            }
+    void Model::request_textures() {
+        for (auto& material: materials_) {
+            material.load_texture(true);
+        }
+    }
 
-            meshes_.emplace_back(mesh_data, index_data, scene->mMeshes[i]->mMaterialIndex);
+    void Model::upload(bool async_textures) {
+        for (auto& mesh: meshes_) {
+            mesh.gl_init();
         }
+        for (auto& material: materials_) {
+            material.load_texture(async_textures);
+        }
+    }
 
-        // Load nodes
-        root_node_ = create_node_tree(scene->mRootNode);
+    size_t Model::get_upload_size() const {
+        size_t bytes = 0;
+        for (const auto& mesh: meshes_) {
+            bytes += mesh.get_upload_size();
+        }
+        return bytes;
     }
 
-    void Model::render(const Transform& model_transform, const Shader& shader_ref) const {
-        if (root_node_) {
-            root_node_->render(model_transform, meshes_, materials_, shader_ref);
+    MemoryUsage Model::get_memory_usage() const {
+        MemoryUsage usage;
+        for (const auto& mesh: meshes_) {
+            usage += mesh.get_memory_usage();
+        }
+        for (const auto& mapping: mappings_) {
+            usage.cpu_bytes += mapping->size();
         }
+        return usage;
     }
 
-    void Node::render(const Transform& parent_transform, const std::vector<Mesh>& mesh_ref,
-                      const std::vector<Material>& mat_ref, const Shader& shader_ref) const {
-        Transform this_trans = parent_transform * transform_;
+    void Model::render(const Transform& model_transform, const Shader& shader_ref) const {
+        const glm::mat4 object = model_transform.to_glm();
+        for (const auto& instance: instances_) {
+            const Mesh& mesh = meshes_[instance.mesh_index];
+            shader_ref.set_mat4("model", object * instance.transform * mesh.get_dequantize());
+            mesh.draw();
+        }
+    }
 
-        shader_ref.set_mat4("model", this_trans.to_glm());
+    void Model::record(const Transform& model_transform, const Shader& shader_ref,
+                       Renderer::CommandBuffer& out) const {
+        const glm::mat4 object = model_transform.to_glm();
+        for (const auto& instance: instances_) {
+            const Mesh& this_mesh = meshes_[instance.mesh_index];
+            const Material& this_mat = materials_[this_mesh.get_material_index()];
+
+            Renderer::DrawCommand& command = out.emplace_back();
+            command.shader = &shader_ref;
+            command.mesh = &this_mesh;
+            command.material = &this_mat;
+            command.model = object * instance.transform;
+            command.sort_key = Renderer::DrawCommand::make_sort_key(
+                shader_ref.id,
+                this_mat.has_texture() ? this_mat.get_texture()->id : 0,
+                this_mesh.get_vao(),
+                this_mesh.get_allocation()
+            );
+        }
+    }
 
-        for (auto mesh_index: mesh_indices_) {
-            const Mesh& this_mesh = mesh_ref[mesh_index];
-            const Material& this_mat = mat_ref[this_mesh.get_material_index()];
-            if (this_mat.has_texture()) {
-                shader_ref.set_bool("useTexture", true);
-                shader_ref.set_int("albedoTex", 0);
-                this_mat.get_texture()->bind(0);
-            } else {
-                shader_ref.set_bool("useTexture", false);
-            }
-            shader_ref.set_vec3("material_ambient", this_mat.get_ambient().to_glm());
-            shader_ref.set_vec3("material_diffuse", this_mat.get_diffuse().to_glm());
-            shader_ref.set_vec3("material_specular", this_mat.get_specular().to_glm());
-            shader_ref.set_float("material_shininess", this_mat.get_shininess());
-            this_mesh.draw();
+    Bounds Mesh::compute_bounds() const {
+        Bounds bounds;
+        for (size_t i = 0; i + 8 <= vertex_view_.size(); i += 8) {
+            bounds.extend(glm::vec3(vertex_view_[i], vertex_view_[i + 1], vertex_view_[i + 2]));
         }
+        return bounds;
+    }
 
-        for (auto child: children_) {
-            child->render(this_trans, mesh_ref, mat_ref, shader_ref);
+    void Mesh::set_bounding_sphere(const Bounds& bounds) {
+        if (bounds.min.x > bounds.max.x) return;
+        const glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+        bounding_sphere_ = glm::vec4(center, glm::length(bounds.max - center));
+    }
+
+    MeshOptimizer::Report Mesh::optimize() {
+        assert(allocation_ == Renderer::GeometryPool::INVALID_ALLOCATION);
+        if (vertex_view_.data() != mesh_data.data()) {
+            mesh_data.assign(vertex_view_.begin(), vertex_view_.end());
+        }
+        if (index_view_.data() != indices.data()) {
+            indices.assign(index_view_.begin(), index_view_.end());
         }
+
+        const MeshOptimizer::Report report = MeshOptimizer::optimize(mesh_data, indices);
+        vertex_view_ = Span<float>(mesh_data);
+        index_view_ = Span<unsigned int>(indices);
+        index_count_ = indices.size();
+        return report;
     }
 
     Mesh::~Mesh() noexcept {
-        glDeleteBuffers(1, &VBO);
-        glDeleteBuffers(1, &EBO);
-        glDeleteVertexArrays(1, &VAO);
+        if (allocation_ != Renderer::GeometryPool::INVALID_ALLOCATION) {
+            pool_->free(allocation_);
+        }
     }
 
-    void Mesh::gl_init() {
-        // VAO setup
-        glGenVertexArrays(1, &VAO);
-        glBindVertexArray(VAO);
-
-        // VBO/EBO setup
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(
-            GL_ARRAY_BUFFER,
-            mesh_data.size() * sizeof(float),
-            mesh_data.data(),
-            GL_STATIC_DRAW
-        );
+    // Half floats keep 11 bits, past this tiled UVs visibly lose precision
+    static constexpr float MAX_HALF_UV = 8.0f;
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(
-            GL_ELEMENT_ARRAY_BUFFER,
-            index_count_ * sizeof(unsigned int),
-            indices.data(),
-            GL_STATIC_DRAW
-        );
+    // The layouts `gl_init()` uploads in, picked from the data
+    static Renderer::VertexFormat choose_vertex_format(Span<float> vertices) {
+        using Renderer::VertexFormat;
+        if (Renderer::preferred_vertex_format() == VertexFormat::POSITION_NORMAL_UV) {
+            return VertexFormat::POSITION_NORMAL_UV;
+        }
+        for (size_t i = 6; i < vertices.size(); i += 8) {
+            if (std::fabs(vertices[i]) > MAX_HALF_UV || std::fabs(vertices[i + 1]) > MAX_HALF_UV) {
+                return VertexFormat::POSITION_NORMAL_UV;
+            }
+        }
+        return VertexFormat::QUANTIZED;
+    }
 
-        // Position attribute
-        glVertexAttribPointer(
-            0,
-            3,
-            GL_FLOAT,
-            GL_FALSE,
-            8 * sizeof(float),
-            (void*) 0  // Starting at index 0
-        );
-        glEnableVertexAttribArray(0);
-
-        // Normal attribute
-        glVertexAttribPointer(
-            1,
-            3,
-            GL_FLOAT,
-            GL_FALSE,
-            8 * sizeof(float),
-            (void*) (3 * sizeof(float))  // offset by 3 preceding pos floats
-        );
-        glEnableVertexAttribArray(1);
-
-        // UV attribute
-        glVertexAttribPointer(
-            2,
-            2,
-            GL_FLOAT,
-            GL_FALSE,
-            8 * sizeof(float),
-            (void*) (6 * sizeof(float))
-        );
-        glEnableVertexAttribArray(2);
+    static Renderer::IndexType choose_index_type(size_t n_vertices) {
+        return n_vertices <= 0x10000 ? Renderer::IndexType::UINT16 : Renderer::IndexType::UINT32;
+    }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);  // unset VAO
+    size_t Mesh::get_upload_size() const {
+        const size_t n_vertices = vertex_view_.size() / 8;
+        return n_vertices * Renderer::vertex_stride(choose_vertex_format(vertex_view_)) +
+               index_count_ * Renderer::index_size(choose_index_type(n_vertices));
+    }
+
+    MemoryUsage Mesh::get_memory_usage() const {
+        MemoryUsage usage;
+        usage.cpu_bytes = mesh_data.capacity() * sizeof(float) + indices.capacity() * sizeof(unsigned int);
+        if (allocation_ != Renderer::GeometryPool::INVALID_ALLOCATION) usage.gpu_bytes = get_upload_size();
+        return usage;
+    }
+
+    void Mesh::gl_init() {
+        if (!Renderer::uses_gl() || index_count_ == 0) return;
+
+        // Set at import, except for compiled files
+        if (bounding_sphere_.w == 0.0f) set_bounding_sphere(compute_bounds());
+
+        const size_t n_vertices = vertex_view_.size() / 8;
+        const Renderer::VertexFormat format = choose_vertex_format(vertex_view_);
+        const Renderer::IndexType index_type = choose_index_type(n_vertices);
+        pool_ = &Renderer::GeometryPool::instance(format, index_type);
+
+        // The float layout and 32-bit indices upload straight from the views
+        std::vector<unsigned char> packed;
+        const void* vertex_data = vertex_view_.data();
+        if (format != Renderer::VertexFormat::POSITION_NORMAL_UV) {
+            packed = Renderer::pack_vertices(format, vertex_view_.data(), n_vertices, dequantize_);
+            vertex_data = packed.data();
+        }
+        std::vector<uint16_t> short_indices;
+        const void* index_data = index_view_.data();
+        if (index_type == Renderer::IndexType::UINT16) {
+            short_indices.assign(index_view_.begin(), index_view_.end());
+            index_data = short_indices.data();
+        }
+
+        allocation_ = pool_->allocate(vertex_data, n_vertices, index_data, index_count_);
     }
 
     void Mesh::draw() const {
-        glBindVertexArray(VAO);
-        glDrawElements(
-            GL_TRIANGLES,
-            index_count_,
-            GL_UNSIGNED_INT,
-            0
-        );
+        if (allocation_ == Renderer::GeometryPool::INVALID_ALLOCATION) return;
+        glBindVertexArray(get_vao());
+        draw_range();
         glBindVertexArray(0);
     }
+
+    void Mesh::draw_range() const {
+        if (allocation_ == Renderer::GeometryPool::INVALID_ALLOCATION) return;
+        pool_->draw(allocation_);
+    }
+
+    void Mesh::draw_instances(GLsizei count) const {
+        if (allocation_ == Renderer::GeometryPool::INVALID_ALLOCATION) return;
+        pool_->draw(allocation_, count);
+    }
 }
@@ -6,19 +6,29 @@
 
 #include <vector>
 #include <string>
+#include <limits>
+#include <memory>
 
-#include <OpenGL/gl3.h>
+#include "engine/renderer/GL.hpp"
 #include <assimp/material.h>
 
+#include "engine/resources/AsyncResource.hpp"
+#include "engine/resources/MemoryUsage.hpp"
+#include "engine/resources/MeshOptimizer.hpp"
 #include "engine/resources/Shader.hpp"
 #include "engine/resources/Texture.hpp"
 #include "engine/math/Vector.hpp"
 #include "engine/math/Transform.hpp"
+#include "engine/renderer/RenderCommand.hpp"
+#include "engine/renderer/GeometryPool.hpp"
+#include "engine/utilities/MappedFile.hpp"
+#include "engine/utilities/Span.hpp"
 
 
 namespace Model {
     class Material {
     private:
+        std::string texture_name_;
         std::shared_ptr<Texture> texture_;
         Vector3 ambient_;
         Vector3 diffuse_;
@@ -28,6 +38,19 @@ namespace Model {
     public:
         explicit Material(aiMaterial* ai_material);
 
+        // Phong stand-in for a PBR material with the given base color, what
+        // `Material(aiMaterial*)` builds for the materials Blender exports
+        Material(const Vector3& base_color, float shininess, std::string texture_name);
+
+        Material(const Vector3& ambient, const Vector3& diffuse, const Vector3& specular, float shininess,
+                 std::string texture_name)
+            : texture_name_(std::move(texture_name)),
+              ambient_(ambient),
+              diffuse_(diffuse),
+              specular_(specular),
+              shininess_(shininess) {
+        }
+
         ~Material() noexcept = default;
 
         Material(const Material&) = delete;
@@ -38,8 +61,13 @@ namespace Model {
 
         Material& operator=(Material&& other) noexcept = default;
 
-        bool has_texture() const { return texture_ != nullptr; }
-        std::shared_ptr<Texture> get_texture() const { return texture_; }
+        // Requests the texture named by the material, if any. GL thread only.
+        void load_texture(bool async);
+
+        // False while the texture is still loading, the material is drawn untextured until then
+        bool has_texture() const { return texture_ != nullptr && texture_->is_ready(); }
+        const std::shared_ptr<Texture>& get_texture() const { return texture_; }
+        const std::string& get_texture_name() const { return texture_name_; }
 
         Vector3 get_ambient() const { return ambient_; }
         Vector3 get_diffuse() const { return diffuse_; }
@@ -47,32 +75,68 @@ namespace Model {
         float get_shininess() const { return shininess_; }
     };
 
+    // Axis aligned, empty until extended by a point
+    struct Bounds {
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+        void extend(const glm::vec3& point) {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+    };
+
     class Mesh {
     private:
-        GLuint VAO = 0;
-        GLuint VBO = 0;
-        GLuint EBO = 0;
-
-        // TODO I don't think we need to store this data after gl_init()
-        // but I'm keeping it in case I get to a point where we need to
-        // dynamically allocate and deallocate the GL buffers.
+        // Range in the shared geometry buffers, see `Renderer::GeometryPool`
+        Renderer::GeometryPool::AllocationId allocation_ = Renderer::GeometryPool::INVALID_ALLOCATION;
+        Renderer::GeometryPool* pool_ = nullptr;
+        // Maps the uploaded positions back to mesh space, identity unless quantized
+        glm::mat4 dequantize_{1.0f};
+        // Mesh space, center in xyz and radius in w
+        glm::vec4 bounding_sphere_{0.0f};
+
+        // Kept after gl_init(), the software rasterizer reads it directly
         std::vector<float> mesh_data = {};  // Interleaved data
         // Pos vec3; Norm vec3; UV vec2;
         std::vector<unsigned int> indices = {};
+        // Either the vectors above or a range of the mapped file the model was loaded from
+        Span<float> vertex_view_;
+        Span<unsigned int> index_view_;
         unsigned int material_index_ = -1;
         unsigned int index_count_;
 
         void gl_init();
 
+        void set_bounding_sphere(const Bounds& bounds);
+
         friend class Model;
 
     public:
         Mesh(std::vector<float> mesh_data, std::vector<unsigned int> index_data, unsigned int material_index)
             : mesh_data(std::move(mesh_data)),
               indices(std::move(index_data)),
+              vertex_view_(this->mesh_data),
+              index_view_(indices),
               material_index_(material_index),
               index_count_(indices.size()) {
-            gl_init();
+        }
+
+        // Owns the vertex data and borrows the indices, which have to outlive the mesh
+        Mesh(std::vector<float> mesh_data, Span<unsigned int> index_data, unsigned int material_index)
+            : mesh_data(std::move(mesh_data)),
+              vertex_view_(this->mesh_data),
+              index_view_(index_data),
+              material_index_(material_index),
+              index_count_(index_data.size()) {
+        }
+
+        // Borrows the data, which has to outlive the mesh
+        Mesh(Span<float> vertex_data, Span<unsigned int> index_data, unsigned int material_index)
+            : vertex_view_(vertex_data),
+              index_view_(index_data),
+              material_index_(material_index),
+              index_count_(index_data.size()) {
         }
 
         ~Mesh() noexcept;
@@ -83,98 +147,171 @@ namespace Model {
 
         // Implement move operations
         Mesh(Mesh&& other) noexcept
-            : VAO(other.VAO), VBO(other.VBO), EBO(other.EBO),
+            : allocation_(other.allocation_),
+              pool_(other.pool_),
+              dequantize_(other.dequantize_),
+              bounding_sphere_(other.bounding_sphere_),
               mesh_data(std::move(other.mesh_data)),
               indices(std::move(other.indices)),
+              vertex_view_(other.vertex_view_),
+              index_view_(other.index_view_),
               material_index_(other.material_index_),
               index_count_(other.index_count_) {
-            other.VAO = 0;
-            other.VBO = 0;
-            other.EBO = 0;
+            other.allocation_ = Renderer::GeometryPool::INVALID_ALLOCATION;
         }
 
         Mesh& operator=(Mesh&& other) noexcept {
             if (this != &other) {
-                // Delete current
-                glDeleteBuffers(1, &VBO);
-                glDeleteBuffers(1, &EBO);
-                glDeleteVertexArrays(1, &VAO);
+                // Release current
+                if (allocation_ != Renderer::GeometryPool::INVALID_ALLOCATION) {
+                    pool_->free(allocation_);
+                }
 
                 // Move from other
-                VAO = other.VAO;
-                VBO = other.VBO;
-                EBO = other.EBO;
+                allocation_ = other.allocation_;
+                pool_ = other.pool_;
+                dequantize_ = other.dequantize_;
+                bounding_sphere_ = other.bounding_sphere_;
                 mesh_data = std::move(other.mesh_data);
                 indices = std::move(other.indices);
+                vertex_view_ = other.vertex_view_;
+                index_view_ = other.index_view_;
                 material_index_ = other.material_index_;
                 index_count_ = other.index_count_;
 
                 // Void out other
-                other.VAO = 0;
-                other.VBO = 0;
-                other.EBO = 0;
+                other.allocation_ = Renderer::GeometryPool::INVALID_ALLOCATION;
             }
             return *this;
         }
 
         unsigned int get_material_index() const { return material_index_; }
 
-        void draw() const;
-    };
+        // Shared by every mesh in the same geometry arena, 0 if the mesh isn't on the GPU
+        GLuint get_vao() const {
+            if (allocation_ == Renderer::GeometryPool::INVALID_ALLOCATION) return 0;
+            return pool_->get_vao(allocation_);
+        }
 
-    class Node {
-    private:
-        std::vector<Node*> children_ = {};
-        std::vector<unsigned int> mesh_indices_ = {};
-        Transform transform_{};
+        Renderer::GeometryPool::AllocationId get_allocation() const { return allocation_; }
 
-    public:
-        Node(std::vector<unsigned int> mesh_indices,
-             const aiMatrix4x4& ai_transform)
-            : mesh_indices_(std::move(mesh_indices)),
-              transform_(ai_transform) {
-        };
+        // Applied before the model matrix to every vertex position read from `get_vao()`
+        const glm::mat4& get_dequantize() const { return dequantize_; }
 
-        ~Node() noexcept { for (auto child: children_) delete child; }
+        // Whether `get_vao()` holds octahedral-encoded normals for the shader to decode
+        bool has_octahedral_normals() const {
+            return pool_ != nullptr && pool_->get_format() == Renderer::VertexFormat::QUANTIZED;
+        }
 
-        Node(const Node&) = delete;
+        // Around the bounding box, set by `import()` or `gl_init()`. Picks streamed texture levels.
+        const glm::vec4& get_bounding_sphere() const { return bounding_sphere_; }
 
-        Node& operator=(const Node&) = delete;
+        // Bytes `gl_init()` sends to the GPU
+        size_t get_upload_size() const;
 
-        Node(Node&& other) = delete;
+        // Borrowed data is counted by the owner of the mapping
+        MemoryUsage get_memory_usage() const;
 
-        Node& operator=(Node&&) = delete;
+        // Pos vec3; Norm vec3; UV vec2 per vertex
+        Span<float> get_vertex_data() const { return vertex_view_; }
+        Span<unsigned int> get_indices() const { return index_view_; }
 
-        void add_child(Node* child) { children_.push_back(child); }
+        // Mesh space, over every vertex
+        Bounds compute_bounds() const;
 
-        void render(const Transform& parent_transform,
-                    const std::vector<Mesh>& mesh_ref,
-                    const std::vector<Material>& mat_ref,
-                    const Shader& shader_ref) const;
+        // Reorders triangles and vertices for the GPU, see `MeshOptimizer`. Borrowed data is
+        // copied first. Must run before `gl_init()`.
+        MeshOptimizer::Report optimize();
+
+        // Binds the mesh's VAO and draws it
+        void draw() const;
+
+        // Draws without binding, for callers that already bound `get_vao()`
+        void draw_range() const;
+
+        // `draw_range()` for `count` instances, see `Renderer::RenderQueue`
+        void draw_instances(GLsizei count) const;
+    };
+
+    // One mesh placement from the imported node hierarchy. The hierarchy is flattened at
+    // import, node transforms never change afterwards.
+    struct MeshInstance {
+        unsigned int mesh_index = 0;
+        glm::mat4 transform{1.0f};  // Model space, the node's transform composed with its ancestors'
     };
 
-    class Model {
+    class Model : public AsyncResource {
     private:
         std::vector<Mesh> meshes_;
         std::vector<Material> materials_;
-        Node* root_node_ = nullptr;
+        std::vector<MeshInstance> instances_;
+        Bounds bounds_;
+        // Back the meshes' borrowed data, the compiled .mesh file or the glTF buffers
+        std::vector<std::unique_ptr<MappedFile>> mappings_;
+        // One per mesh, empty for compiled .mesh files, which were optimized when compiled
+        std::vector<MeshOptimizer::Report> optimization_report_;
+
+        void import_assimp(const std::string& model_path);
+
+        void import_mesh_file(const std::string& mesh_path);
+
+        // Fast path for plain glTF 2.0 files, see GltfImport.cpp. Returns false without
+        // touching the model if the file uses something it doesn't handle.
+        bool import_gltf(const std::string& gltf_path);
+
+        // From the mesh instances and each mesh's bounds, for imports whose file doesn't store bounds
+        void compute_bounds(const std::vector<Bounds>& mesh_bounds);
 
     public:
         explicit Model(const std::string& model_path);
 
-        ~Model() noexcept { delete root_node_; }
+        // Empty and still loading, for `AsyncResource::load_in_background()`
+        Model() : AsyncResource(State::LOADING) {}
+
+        // CPU half of loading: parses the file and builds the vertex data, or maps it from a
+        // compiled .mesh file. glTF files go through a dedicated importer, anything it
+        // doesn't support and every other format through assimp, and the imported meshes
+        // are then reordered by `Mesh::optimize()`. Meshes are processed in parallel on the
+        // job system. Safe on any thread.
+        void import(const std::string& model_path);
+
+        // Starts loading the material textures in the background, so they load alongside
+        // the model's upload rather than after it. Any thread, once imported.
+        void request_textures();
+
+        // GL half of loading, GL thread only. With `async_textures`, textures are requested
+        // without waiting for them.
+        void upload(bool async_textures);
+
+        // Bytes `upload()` sends to the GPU
+        size_t get_upload_size() const;
+
+        // Meshes and mapped files. Material textures belong to the texture manager.
+        MemoryUsage get_memory_usage() const;
+
+        ~Model() noexcept = default;
 
         Model(const Model&) = delete;
 
         Model& operator=(const Model&) = delete;
 
-        Model(Model&& other) noexcept
-            : meshes_(std::move(other.meshes_)),
-              materials_(std::move(other.materials_)),
-              root_node_(other.root_node_) {
-            other.root_node_ = nullptr;
-        }
+        Model(Model&& other) noexcept = default;
+
+        const std::vector<Mesh>& get_meshes() const { return meshes_; }
+        const std::vector<Material>& get_materials() const { return materials_; }
+        const std::vector<MeshInstance>& get_instances() const { return instances_; }
+
+        // Vertex cache efficiency of each mesh before and after `import()` optimized it
+        const std::vector<MeshOptimizer::Report>& get_optimization_report() const { return optimization_report_; }
 
+        // Model space, over every mesh instance
+        const Bounds& get_bounds() const { return bounds_; }
+
+        // Sets the `model` uniform per mesh instance and draws it, for shaders outside the
+        // render queue such as the deferred light volumes
         void render(const Transform& model_transform, const Shader& shader_ref) const;
+
+        // Appends one draw command per mesh instance. Safe to call from worker threads.
+        void record(const Transform& model_transform, const Shader& shader_ref, Renderer::CommandBuffer& out) const;
     };
 }
@@ -0,0 +1,138 @@
+#include "engine/resources/Preloader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <set>
+#include <thread>
+
+#include "engine/renderer/UploadQueue.hpp"
+#include "engine/resources/ResourceManager.hpp"
+
+static void add_unique(std::vector<std::string>& names, const std::string& name) {
+    if (std::find(names.begin(), names.end(), name) == names.end()) names.push_back(name);
+}
+
+void AssetManifest::add_model(const std::string& name, const std::vector<std::string>& textures) {
+    add_unique(models, name);
+    if (textures.empty()) return;
+    std::vector<std::string>& edges = model_textures[name];
+    for (const auto& texture: textures) add_unique(edges, texture);
+}
+
+void AssetManifest::add_shader(const std::string& name) {
+    add_unique(shaders, name);
+}
+
+void AssetManifest::add_texture(const std::string& name) {
+    add_unique(textures, name);
+}
+
+void AssetManifest::merge(const AssetManifest& other) {
+    for (const auto& model: other.models) {
+        const auto edges = other.model_textures.find(model);
+        add_model(model, edges != other.model_textures.end() ? edges->second : std::vector<std::string>{});
+    }
+    for (const auto& shader: other.shaders) add_shader(shader);
+    for (const auto& texture: other.textures) add_texture(texture);
+}
+
+size_t Preloader::Report::failed_count() const {
+    return std::count_if(assets.begin(), assets.end(), [](const Timing& timing) { return timing.failed; });
+}
+
+void Preloader::Report::print() const {
+    static const char* const KIND_NAMES[] = {"model", "shader", "texture"};
+    printf("Preloaded %zu assets in %.1f ms\n", assets.size(), total_ms);
+    for (const auto& timing: assets) {
+        printf("  %-8s %-32s %8.1f ms", KIND_NAMES[static_cast<int>(timing.kind)], timing.name.c_str(), timing.ms);
+        if (!timing.model.empty()) printf("  for %s", timing.model.c_str());
+        printf(timing.failed ? "  FAILED\n" : "\n");
+    }
+}
+
+Preloader::Report Preloader::load(const AssetManifest& manifest) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    auto elapsed_ms = [start] {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    struct Pending {
+        Kind kind;
+        std::string name;
+        std::string model;
+        std::shared_ptr<Model::Model> as_model;
+        std::shared_ptr<Texture> as_texture;
+
+        const AsyncResource& resource() const {
+            if (as_model) return *as_model;
+            return *as_texture;
+        }
+    };
+
+    Report report;
+    std::vector<Pending> pending;
+    std::set<std::string> requested_textures;
+    auto request_texture = [&](const std::string& name, const std::string& model) {
+        if (!requested_textures.insert(name).second) return;
+        auto texture = Managers::texture_manager().get_async(name);
+        report.handles.push_back(texture);
+        pending.push_back({Kind::TEXTURE, name, model, nullptr, std::move(texture)});
+    };
+
+    // Everything the job system can read goes out first
+    for (const auto& name: manifest.models) {
+        auto model = Managers::model_manager().get_async(name);
+        report.handles.push_back(model);
+        pending.push_back({Kind::MODEL, name, "", std::move(model), nullptr});
+        const auto edges = manifest.model_textures.find(name);
+        if (edges == manifest.model_textures.end()) continue;
+        for (const auto& texture: edges->second) request_texture(texture, name);
+    }
+    for (const auto& name: manifest.textures) request_texture(name, "");
+
+    // Shaders need this thread, they compile while the rest reads
+    for (const auto& name: manifest.shaders) {
+        Timing timing{Kind::SHADER, name, "", 0.0, false};
+        try {
+            report.handles.push_back(Managers::shader_manager().get(name));
+        } catch (const std::exception& e) {
+            printf("ERROR — %s\n", e.what());
+            timing.failed = true;
+        }
+        timing.ms = elapsed_ms();
+        report.assets.push_back(std::move(timing));
+    }
+
+    while (!pending.empty()) {
+        // Nothing is drawn yet, so there's no frame to keep within budget
+        Renderer::UploadQueue::instance().process(std::numeric_limits<size_t>::max());
+
+        bool progressed = false;
+        for (size_t i = 0; i < pending.size();) {
+            const AsyncResource::State state = pending[i].resource().get_state();
+            if (state == AsyncResource::State::LOADING) {
+                i++;
+                continue;
+            }
+            Pending done = std::move(pending[i]);
+            pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(i));
+            progressed = true;
+
+            report.assets.push_back({done.kind, done.name, done.model, elapsed_ms(),
+                                     state == AsyncResource::State::FAILED});
+            // The model has requested its textures by now, waiting for them too
+            if (done.as_model && state == AsyncResource::State::READY) {
+                for (const auto& material: done.as_model->get_materials()) {
+                    if (!material.get_texture_name().empty()) request_texture(material.get_texture_name(), done.name);
+                }
+            }
+        }
+        if (!progressed) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    report.total_ms = elapsed_ms();
+    return report;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The models, shaders and textures something needs, with the textures each model is known
+// to use. Prefabs add theirs with `Scene::Prefab::collect()`, and a scene's manifest is
+// its prefabs' merged.
+struct AssetManifest {
+    std::vector<std::string> models;
+    std::vector<std::string> shaders;
+    std::vector<std::string> textures;  // Used on their own, not through a model
+    // Model to its textures. Optional, textures a model needs are also found when it loads,
+    // but listing them lets them load alongside the model instead of after it.
+    std::map<std::string, std::vector<std::string>> model_textures;
+
+    // Each ignores names already listed
+    void add_model(const std::string& name, const std::vector<std::string>& textures = {});
+
+    void add_shader(const std::string& name);
+
+    void add_texture(const std::string& name);
+
+    void merge(const AssetManifest& other);
+
+    bool empty() const { return models.empty() && shaders.empty() && textures.empty(); }
+};
+
+// Loads every asset of a manifest at once instead of one after another as objects ask for
+// them. Models and textures are all requested from the managers in the background first,
+// so the job system reads them concurrently, and shaders compile on the calling thread in
+// the meantime. `load()` then runs uploads until everything is loaded or failed, following
+// each model to the textures it turns out to use, and reports how long each asset took.
+class Preloader {
+public:
+    enum class Kind {
+        MODEL,
+        SHADER,
+        TEXTURE,
+    };
+
+    struct Timing {
+        Kind kind = Kind::MODEL;
+        std::string name;
+        std::string model;  // For textures, the model that needed it, empty if listed on its own
+        double ms = 0.0;    // From the start of the preload until loaded
+        bool failed = false;
+    };
+
+    struct Report {
+        std::vector<Timing> assets;  // In the order they finished
+        double total_ms = 0.0;
+        // Keeps everything loaded while the report is alive, until the objects using the
+        // assets have requested them
+        std::vector<std::shared_ptr<const void>> handles;
+
+        size_t failed_count() const;
+
+        void print() const;
+    };
+
+    // GL thread only, since it runs the uploads and compiles the shaders. Doesn't throw for
+    // assets that fail to load, they are reported as failed.
+    static Report load(const AssetManifest& manifest);
+};
@@ -7,39 +7,414 @@
 #include <unordered_map>
 #include <string>
 #include <filesystem>
+#include <array>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
+#include "engine/resources/MemoryUsage.hpp"
 #include "engine/resources/Shader.hpp"
 #include "engine/resources/Model.hpp"
 #include "engine/resources/Texture.hpp"
+#include "engine/renderer/UploadQueue.hpp"
+#include "engine/utilities/AssetArchive.hpp"
 
+// Resources that report their footprint through `get_memory_usage()`. Others count as 0
+// bytes, and so do resources still loading, which a worker may be writing meanwhile.
+template<class Resource, class = void>
+struct has_memory_usage : std::false_type {};
+
+template<class Resource>
+struct has_memory_usage<Resource, std::void_t<decltype(std::declval<const Resource&>().get_memory_usage())>>
+    : std::true_type {};
+
+template<class Resource>
+MemoryUsage memory_usage_of(const Resource& resource) {
+    if constexpr (has_memory_usage<Resource>::value) {
+        if constexpr (std::is_base_of_v<AsyncResource, Resource>) {
+            if (!resource.is_ready()) return {};
+        }
+        return resource.get_memory_usage();
+    } else {
+        return {};
+    }
+}
+
+// Last reference to a resource the manager let go of. GL resources are freed on the GL
+// thread through the upload queue, since handles can be dropped on any thread.
+template<class Resource>
+void dispose(std::shared_ptr<Resource> resource) {
+    if constexpr (std::is_base_of_v<AsyncResource, Resource>) {
+        if (resource) Renderer::UploadQueue::instance().push(0, [resource = std::move(resource)] {});
+    }
+}
+
+// Hands out shared resources by name and keeps recently released ones around. Callers get
+// handles to the loaded resource: once the last handle is gone, the resource moves into an
+// LRU retention cache instead of being freed, so releasing and requesting it again (an
+// object despawned and respawned) doesn't go back to disk. The least recently released
+// resources are freed once the retained ones take more than the retention budget.
+//
+// Safe to use from any thread. Names are spread over shards that each have a reader/writer
+// lock, so requests for loaded resources only take a shared lock and don't contend. Loads
+// are single-flight: the first request for a name loads it, and concurrent requests for the
+// same name wait for that load instead of starting their own.
 template<class Resource, class Loader>
 class ResourceManager {
+private:
+    // Shared with every handle's deleter, which may outlive the manager
+    class Retention {
+    private:
+        struct Entry {
+            std::string name;
+            std::shared_ptr<Resource> resource;
+        };
+
+        mutable std::mutex mutex_;
+        // Most recently released first
+        std::list<Entry> entries_;
+        std::unordered_map<std::string, typename std::list<Entry>::iterator> index_;
+        size_t budget_;
+
+        // Sizes are read here rather than on release, resources released while loading
+        // only count once they're ready
+        MemoryUsage usage_locked() const {
+            MemoryUsage usage;
+            for (const auto& entry: entries_) {
+                usage += memory_usage_of(*entry.resource);
+            }
+            return usage;
+        }
+
+        // Moves the least recently released resources to `evicted` until the rest fit the
+        // budget. They're freed by the caller once the lock is released.
+        void trim_locked(std::vector<std::shared_ptr<Resource>>& evicted) {
+            size_t bytes = usage_locked().total();
+            while (!entries_.empty() && bytes > budget_) {
+                bytes -= std::min(bytes, memory_usage_of(*entries_.back().resource).total());
+                evicted.push_back(std::move(entries_.back().resource));
+                index_.erase(entries_.back().name);
+                entries_.pop_back();
+            }
+        }
+
+        static void dispose_all(std::vector<std::shared_ptr<Resource>>& resources) {
+            for (auto& resource: resources) {
+                dispose(std::move(resource));
+            }
+        }
+
+    public:
+        explicit Retention(size_t budget) : budget_(budget) {}
+
+        void retain(const std::string& name, std::shared_ptr<Resource> resource) {
+            std::vector<std::shared_ptr<Resource>> evicted;
+            bool failed = false;
+            if constexpr (std::is_base_of_v<AsyncResource, Resource>) {
+                failed = resource->get_state() == AsyncResource::State::FAILED;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (failed || budget_ == 0) {
+                    evicted.push_back(std::move(resource));
+                } else {
+                    auto it = index_.find(name);
+                    if (it != index_.end()) {
+                        evicted.push_back(std::move(it->second->resource));
+                        entries_.erase(it->second);
+                    }
+                    entries_.push_front({name, std::move(resource)});
+                    index_[name] = entries_.begin();
+                    trim_locked(evicted);
+                }
+            }
+            dispose_all(evicted);
+        }
+
+        std::shared_ptr<Resource> take(const std::string& name) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = index_.find(name);
+            if (it == index_.end()) return nullptr;
+            std::shared_ptr<Resource> resource = std::move(it->second->resource);
+            entries_.erase(it->second);
+            index_.erase(it);
+            return resource;
+        }
+
+        bool contains(const std::string& name) const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return index_.count(name) != 0;
+        }
+
+        MemoryUsage get_usage() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return usage_locked();
+        }
+
+        void clear() {
+            std::vector<std::shared_ptr<Resource>> evicted;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (auto& entry: entries_) {
+                    evicted.push_back(std::move(entry.resource));
+                }
+                entries_.clear();
+                index_.clear();
+            }
+            dispose_all(evicted);
+        }
+
+        size_t get_budget() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return budget_;
+        }
+
+        void set_budget(size_t bytes) {
+            std::vector<std::shared_ptr<Resource>> evicted;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                budget_ = bytes;
+                trim_locked(evicted);
+            }
+            dispose_all(evicted);
+        }
+
+        size_t size() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return entries_.size();
+        }
+    };
+
+    struct Slot {
+        std::weak_ptr<Resource> handle;
+        // Set while a `get()` loads the resource, for concurrent requests to wait on
+        std::shared_future<std::shared_ptr<Resource>> pending;
+    };
+
+    // Expired names are swept once a shard doubles since its last sweep
+    static constexpr size_t MIN_SWEEP_SIZE = 16;
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, Slot> slots;
+        size_t sweep_size = MIN_SWEEP_SIZE;
+    };
+
+    std::shared_ptr<Retention> retention_;
+    mutable std::array<Shard, SHARD_COUNT> shards_;
+
+    Shard& shard_of(const std::string& name) const {
+        return shards_[std::hash<std::string>{}(name) % SHARD_COUNT];
+    }
+
+    // Shard's exclusive lock held. A live handle, or a retained resource under a new handle.
+    std::shared_ptr<Resource> find_locked(Shard& shard, const std::string& name) const {
+        auto it = shard.slots.find(name);
+        if (it != shard.slots.end()) {
+            if (std::shared_ptr<Resource> resource = it->second.handle.lock()) return resource;
+        }
+        if (std::shared_ptr<Resource> retained = retention_->take(name)) {
+            return hand_out_locked(shard, name, std::move(retained));
+        }
+        return nullptr;
+    }
+
+    // Shard's exclusive lock held. Wraps the loaded resource in a handle that gives it to
+    // the retention cache once the last copy of the handle is gone.
+    std::shared_ptr<Resource> hand_out_locked(Shard& shard, const std::string& name,
+                                              std::shared_ptr<Resource> resource) const {
+        Resource* raw = resource.get();
+        std::shared_ptr<Resource> handle(
+            raw,
+            [retention = std::weak_ptr<Retention>(retention_), name, resource = std::move(resource)](Resource*) mutable {
+                if (auto cache = retention.lock()) {
+                    cache->retain(name, std::move(resource));
+                } else {
+                    dispose(std::move(resource));
+                }
+            }
+        );
+
+        if (shard.slots.size() >= shard.sweep_size) {
+            sweep_locked(shard);
+            shard.sweep_size = std::max(MIN_SWEEP_SIZE, shard.slots.size() * 2);
+        }
+        shard.slots[name].handle = handle;
+        return handle;
+    }
+
+    // Shard's exclusive lock held. Drops names that are neither in use, retained nor loading.
+    void sweep_locked(Shard& shard) const {
+        for (auto it = shard.slots.begin(); it != shard.slots.end(); ) {
+            if (it->second.handle.expired() && !it->second.pending.valid() && !retention_->contains(it->first)) {
+                it = shard.slots.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // The hot path, only a shared lock
+    std::shared_ptr<Resource> find_live(const std::string& name) const {
+        const Shard& shard = shard_of(name);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.slots.find(name);
+        return it == shard.slots.end() ? nullptr : it->second.handle.lock();
+    }
+
+    // Blocks until the resource is uploaded. Uploads only run on the GL thread, so this
+    // pumps the upload queue while waiting.
+    static std::shared_ptr<Resource> finish(std::shared_ptr<Resource> resource) {
+        if constexpr (std::is_base_of_v<AsyncResource, Resource>) {
+            if (resource) {
+                while (resource->get_state() == AsyncResource::State::LOADING) {
+                    if (Renderer::UploadQueue::instance().process(SIZE_MAX) == 0) {
+                        std::this_thread::yield();
+                    }
+                }
+                if (!resource->is_ready()) resource = nullptr;
+            }
+        }
+        return resource;
+    }
+
 protected:
-    mutable std::unordered_map<std::string, std::weak_ptr<Resource>> resources_ = {};
     Loader loader;
 
+    // For tests, the handle tracked under `name` and the number of names tracked
+    bool tracks(const std::string& name) const {
+        const Shard& shard = shard_of(name);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.slots.count(name) != 0;
+    }
+
+    std::weak_ptr<Resource> tracked_handle(const std::string& name) const {
+        const Shard& shard = shard_of(name);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.slots.find(name);
+        return it == shard.slots.end() ? std::weak_ptr<Resource>() : it->second.handle;
+    }
+
+    template<class Fn>
+    void for_each_handle(Fn fn) const {
+        for (const Shard& shard: shards_) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (const auto& [name, slot]: shard.slots) {
+                fn(name, slot.handle);
+            }
+        }
+    }
+
 public:
-    explicit ResourceManager(Loader loader) : loader(std::move(loader)) {
+    // Nothing is retained by default, see `set_retention_budget()`
+    explicit ResourceManager(Loader loader, size_t retention_budget = 0)
+        : retention_(std::make_shared<Retention>(retention_budget)), loader(std::move(loader)) {
     };
 
+    // Loads the resource on this thread if it isn't loaded yet. A resource still loading in
+    // the background is finished first. Resources that need GL to load must be requested
+    // from the GL thread, unless they are loaded already.
     std::shared_ptr<Resource> get(const std::string& name) const {
-        auto it = resources_.find(name);
-        if ((it == resources_.end()) or (it->second.expired())) {
-            std::shared_ptr<Resource> new_res = loader.load(name);
-            resources_[name] = new_res;
-            return new_res;
+        if (std::shared_ptr<Resource> resource = finish(find_live(name))) return resource;
+
+        Shard& shard = shard_of(name);
+        std::promise<std::shared_ptr<Resource>> promise;
+        std::shared_future<std::shared_ptr<Resource>> pending;
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            std::shared_ptr<Resource> resource = find_locked(shard, name);
+            if constexpr (std::is_base_of_v<AsyncResource, Resource>) {
+                if (resource && resource->get_state() == AsyncResource::State::LOADING) {
+                    lock.unlock();
+                    return get(name);
+                }
+                if (resource && !resource->is_ready()) resource = nullptr;
+            }
+            if (resource) return resource;
+
+            Slot& slot = shard.slots[name];
+            pending = slot.pending;
+            if (!pending.valid()) slot.pending = promise.get_future().share();
         }
-        return it->second.lock();
+        // Someone else is loading it
+        if (pending.valid()) return pending.get();
+
+        std::shared_ptr<Resource> handle;
+        try {
+            std::shared_ptr<Resource> resource = loader.load(name);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            handle = hand_out_locked(shard, name, std::move(resource));
+            shard.slots[name].pending = {};
+        } catch (...) {
+            {
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                shard.slots[name].pending = {};
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        promise.set_value(handle);
+        return handle;
     }
 
-    void clean() {
-        for (auto it = resources_.begin(); it != resources_.end(); ) {
-            if (it->second.expired()) {
-                it = resources_.erase(it);
-            } else {
-                ++it;
+    // Returns at once. Until `is_ready()`, the resource is being read on the job system or
+    // waiting for its upload, which the application runs at the start of each frame. A
+    // resource that failed to load is loaded again on the next request. Any thread.
+    std::shared_ptr<Resource> get_async(const std::string& name) const {
+        static_assert(std::is_base_of_v<AsyncResource, Resource>, "Resource has no load state");
+        std::shared_ptr<Resource> resource = find_live(name);
+        if (resource && resource->get_state() != AsyncResource::State::FAILED) return resource;
+
+        Shard& shard = shard_of(name);
+        std::shared_future<std::shared_ptr<Resource>> pending;
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            resource = find_locked(shard, name);
+            if (resource && resource->get_state() != AsyncResource::State::FAILED) return resource;
+
+            Slot& slot = shard.slots[name];
+            pending = slot.pending;
+            if (!pending.valid()) {
+                // Starting a background load only queues a job, so it's done under the lock
+                return hand_out_locked(shard, name, loader.load_async(name));
             }
         }
+        // A blocking `get()` of the same name is running, share its result
+        return pending.get();
+    }
+
+    // Bytes of every resource in use or retained
+    MemoryUsage get_memory_usage() const {
+        MemoryUsage usage = retention_->get_usage();
+        for_each_handle([&usage](const std::string&, const std::weak_ptr<Resource>& handle) {
+            if (const std::shared_ptr<Resource> resource = handle.lock()) usage += memory_usage_of(*resource);
+        });
+        return usage;
+    }
+
+    // Bytes of released resources kept for reuse
+    MemoryUsage get_retained_usage() const { return retention_->get_usage(); }
+
+    size_t retained_count() const { return retention_->size(); }
+
+    size_t get_retention_budget() const { return retention_->get_budget(); }
+
+    // CPU and GPU bytes together. Retained resources over the new budget are freed at once.
+    void set_retention_budget(size_t bytes) { retention_->set_budget(bytes); }
+
+    // Frees every retained resource and forgets the names of resources not in use
+    void clean() {
+        retention_->clear();
+        for (Shard& shard: shards_) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            sweep_locked(shard);
+        }
     }
 };
 
@@ -58,19 +433,62 @@ struct ShaderLoader {
             fragment_shader_path.string()
         );
     }
+
+    // Shaders are small and compiling needs the GL thread anyway
+    std::shared_ptr<Shader> load_async(const std::string& shader_name) const {
+        return load(shader_name);
+    }
 };
 
+// The compiled version of an asset, `source_path` with `compiled_extension`, if it exists
+// and isn't older than the source. Otherwise `source_path`. The asset archive is built
+// after compiling, so anything compiled in it is current.
+inline std::filesystem::path resolve_compiled(const std::filesystem::path& source_path,
+                                              const char* compiled_extension) {
+    auto compiled_path = source_path;
+    compiled_path.replace_extension(compiled_extension);
+
+    if (AssetArchive::find_mounted(compiled_path)) return compiled_path;
+    if (AssetArchive::find_mounted(source_path)) return source_path;
+
+    std::error_code error;
+    if (!std::filesystem::exists(compiled_path, error)) return source_path;
+    if (std::filesystem::exists(source_path, error) &&
+        std::filesystem::last_write_time(source_path, error) > std::filesystem::last_write_time(compiled_path, error)) {
+        return source_path;
+    }
+    return compiled_path;
+}
+
 struct TextureLoader {
     const std::filesystem::path texture_dir;
 
     explicit TextureLoader(const std::string& texture_dir) : texture_dir(texture_dir) {
     };
 
+    // A compiled .tex next to the source image is preferred, unless the source is newer
+    std::filesystem::path resolve(const std::string& texture_name) const {
+        return resolve_compiled(texture_dir / texture_name, ".tex");
+    }
+
     std::shared_ptr<Texture> load(const std::string& texture_name, bool srgb = true) const {
-        const auto texture_file_path = texture_dir / texture_name;
+        const auto texture_file_path = resolve(texture_name);
 
         return std::make_shared<Texture>(texture_file_path, srgb);
     }
+
+    std::shared_ptr<Texture> load_async(const std::string& texture_name, bool srgb = true) const {
+        auto texture = std::make_shared<Texture>(srgb);
+        AsyncResource::load_in_background(
+            texture,
+            [path = resolve(texture_name).string()](Texture& t) {
+                t.decode(path);
+                return t.get_upload_size();
+            },
+            [](Texture& t) { t.upload(); }
+        );
+        return texture;
+    }
 };
 
 struct ModelLoader {
@@ -79,11 +497,31 @@ struct ModelLoader {
     explicit ModelLoader(const std::string& model_dir) : model_dir(model_dir) {
     }
 
+    // A compiled .mesh next to the source file is preferred, unless the source is newer
+    std::filesystem::path resolve(const std::string& model_name) const {
+        return resolve_compiled(model_dir / model_name, ".mesh");
+    }
+
     std::shared_ptr<Model::Model> load(const std::string& model_name) const {
-        const auto model_file_path = model_dir / model_name;
+        const auto model_file_path = resolve(model_name);
 
         return std::make_shared<Model::Model>(model_file_path);
     }
+
+    // Textures are requested as soon as the model is imported, and stream in alongside it
+    std::shared_ptr<Model::Model> load_async(const std::string& model_name) const {
+        auto model = std::make_shared<Model::Model>();
+        AsyncResource::load_in_background(
+            model,
+            [path = resolve(model_name).string()](Model::Model& m) {
+                m.import(path);
+                m.request_textures();
+                return m.get_upload_size();
+            },
+            [](Model::Model& m) { m.upload(true); }
+        );
+        return model;
+    }
 };
 
 using ShaderManager = ResourceManager<Shader, ShaderLoader>;
@@ -96,9 +534,23 @@ private:
     static bool initialized;
 
 public:
+    // Per manager, released models and textures stay loaded up to this many bytes
+    static constexpr size_t DEFAULT_RETENTION_BUDGET = 256 << 20;
+
+    // Mounts the executable's asset archive when it has one, see `AssetArchive`
     static void initialize(const std::filesystem::path& exe_path) {
         Managers::exe_dir_path = exe_path;
         Managers::initialized = true;
+
+        const auto archive_path = exe_path / AssetArchive::DEFAULT_NAME;
+        std::error_code error;
+        if (!AssetArchive::mounted() && std::filesystem::exists(archive_path, error)) {
+            try {
+                AssetArchive::mount(std::make_unique<AssetArchive>(archive_path.string()));
+            } catch (const std::exception& e) {
+                printf("WARNING — %s, loading loose files\n", e.what());
+            }
+        }
     }
 
     static ShaderManager& shader_manager() {
@@ -114,7 +566,7 @@ public:
         if (!initialized) {
             throw std::runtime_error("Managers not initialized! Call Managers::initialize() first.");
         }
-        static TextureManager instance(TextureLoader(exe_dir_path / "textures"));
+        static TextureManager instance(TextureLoader(exe_dir_path / "textures"), DEFAULT_RETENTION_BUDGET);
         return instance;
     }
 
@@ -122,7 +574,7 @@ public:
         if (!initialized) {
             throw std::runtime_error("Managers not initialized! Call Managers::initialize() first.");
         }
-        static ModelManager instance(ModelLoader(exe_dir_path / "models"));
+        static ModelManager instance(ModelLoader(exe_dir_path / "models"), DEFAULT_RETENTION_BUDGET);
         return instance;
     }
 };
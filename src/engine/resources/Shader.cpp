@@ -2,13 +2,19 @@
 #include <sstream>
 #include <iostream>
 
-#include <OpenGL/gl3.h>
+#include "engine/renderer/GL.hpp"
 #include <glm/gtc/type_ptr.hpp>
 
 #include "engine/resources/Shader.hpp"
+#include "engine/renderer/Backend.hpp"
+#include "engine/utilities/AssetArchive.hpp"
 
 
 std::string load_shader_source_from_file(const std::string& shader_path) {
+    if (const auto packed = AssetArchive::find_mounted(shader_path)) {
+        return std::string(reinterpret_cast<const char*>(packed->data()), packed->size());
+    }
+
     std::string shader_code;
     std::ifstream shader_file;
 
@@ -29,6 +35,12 @@ std::string load_shader_source_from_file(const std::string& shader_path) {
 }
 
 Shader::Shader(const std::string& vertex_shader_path, const std::string& fragment_shader_path) {
+    // The software backend shades on the CPU, the shader only identifies draws
+    if (!Renderer::uses_gl()) {
+        id = 0;
+        return;
+    }
+
     const std::string v_shader_source = load_shader_source_from_file(vertex_shader_path);
     const std::string f_shader_source = load_shader_source_from_file(fragment_shader_path);
 
@@ -131,6 +143,14 @@ void Shader::set_float(const std::string& uniform_name, float value) const {
     );
 }
 
+void Shader::set_vec2(const std::string& uniform_name, const glm::vec2& value) const {
+    glUniform2fv(
+        get_uniform_location(uniform_name),
+        1,
+        glm::value_ptr(value)
+    );
+}
+
 void Shader::set_vec3(const std::string& uniform_name, const glm::vec3& value) const {
     glUniform3fv(
         get_uniform_location(uniform_name),
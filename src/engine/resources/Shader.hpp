@@ -4,10 +4,12 @@
 #include <unordered_map>
 
 #include <glm/glm.hpp>
-#include <OpenGL/gl3.h>
+#include "engine/renderer/GL.hpp"
+#include "engine/resources/AsyncResource.hpp"
 
 
-class Shader {
+// Compiled on the GL thread as soon as it's requested, so always ready
+class Shader : public AsyncResource {
 private:
     mutable std::unordered_map<std::string, GLuint> uniform_id_lookup_;
 public:
@@ -34,6 +36,8 @@ public:
 
     void set_float(const std::string& uniform_name, float value) const;
 
+    void set_vec2(const std::string& uniform_name, const glm::vec2& value) const;
+
     void set_vec3(const std::string& uniform_name, const glm::vec3& value) const;
 
     void set_mat4(const std::string& uniform_name, const glm::mat4& value) const;
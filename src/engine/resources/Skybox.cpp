@@ -3,7 +3,9 @@
 //
 
 #include "Skybox.hpp"
-#include <stb_image.h>
+
+#include "engine/resources/ImageDecoder.hpp"
+#include "engine/utilities/JobSystem.hpp"
 
 void Skybox::init_gl_buffers() {
     glGenVertexArrays(1, &VAO);
@@ -35,29 +37,42 @@ void Skybox::init_gl_buffers() {
 
 
 unsigned int Skybox::load_cubemap(const std::vector<std::string>& faces) {
+    // Decoding dominates the load, so the faces are decoded in parallel and uploaded after.
+    // Cubemap faces are stored top down, unlike 2D textures.
+    std::vector<ImageDecoder::Image> decoded(faces.size());
+    JobSystem::instance().parallel_for(faces.size(), 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            try {
+                decoded[i] = ImageDecoder::decode(faces[i], false, 3);
+            } catch (const std::exception&) {
+                // Reported below, on the calling thread
+            }
+        }
+    });
+
     unsigned int textureID;
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    stbi_set_flip_vertically_on_load(false);
-
-    int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++) {
-        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 3);
-        if (data) {
+    for (unsigned int i = 0; i < decoded.size(); i++) {
+        if (!decoded[i].pixels.empty()) {
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                         0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data
+                         0, GL_RGB, decoded[i].width, decoded[i].height, 0, GL_RGB, GL_UNSIGNED_BYTE,
+                         decoded[i].pixels.data()
             );
-            stbi_image_free(data);
+            ImageDecoder::release_buffer(std::move(decoded[i].pixels));
         } else {
-            printf("Cubemap tex failed to load at path: %s", faces[i].c_str());
-            stbi_image_free(data);
+            printf("Cubemap tex failed to load at path: %s\n", faces[i].c_str());
         }
     }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-    stbi_set_flip_vertically_on_load(true);
+    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    // Filter across face edges, otherwise the seams show at the smaller mips
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -67,6 +82,9 @@ unsigned int Skybox::load_cubemap(const std::vector<std::string>& faces) {
 }
 
 void Skybox::render(const Camera& camera) const {
+    // Drawn after the opaque geometry at the far plane (see skybox.vert), so the depth test
+    // rejects every covered pixel before it is shaded
+    glDepthFunc(GL_LEQUAL);
     glDepthMask(GL_FALSE);
     shader_->use();
     shader_->set_mat4("view", glm::mat4(glm::mat3(camera.get_view_matrix().to_glm())));
@@ -76,4 +94,5 @@ void Skybox::render(const Camera& camera) const {
     glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id_);
     glDrawArrays(GL_TRIANGLES, 0, 36);
     glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
 }
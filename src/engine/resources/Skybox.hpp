@@ -7,11 +7,12 @@
 #include <vector>
 #include <memory>
 
-#include <OpenGL/gl3.h>
+#include "engine/renderer/GL.hpp"
 
 #include "engine/objects/Camera.hpp"
 #include "engine/resources/Shader.hpp"
 #include "engine/resources/ResourceManager.hpp"
+#include "engine/renderer/Backend.hpp"
 
 
 class Skybox {
@@ -72,14 +73,19 @@ private:
     unsigned int load_cubemap(const std::vector<std::string>& faces);
 
 public:
-    Skybox(const std::vector<std::string>& faces) : texture_id_(load_cubemap(faces)) {
+    // Not drawn by the software backend, which leaves the skybox unloaded
+    Skybox(const std::vector<std::string>& faces) {
+        if (!Renderer::uses_gl()) return;
+        texture_id_ = load_cubemap(faces);
         init_gl_buffers();
         shader_ = Managers::shader_manager().get("skybox");
     }
 
     ~Skybox() noexcept {
-        glDeleteBuffers(1, &VBO);
-        glDeleteVertexArrays(1, &VAO);
+        if (VAO) {
+            glDeleteBuffers(1, &VBO);
+            glDeleteVertexArrays(1, &VAO);
+        }
         if (texture_id_) glDeleteTextures(1, &texture_id_);
     }
 
@@ -99,8 +105,10 @@ public:
     Skybox& operator=(Skybox&& other) noexcept {
         if (this != &other) {
             // Delete current
-            glDeleteBuffers(1, &VBO);
-            glDeleteVertexArrays(1, &VAO);
+            if (VAO) {
+                glDeleteBuffers(1, &VBO);
+                glDeleteVertexArrays(1, &VAO);
+            }
             if (texture_id_) glDeleteTextures(1, &texture_id_);
 
             VAO = other.VAO;
@@ -1,32 +1,195 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <memory>
 #include <string>
+#include <vector>
 
-#include <stb_image.h>
-#include <OpenGL/gl3.h>
+#include "engine/renderer/GL.hpp"
 
-class Texture {
+#include "engine/renderer/Backend.hpp"
+#include "engine/resources/AsyncResource.hpp"
+#include "engine/resources/ImageDecoder.hpp"
+#include "engine/resources/MemoryUsage.hpp"
+#include "engine/resources/TextureFile.hpp"
+#include "engine/renderer/TextureStreamer.hpp"
+
+class Texture : public AsyncResource {
 public:
     GLuint id = 0;
     int width = 0;
     int height = 0;
     int channels = 0;
+    bool srgb = true;
+    std::vector<unsigned char> pixels;  // Decoded rows bottom up, only kept after upload for the software backend
+    std::unique_ptr<TextureFile::Image> compressed;  // Mapped mip chain of a compiled .tex file, until upload
+    size_t gpu_size = 0;  // Texture memory taken by the uploaded levels
+
+    // Streaming, see `Renderer::TextureStreamer`. A streamed texture keeps `compressed`
+    // mapped and has levels `resident_level` and coarser uploaded.
+    bool streaming = false;
+    int resident_level = 0;
+    std::atomic<int> requested_level{0};  // Finest level a draw asked for since the last update
+    unsigned int frames_unseen = 0;
+
+    explicit Texture(const std::string& path, bool srgb = true) : srgb(srgb) {
+        decode(path);
+        upload();
+    }
+
+    // Empty and still loading, for `AsyncResource::load_in_background()`
+    explicit Texture(bool srgb) : AsyncResource(State::LOADING), srgb(srgb) {}
+
+    // CPU half of loading, safe on any thread and on many at once. Compiled .tex files are
+    // only mapped.
+    void decode(const std::string& path) {
+        if (std::filesystem::path(path).extension() == ".tex") {
+            compressed = std::make_unique<TextureFile::Image>(path);
+            width = compressed->get_levels()[0].width;
+            height = compressed->get_levels()[0].height;
+            channels = compressed->get_channels();
+            return;
+        }
+
+        ImageDecoder::Image image = ImageDecoder::decode(path, true);
+        width = image.width;
+        height = image.height;
+        channels = image.channels;
+        pixels = std::move(image.pixels);
+    }
+
+    // Bytes `upload()` sends to the GPU, only the tail for textures that will stream
+    size_t get_upload_size() const {
+        if (!compressed) return pixels.size();
+        if (!will_stream()) return compressed->get_size();
+        size_t size = 0;
+        for (int level = get_tail_level(); level < get_level_count(); level++) size += get_level_size(level);
+        return size;
+    }
+
+    MemoryUsage get_memory_usage() const {
+        return {pixels.capacity() + (compressed ? compressed->get_size() : 0), gpu_size};
+    }
 
-    explicit Texture(const std::string& path, bool srgb = true) {
-        stbi_set_flip_vertically_on_load(true);
-        unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
-        if (!data) throw std::runtime_error("Failed to load texture: " + path);
+    int get_level_count() const { return compressed ? static_cast<int>(compressed->get_levels().size()) : 1; }
+
+    // Longer side of the top level
+    int get_streamed_size() const { return std::max(width, height); }
+
+    size_t get_level_size(int level) const { return compressed->get_levels()[level].data.size(); }
+
+    // Coarsest level that is still resident when nothing is drawn with the texture
+    int get_tail_level() const {
+        const auto& levels = compressed->get_levels();
+        int level = 0;
+        while (level + 1 < static_cast<int>(levels.size()) &&
+               std::max(levels[level].width, levels[level].height) > Renderer::TextureStreamer::TAIL_SIZE) {
+            level++;
+        }
+        return level;
+    }
+
+    // GL half of loading, GL thread only
+    void upload() {
+        if (compressed && !(Renderer::uses_gl() && TextureFile::gl_supported())) {
+            // The software backend and drivers without S3TC get the top level decoded
+            const TextureFile::Level& top = compressed->get_levels()[0];
+            pixels = BlockCompression::decompress(top.data.data(), top.width, top.height, compressed->get_format());
+            channels = 4;
+            compressed.reset();
+        }
+        if (!Renderer::uses_gl()) return;
+
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+        if (compressed) {
+            // Mips were baked offline. Large textures start with their tail and stream the rest.
+            streaming = will_stream();
+            upload_levels(streaming ? get_tail_level() : 0);
+        } else {
+            GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
+            GLenum internal = srgb
+                                  ? ((channels == 4) ? GL_SRGB8_ALPHA8 : GL_SRGB8)
+                                  : ((channels == 4) ? GL_RGBA8 : GL_RGB8);
+
+            glTexImage2D(GL_TEXTURE_2D, 0, internal, width, height, 0, format, GL_UNSIGNED_BYTE, pixels.data());
+            glGenerateMipmap(GL_TEXTURE_2D);
+            // The mip chain adds a third
+            gpu_size = pixels.size() + pixels.size() / 3;
+        }
+
+        set_sampling();
+        glBindTexture(GL_TEXTURE_2D, 0);
+        // Back to the pool for the next texture to decode into
+        ImageDecoder::release_buffer(std::move(pixels));
+        if (streaming) {
+            requested_level = get_level_count();
+            Renderer::TextureStreamer::instance().add(this);
+        } else {
+            compressed.reset();
+        }
+    }
 
-        GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
-        GLenum internal = srgb
-                              ? ((channels == 4) ? GL_SRGB8_ALPHA8 : GL_SRGB8)
-                              : ((channels == 4) ? GL_RGBA8 : GL_RGB8);
+    // Streaming, GL thread only. Uploads `level`, the one finer than `resident_level`.
+    void upload_level(int level) {
+        const TextureFile::Level& data = compressed->get_levels()[level];
+        glBindTexture(GL_TEXTURE_2D, id);
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, compressed->gl_format(srgb), data.width, data.height, 0,
+                               static_cast<GLsizei>(data.data.size()), data.data.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        resident_level = level;
+        gpu_size += data.data.size();
+    }
 
+    // Streaming, GL thread only. Frees the levels finer than `level`. GL 3.3 can't free
+    // single levels, so the coarser ones are uploaded again to a new texture object.
+    void trim(int level) {
+        glDeleteTextures(1, &id);
         glGenTextures(1, &id);
         glBindTexture(GL_TEXTURE_2D, id);
-        glTexImage2D(GL_TEXTURE_2D, 0, internal, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        upload_levels(level);
+        set_sampling();
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    ~Texture() noexcept {
+        if (streaming) Renderer::TextureStreamer::instance().remove(this);
+        if (id) glDeleteTextures(1, &id);
+    }
+
+    void bind(unsigned int unit = 0) const {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, id);
+    }
 
+private:
+    bool will_stream() const {
+        return compressed && Renderer::TextureStreamer::instance().is_enabled() &&
+               get_streamed_size() > Renderer::TextureStreamer::MIN_STREAMED_SIZE;
+    }
+
+    // Levels `first` to the last of `compressed` to the bound texture
+    void upload_levels(int first) {
+        const GLenum internal = compressed->gl_format(srgb);
+        const auto& levels = compressed->get_levels();
+        gpu_size = 0;
+        for (size_t level = first; level < levels.size(); level++) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internal,
+                                   levels[level].width, levels[level].height, 0,
+                                   static_cast<GLsizei>(levels[level].data.size()), levels[level].data.data());
+            gpu_size += levels[level].data.size();
+        }
+        // Sampling is clamped to the uploaded levels, which makes the texture complete
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, first);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size() - 1));
+        resident_level = first;
+    }
+
+    // Of the bound texture
+    void set_sampling() {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -43,15 +206,5 @@ public:
         float maxAniso = 0.0f;
         glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAniso);
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAniso);
-
-        stbi_image_free(data);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
-
-    ~Texture() noexcept { if (id) glDeleteTextures(1, &id); }
-
-    void bind(unsigned int unit = 0) const {
-        glActiveTexture(GL_TEXTURE0 + unit);
-        glBindTexture(GL_TEXTURE_2D, id);
     }
 };
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "engine/resources/TextureFile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// EXT_texture_compression_s3tc and EXT_texture_sRGB, not in the core headers
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace TextureFile {
+    static_assert(sizeof(Header) == 40, "Header layout changed, bump VERSION");
+    static_assert(sizeof(LevelRecord) == 24, "LevelRecord layout changed, bump VERSION");
+
+    static size_t align(size_t offset) {
+        return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    static float srgb_to_linear(float c) {
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static float linear_to_srgb(float c) {
+        return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    }
+
+    // Half size with a 2x2 box filter, odd edges repeat their last texel. With `srgb` the
+    // colors are averaged in linear space, averaging the encoded values darkens the mips.
+    static std::vector<unsigned char> downsample(const std::vector<unsigned char>& rgba, int width, int height,
+                                                 bool srgb) {
+        static const auto to_linear = [] {
+            std::vector<float> table(256);
+            for (int i = 0; i < 256; i++) table[i] = srgb_to_linear(i / 255.0f);
+            return table;
+        }();
+
+        const int out_width = std::max(1, width / 2), out_height = std::max(1, height / 2);
+        std::vector<unsigned char> out(static_cast<size_t>(out_width) * out_height * 4);
+        for (int y = 0; y < out_height; y++) {
+            for (int x = 0; x < out_width; x++) {
+                float sum[4] = {};
+                for (int i = 0; i < 4; i++) {
+                    const int sx = std::min(x * 2 + i % 2, width - 1);
+                    const int sy = std::min(y * 2 + i / 2, height - 1);
+                    const unsigned char* texel = &rgba[(static_cast<size_t>(sy) * width + sx) * 4];
+                    for (int ch = 0; ch < 3; ch++) sum[ch] += srgb ? to_linear[texel[ch]] : texel[ch] / 255.0f;
+                    sum[3] += texel[3] / 255.0f;
+                }
+                unsigned char* texel = &out[(static_cast<size_t>(y) * out_width + x) * 4];
+                for (int ch = 0; ch < 4; ch++) {
+                    const float average = sum[ch] / 4.0f;
+                    const float encoded = srgb && ch < 3 ? linear_to_srgb(average) : average;
+                    texel[ch] = static_cast<unsigned char>(std::lround(std::clamp(encoded, 0.0f, 1.0f) * 255.0f));
+                }
+            }
+        }
+        return out;
+    }
+
+    Image::Image(const std::string& path) : file_(path) {
+        const unsigned char* base = file_.data();
+        const size_t size = file_.size();
+        auto invalid = [&path](const char* reason) {
+            return std::runtime_error("Invalid texture file " + path + ": " + reason);
+        };
+
+        if (size < sizeof(Header)) throw invalid("truncated header");
+        Header header;
+        std::memcpy(&header, base, sizeof(Header));
+        if (header.magic != MAGIC) throw invalid("bad magic");
+        if (header.version != VERSION) throw invalid("unsupported version");
+        if (header.file_size != size) throw invalid("truncated");
+        if (header.format != static_cast<uint32_t>(BlockCompression::Format::BC1) &&
+            header.format != static_cast<uint32_t>(BlockCompression::Format::BC3)) {
+            throw invalid("unsupported format");
+        }
+        if (header.level_count == 0 || header.level_count > 32 ||
+            (size - sizeof(Header)) / sizeof(LevelRecord) < header.level_count) {
+            throw invalid("bad level count");
+        }
+        format_ = static_cast<BlockCompression::Format>(header.format);
+        channels_ = static_cast<int>(header.channels);
+
+        const auto* records = reinterpret_cast<const LevelRecord*>(base + sizeof(Header));
+        for (uint32_t i = 0; i < header.level_count; i++) {
+            const LevelRecord& record = records[i];
+            // Each level halves the previous one, down to 1x1
+            const uint32_t width = std::max(1u, header.width >> i), height = std::max(1u, header.height >> i);
+            if (record.width != width || record.height != height || width > 65536 || height > 65536 ||
+                record.size != BlockCompression::image_bytes(format_, static_cast<int>(width), static_cast<int>(height)) ||
+                record.offset > size || record.size > size - record.offset) {
+                throw invalid("bad level");
+            }
+            levels_.push_back({static_cast<int>(width), static_cast<int>(height),
+                               Span<unsigned char>(base + record.offset, record.size)});
+        }
+    }
+
+    size_t Image::get_size() const {
+        size_t bytes = 0;
+        for (const auto& level: levels_) bytes += level.data.size();
+        return bytes;
+    }
+
+    GLenum Image::gl_format(bool srgb) const {
+        if (format_ == BlockCompression::Format::BC3) {
+            return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        }
+        return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    }
+
+    void write(const unsigned char* pixels, int width, int height, int channels, bool srgb, const std::string& path) {
+        if (width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+            throw std::runtime_error("Can't compress a " + std::to_string(width) + "x" + std::to_string(height) +
+                                     " image with " + std::to_string(channels) + " channels");
+        }
+
+        // Everything is encoded from RGBA, grey images are spread over the color channels
+        std::vector<unsigned char> rgba(static_cast<size_t>(width) * height * 4);
+        bool has_alpha = false;
+        for (size_t i = 0; i < static_cast<size_t>(width) * height; i++) {
+            const unsigned char* texel = pixels + i * channels;
+            rgba[i * 4] = texel[0];
+            rgba[i * 4 + 1] = channels >= 3 ? texel[1] : texel[0];
+            rgba[i * 4 + 2] = channels >= 3 ? texel[2] : texel[0];
+            rgba[i * 4 + 3] = channels == 4 ? texel[3] : channels == 2 ? texel[1] : 255;
+            has_alpha |= rgba[i * 4 + 3] != 255;
+        }
+        // Plenty of RGBA images are opaque, those get the smaller format
+        const auto format = has_alpha ? BlockCompression::Format::BC3 : BlockCompression::Format::BC1;
+
+        std::vector<std::vector<unsigned char>> levels;
+        std::vector<LevelRecord> records;
+        int level_width = width, level_height = height;
+        while (true) {
+            levels.push_back(BlockCompression::compress(rgba.data(), level_width, level_height, format));
+            LevelRecord record;
+            record.width = static_cast<uint32_t>(level_width);
+            record.height = static_cast<uint32_t>(level_height);
+            record.size = levels.back().size();
+            records.push_back(record);
+            if (level_width == 1 && level_height == 1) break;
+
+            rgba = downsample(rgba, level_width, level_height, srgb);
+            level_width = std::max(1, level_width / 2);
+            level_height = std::max(1, level_height / 2);
+        }
+
+        Header header;
+        header.format = static_cast<uint32_t>(format);
+        header.width = static_cast<uint32_t>(width);
+        header.height = static_cast<uint32_t>(height);
+        header.level_count = static_cast<uint32_t>(levels.size());
+        header.flags = srgb ? FLAG_SRGB_MIPS : 0;
+        header.channels = static_cast<uint32_t>(channels);
+
+        size_t offset = align(sizeof(Header) + records.size() * sizeof(LevelRecord));
+        for (auto& record: records) {
+            record.offset = offset;
+            offset = align(offset + record.size);
+        }
+        header.file_size = offset;
+
+        std::vector<unsigned char> bytes(offset, 0);
+        std::memcpy(bytes.data(), &header, sizeof(Header));
+        std::memcpy(bytes.data() + sizeof(Header), records.data(), records.size() * sizeof(LevelRecord));
+        for (size_t i = 0; i < levels.size(); i++) {
+            std::memcpy(bytes.data() + records[i].offset, levels[i].data(), levels[i].size());
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) throw std::runtime_error("Failed to write texture file: " + path);
+    }
+
+    bool gl_supported() {
+        static const bool supported = [] {
+            GLint n_extensions = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &n_extensions);
+            for (GLint i = 0; i < n_extensions; i++) {
+                const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+                if (name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) return true;
+            }
+            return false;
+        }();
+        return supported;
+    }
+}
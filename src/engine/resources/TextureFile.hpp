@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine/renderer/GL.hpp"
+#include "engine/resources/BlockCompression.hpp"
+#include "engine/utilities/MappedFile.hpp"
+#include "engine/utilities/Span.hpp"
+
+// Compiled texture format, written by the texture_compiler tool and preferred by
+// `TextureLoader` over the source image when present. Like a KTX2 file it holds a
+// block-compressed image with its full mip chain baked offline, so loading maps the file
+// and hands each level to glCompressedTexImage2D without decoding anything.
+//
+// The file is a header, one record per mip level and the level data, each level aligned
+// to `ALIGNMENT` bytes. Rows are stored bottom up like `Texture::pixels`. All fields are
+// little endian.
+namespace TextureFile {
+    constexpr uint32_t MAGIC = 0x54444C47;  // "GLDT"
+    constexpr uint32_t VERSION = 1;
+    constexpr size_t ALIGNMENT = 16;
+
+    constexpr uint32_t FLAG_SRGB_MIPS = 1;  // Mips were filtered in linear space, sample with an sRGB format
+
+    struct Header {
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t format = 0;  // `BlockCompression::Format`
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t level_count = 0;
+        uint32_t flags = 0;
+        uint32_t channels = 0;  // Of the source image
+        uint64_t file_size = 0;
+    };
+
+    struct LevelRecord {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    struct Level {
+        int width = 0;
+        int height = 0;
+        Span<unsigned char> data;
+    };
+
+    // A validated, mapped texture file. The level data points into the mapping.
+    class Image {
+    private:
+        MappedFile file_;
+        BlockCompression::Format format_ = BlockCompression::Format::BC1;
+        int channels_ = 0;
+        std::vector<Level> levels_;
+
+    public:
+        // Throws if the file can't be mapped or isn't a valid texture file
+        explicit Image(const std::string& path);
+
+        BlockCompression::Format get_format() const { return format_; }
+        int get_channels() const { return channels_; }
+        const std::vector<Level>& get_levels() const { return levels_; }
+
+        // Bytes of all levels, what the upload sends to the GPU
+        size_t get_size() const;
+
+        // Compressed internal format for glCompressedTexImage2D
+        GLenum gl_format(bool srgb) const;
+    };
+
+    // BC3 when the image has alpha, BC1 otherwise. With `srgb`, mips are filtered in
+    // linear space. Throws if the file can't be written.
+    void write(const unsigned char* pixels, int width, int height, int channels, bool srgb, const std::string& path);
+
+    // Whether the driver samples S3TC blocks, GL thread only
+    bool gl_supported();
+}
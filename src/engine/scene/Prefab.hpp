@@ -3,6 +3,7 @@
 //
 
 #pragma once
+#include "engine/resources/Preloader.hpp"
 #include "engine/scene/Scene.hpp"
 
 namespace Scene {
@@ -12,5 +13,8 @@ namespace Scene {
         virtual ~Prefab() noexcept = default;
 
         virtual NodeId initialize(Scene &scene) const = 0;
+
+        // Adds the assets `initialize()` uses, so they can be preloaded together beforehand
+        virtual void collect(AssetManifest &manifest) const { (void) manifest; }
     };
 }
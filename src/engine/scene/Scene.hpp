@@ -11,8 +11,13 @@
 #include "engine/objects/Node.hpp"
 #include "engine/objects/Camera.hpp"
 #include "engine/objects/LightSource.hpp"
+#include "engine/objects/ParticleEmitter.hpp"
 #include "engine/objects/RenderedObject.hpp"
 #include "engine/resources/Skybox.hpp"
+#include "engine/renderer/RenderGraph.hpp"
+#include "engine/renderer/RenderQueue.hpp"
+#include "engine/renderer/ParticleRenderer.hpp"
+#include "engine/renderer/Backend.hpp"
 
 namespace Scene {
     using NodeId = unsigned int;
@@ -21,8 +26,12 @@ namespace Scene {
     private:
         std::unordered_map<NodeId, std::unique_ptr<Node> > scene_objects_;
         std::unordered_set<NodeId> area_lights_;
+        std::unordered_set<NodeId> particle_emitters_;
         NodeId scene_camera_;
         std::unique_ptr<Skybox> skybox_ = nullptr;
+        mutable Renderer::RenderQueue render_queue_;
+        // Created with the first particle pass, scenes without emitters never load its shader
+        mutable std::unique_ptr<Renderer::ParticleRenderer> particle_renderer_ = nullptr;
 
     public:
         Scene() = default;
@@ -48,6 +57,9 @@ namespace Scene {
             if (node_has_property(*node, Node::SceneProperties::AREA_LIGHT)) {
                 area_lights_.insert(id);
             }
+            if (node_has_property(*node, Node::SceneProperties::PARTICLE_EMITTER)) {
+                particle_emitters_.insert(id);
+            }
             if (node_has_property(*node, Node::SceneProperties::CAMERA)) {
                 scene_camera_ = id;
             }
@@ -77,15 +89,15 @@ namespace Scene {
             }
         }
 
-        void render() const {
+        const Camera* get_camera() const {
             auto it = scene_objects_.find(scene_camera_);
             assert(it != scene_objects_.end());
-            auto camera = dynamic_cast<Camera*>(it->second.get());
+            return dynamic_cast<Camera*>(it->second.get());
+        }
 
-            if (skybox_) {
-                skybox_->render(*camera);
-            }
+        const Skybox* get_skybox() const { return skybox_.get(); }
 
+        std::vector<const LightSource*> get_lights() const {
             std::vector<const LightSource*> lights;
             for (auto light_id: area_lights_) {
                 auto it = scene_objects_.find(light_id);
@@ -93,13 +105,84 @@ namespace Scene {
                     lights.push_back(dynamic_cast<LightSource*>(it->second.get()));
                 }
             }
+            return lights;
+        }
+
+        std::vector<const ParticleEmitter*> get_particle_emitters() const {
+            std::vector<const ParticleEmitter*> emitters;
+            for (auto emitter_id: particle_emitters_) {
+                auto it = scene_objects_.find(emitter_id);
+                if (it != scene_objects_.end()) {
+                    emitters.push_back(dynamic_cast<ParticleEmitter*>(it->second.get()));
+                }
+            }
+            return emitters;
+        }
 
+        std::vector<const RenderedObject*> get_renderables() const {
+            std::vector<const RenderedObject*> renderables;
             for (const auto& [key, object]: scene_objects_) {
                 if (node_has_property(*object, Node::SceneProperties::RENDERABLE)) {
-                    auto* rendered = dynamic_cast<RenderedObject*>(object.get());
-                    rendered->render(camera, lights);
+                    renderables.push_back(dynamic_cast<RenderedObject*>(object.get()));
                 }
             }
+            return renderables;
+        }
+
+        // Records this frame's draw commands on the job system and returns the sorted queue
+        const Renderer::RenderQueue& record_render_queue() const {
+            render_queue_.record(*this);
+            return render_queue_;
+        }
+
+        // Add after the passes writing opaque geometry to `target`, the skybox only fills the
+        // pixels they left at the far plane
+        void add_skybox_pass(Renderer::RenderGraph& graph, const Renderer::RenderTarget& target) const {
+            if (!skybox_) return;
+
+            const Camera* camera = get_camera();
+            const Skybox* skybox = skybox_.get();
+            graph.add_pass("skybox", [&](Renderer::RenderGraph::PassBuilder& builder) {
+                builder.write(target);
+            }, [camera, skybox, target](const Renderer::RenderGraph::PassResources&) {
+                glViewport(0, 0, target.viewport_width, target.viewport_height);
+                skybox->render(*camera);
+            });
+        }
+
+        // Blended over everything else, so add it after the skybox
+        void add_particle_pass(Renderer::RenderGraph& graph, const Renderer::RenderTarget& target) const {
+            std::vector<const ParticleEmitter*> emitters = get_particle_emitters();
+            if (emitters.empty() || !Renderer::uses_gl()) return;
+            if (!particle_renderer_) {
+                particle_renderer_ = std::make_unique<Renderer::ParticleRenderer>();
+            }
+
+            const Renderer::ParticleRenderer* renderer = particle_renderer_.get();
+            const Renderer::FrameUniforms frame = Renderer::FrameUniforms::from_scene(*get_camera(), get_lights());
+            graph.add_pass("particles", [&](Renderer::RenderGraph::PassBuilder& builder) {
+                builder.write(target);
+            }, [renderer, emitters, frame, target](const Renderer::RenderGraph::PassResources&) {
+                glViewport(0, 0, target.viewport_width, target.viewport_height);
+                for (const auto emitter: emitters) {
+                    renderer->draw(emitter->get_pool(), emitter->get_settings().size, frame);
+                }
+            });
+        }
+
+        // Forward rendering: every renderable lit by the scene's lights, the skybox, then particles
+        void add_render_passes(Renderer::RenderGraph& graph, const Renderer::RenderTarget& target) const {
+            const Renderer::RenderQueue* queue = &record_render_queue();
+            const Renderer::FrameUniforms frame = Renderer::FrameUniforms::from_scene(*get_camera(), get_lights());
+            graph.add_pass("opaque", [&](Renderer::RenderGraph::PassBuilder& builder) {
+                builder.write(target);
+            }, [queue, frame, target](const Renderer::RenderGraph::PassResources&) {
+                glViewport(0, 0, target.viewport_width, target.viewport_height);
+                queue->execute(frame);
+            });
+
+            add_skybox_pass(graph, target);
+            add_particle_pass(graph, target);
         }
     };
 }
@@ -0,0 +1,161 @@
+#include "engine/utilities/AssetArchive.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static_assert(sizeof(AssetArchive::Header) == 48, "Header layout changed, bump VERSION");
+static_assert(sizeof(AssetArchive::Bucket) == 32, "Bucket layout changed, bump VERSION");
+
+static std::unique_ptr<AssetArchive>& mounted_archive() {
+    static std::unique_ptr<AssetArchive> archive;
+    return archive;
+}
+
+static size_t align(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+uint64_t AssetArchive::hash(const std::string& name) {
+    // 64-bit FNV-1a, never 0 since that marks empty buckets
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (const char c: name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001B3ull;
+    }
+    return h ? h : 1;
+}
+
+AssetArchive::AssetArchive(const std::string& path)
+    : file_(path), root_(std::filesystem::path(path).parent_path().lexically_normal()) {
+    const unsigned char* base = file_.data();
+    const size_t size = file_.size();
+    auto invalid = [&path](const char* reason) {
+        return std::runtime_error("Invalid asset archive " + path + ": " + reason);
+    };
+
+    if (size < sizeof(Header)) throw invalid("truncated header");
+    header_ = reinterpret_cast<const Header*>(base);
+    if (header_->magic != MAGIC) throw invalid("bad magic");
+    if (header_->version != VERSION) throw invalid("unsupported version");
+    if (header_->file_size != size) throw invalid("truncated");
+    const uint32_t n_buckets = header_->bucket_count;
+    if (n_buckets == 0 || (n_buckets & (n_buckets - 1)) != 0 || header_->entry_count >= n_buckets) {
+        throw invalid("bad bucket count");
+    }
+    if (header_->buckets_offset > size || n_buckets > (size - header_->buckets_offset) / sizeof(Bucket) ||
+        header_->strings_offset > size || header_->strings_size > size - header_->strings_offset) {
+        throw invalid("table out of range");
+    }
+    buckets_ = reinterpret_cast<const Bucket*>(base + header_->buckets_offset);
+    strings_ = reinterpret_cast<const char*>(base + header_->strings_offset);
+
+    // Every entry is checked once here, lookups trust the table
+    for (uint32_t i = 0; i < n_buckets; i++) {
+        const Bucket& bucket = buckets_[i];
+        if (bucket.hash == 0) continue;
+        if (static_cast<uint64_t>(bucket.name_offset) + bucket.name_length > header_->strings_size ||
+            bucket.offset > size || bucket.size > size - bucket.offset) {
+            throw invalid("entry out of range");
+        }
+    }
+}
+
+std::optional<Span<unsigned char>> AssetArchive::find_name(const std::string& name) const {
+    const uint64_t h = hash(name);
+    const uint32_t mask = header_->bucket_count - 1;
+    // The table is never full, so probing always reaches an empty bucket
+    for (uint32_t i = static_cast<uint32_t>(h) & mask;; i = (i + 1) & mask) {
+        const Bucket& bucket = buckets_[i];
+        if (bucket.hash == 0) return std::nullopt;
+        if (bucket.hash == h && bucket.name_length == name.size() &&
+            std::memcmp(strings_ + bucket.name_offset, name.data(), name.size()) == 0) {
+            return Span<unsigned char>(file_.data() + bucket.offset, bucket.size);
+        }
+    }
+}
+
+std::optional<Span<unsigned char>> AssetArchive::find(const std::filesystem::path& path) const {
+    const std::filesystem::path relative = path.lexically_normal().lexically_relative(root_);
+    if (relative.empty()) return std::nullopt;
+    return find_name(relative.generic_string());
+}
+
+void AssetArchive::write(const std::filesystem::path& root, const std::vector<std::string>& names,
+                         const std::string& path) {
+    uint32_t n_buckets = 1;
+    while (n_buckets < names.size() * 2 + 1) n_buckets *= 2;
+
+    Header header;
+    header.entry_count = static_cast<uint32_t>(names.size());
+    header.bucket_count = n_buckets;
+    header.buckets_offset = sizeof(Header);
+    header.strings_offset = header.buckets_offset + n_buckets * sizeof(Bucket);
+
+    std::string strings;
+    std::vector<Bucket> buckets(n_buckets);
+    std::vector<uint64_t> sizes(names.size());
+    // Relative to the first payload, which starts after the strings
+    uint64_t offset = 0;
+    std::vector<uint64_t> payload_offsets(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        std::error_code error;
+        sizes[i] = std::filesystem::file_size(root / names[i], error);
+        if (error) throw std::runtime_error("Failed to read asset " + (root / names[i]).string());
+        payload_offsets[i] = offset;
+        offset = align(offset + sizes[i], PAYLOAD_ALIGNMENT);
+    }
+    for (const auto& name: names) strings += name;
+    header.strings_size = strings.size();
+    const uint64_t payloads_offset = align(header.strings_offset + strings.size(), PAYLOAD_ALIGNMENT);
+    header.file_size = payloads_offset + offset;
+
+    uint32_t name_offset = 0;
+    for (size_t i = 0; i < names.size(); i++) {
+        const uint64_t h = hash(names[i]);
+        uint32_t slot = static_cast<uint32_t>(h) & (n_buckets - 1);
+        while (buckets[slot].hash != 0) {
+            if (buckets[slot].hash == h && strings.compare(buckets[slot].name_offset, buckets[slot].name_length,
+                                                            names[i]) == 0) {
+                throw std::runtime_error("Duplicate asset " + names[i]);
+            }
+            slot = (slot + 1) & (n_buckets - 1);
+        }
+        buckets[slot] = {h, payloads_offset + payload_offsets[i], sizes[i], name_offset,
+                         static_cast<uint32_t>(names[i].size())};
+        name_offset += static_cast<uint32_t>(names[i].size());
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    auto pad_to = [&file](uint64_t position) {
+        static const char zeros[PAYLOAD_ALIGNMENT] = {};
+        if (!file) return;  // tellp() is -1 once the stream failed
+        const uint64_t padding = position - static_cast<uint64_t>(file.tellp());
+        file.write(zeros, static_cast<std::streamsize>(padding));
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(buckets.data()), static_cast<std::streamsize>(n_buckets * sizeof(Bucket)));
+    file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+    for (size_t i = 0; i < names.size(); i++) {
+        pad_to(payloads_offset + payload_offsets[i]);
+        if (sizes[i] == 0) continue;
+        const MappedFile payload((root / names[i]).string());
+        if (payload.size() != sizes[i]) throw std::runtime_error("Asset changed while packing: " + names[i]);
+        file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    }
+    pad_to(header.file_size);
+    if (!file) throw std::runtime_error("Failed to write asset archive: " + path);
+}
+
+void AssetArchive::mount(std::unique_ptr<AssetArchive> archive) {
+    mounted_archive() = std::move(archive);
+}
+
+const AssetArchive* AssetArchive::mounted() {
+    return mounted_archive().get();
+}
+
+std::optional<Span<unsigned char>> AssetArchive::find_mounted(const std::filesystem::path& path) {
+    const AssetArchive* archive = mounted();
+    return archive ? archive->find(path) : std::nullopt;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "engine/utilities/MappedFile.hpp"
+#include "engine/utilities/Span.hpp"
+
+// Every runtime asset packed into one file, written by the asset_packer tool at build time.
+// The archive is mapped once and indexed by an open-addressing hash table of names, so
+// finding an asset is a hash and a probe or two, with no file system calls, and its
+// contents are read straight from the mapping.
+//
+// Layout: header, hash table, name strings, then the payloads, each starting on a page
+// boundary so the formats that map their files (.mesh, .tex, glTF buffers) find the same
+// alignment inside the archive. Names are paths relative to the archive's directory with
+// '/' separators, e.g. "models/sphere.mesh". Little endian like the other compiled formats.
+class AssetArchive {
+public:
+    static constexpr uint32_t MAGIC = 0x41444C47;  // "GLDA"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t PAYLOAD_ALIGNMENT = 4096;
+    // Looked for next to the executable
+    static constexpr const char* DEFAULT_NAME = "assets.pak";
+
+    struct Header {
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t entry_count = 0;
+        uint32_t bucket_count = 0;  // Power of two, at least twice the entries
+        uint64_t buckets_offset = 0;
+        uint64_t strings_offset = 0;
+        uint64_t strings_size = 0;
+        uint64_t file_size = 0;  // Catches truncated files
+    };
+
+    struct Bucket {
+        uint64_t hash = 0;  // 0 marks an empty bucket
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t name_offset = 0;
+        uint32_t name_length = 0;
+    };
+
+private:
+    MappedFile file_;
+    std::filesystem::path root_;
+    const Header* header_ = nullptr;
+    const Bucket* buckets_ = nullptr;
+    const char* strings_ = nullptr;
+
+public:
+    // Maps and validates the archive, throws if it isn't a valid archive
+    explicit AssetArchive(const std::string& path);
+
+    // Payload of the asset called `name`, nothing if the archive doesn't have it
+    std::optional<Span<unsigned char>> find_name(const std::string& name) const;
+
+    // Same for a path under the archive's directory, e.g. one built from the executable's
+    // directory like the resource loaders do
+    std::optional<Span<unsigned char>> find(const std::filesystem::path& path) const;
+
+    size_t size() const { return header_->entry_count; }
+
+    // Packs the files `names` (relative to `root`) into an archive at `path`. Throws if a
+    // file can't be read or the archive can't be written.
+    static void write(const std::filesystem::path& root, const std::vector<std::string>& names,
+                      const std::string& path);
+
+    static uint64_t hash(const std::string& name);
+
+    // The process-wide archive `MappedFile` and the loaders read from before the file
+    // system. Mounted by `Managers::initialize()` when the executable has one, before any
+    // loading starts, and never changed while loads run.
+    static void mount(std::unique_ptr<AssetArchive> archive);
+
+    static const AssetArchive* mounted();
+
+    // `mounted()->find(path)`, nothing without a mounted archive
+    static std::optional<Span<unsigned char>> find_mounted(const std::filesystem::path& path);
+};
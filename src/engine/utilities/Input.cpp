@@ -17,6 +17,7 @@ Vector3 Input::get_input_vec() {
         throw std::runtime_error("Input not initialized! Call Input::initialize() first.");
     }
     Vector3 input_vector = Vector3::ZERO();
+    if (!window) return input_vector;
     int key_state = glfwGetKey(window, GLFW_KEY_W);
     if (key_state == GLFW_PRESS) {
         input_vector.y += 1;  // UP
@@ -49,7 +50,7 @@ void Input::poll() {
 }
 
 void Input::capture_cursor() {
-    if (!cursor_captured) {
+    if (window && !cursor_captured) {
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
         if (glfwRawMouseMotionSupported()) {
             glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
@@ -11,9 +11,11 @@
 
 class Input {
 public:
+    // A null window (software backend) reports no input
     static void initialize(GLFWwindow* glfw_window) {
         Input::window = glfw_window;
         initialized = true;
+        if (!window) return;
 
         capture_cursor();
 
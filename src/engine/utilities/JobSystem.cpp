@@ -0,0 +1,107 @@
+#include "engine/utilities/JobSystem.hpp"
+
+#include <algorithm>
+
+size_t JobSystem::requested_threads = 0;
+
+static thread_local size_t tls_worker_index = 0;
+
+JobSystem::JobSystem(size_t n_threads) {
+    threads_.reserve(n_threads);
+    for (size_t i = 0; i < n_threads; i++) {
+        threads_.emplace_back(&JobSystem::worker_loop, this, i + 1);
+    }
+}
+
+JobSystem::~JobSystem() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    for (auto& thread: threads_) {
+        thread.join();
+    }
+}
+
+size_t JobSystem::current_worker_index() {
+    return tls_worker_index;
+}
+
+void JobSystem::worker_loop(size_t worker_index) {
+    tls_worker_index = worker_index;
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return stopping_ || !batch_queue_.empty() || !queue_.empty(); });
+            std::deque<std::function<void()>>& from = batch_queue_.empty() ? queue_ : batch_queue_;
+            if (stopping_ && from.empty()) return;
+            job = std::move(from.front());
+            from.pop_front();
+        }
+        job();
+    }
+}
+
+void JobSystem::enqueue(std::function<void()> job, bool batch) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        (batch ? batch_queue_ : queue_).push_back(std::move(job));
+    }
+    queue_cv_.notify_one();
+}
+
+void JobSystem::parallel_for(size_t count, size_t min_batch,
+                             const std::function<void(size_t, size_t, size_t)>& fn) {
+    if (count == 0) return;
+    min_batch = std::max<size_t>(min_batch, 1);
+
+    const size_t max_chunks = (count + min_batch - 1) / min_batch;
+    size_t n_chunks = std::min(worker_count(), max_chunks);
+    if (n_chunks <= 1) {
+        fn(0, count, current_worker_index());
+        return;
+    }
+
+    const size_t chunk_size = (count + n_chunks - 1) / n_chunks;
+    n_chunks = (count + chunk_size - 1) / chunk_size;  // Rounding can leave the last chunk empty
+
+    // Chunks are claimed from a counter instead of being queued one by one, so the caller
+    // only ever helps with its own batch. Helpers that start after every chunk is claimed
+    // return without touching `fn`, the batch itself is kept alive by them.
+    struct Batch {
+        const std::function<void(size_t, size_t, size_t)>* fn;
+        size_t count;
+        size_t chunk_size;
+        size_t n_chunks;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> remaining{0};
+
+        void run() {
+            while (true) {
+                const size_t chunk = next.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= n_chunks) return;
+                const size_t begin = chunk * chunk_size;
+                (*fn)(begin, std::min(count, begin + chunk_size), current_worker_index());
+                remaining.fetch_sub(1, std::memory_order_release);
+            }
+        }
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->fn = &fn;
+    batch->count = count;
+    batch->chunk_size = chunk_size;
+    batch->n_chunks = n_chunks;
+    batch->remaining.store(n_chunks, std::memory_order_relaxed);
+
+    for (size_t helper = 1; helper < n_chunks; helper++) {
+        enqueue([batch] { batch->run(); }, true);
+    }
+    batch->run();
+
+    // What's left is already running on other workers
+    while (batch->remaining.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool shared by the engine. Worker 0 is always the calling thread, so
+// code that keeps per-worker scratch storage should size it with `worker_count()` and
+// index it with the `worker_index` passed to its job.
+//
+// Without `initialize()` (e.g. in unit tests) the pool has no threads and every job runs
+// inline on the caller.
+class JobSystem {
+private:
+    static size_t requested_threads;
+
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> queue_;  // `submit()`ted jobs, e.g. asset loads
+    // Helpers of running `parallel_for` calls, taken before `queue_` so a frame's batches
+    // never wait behind background loads
+    std::deque<std::function<void()>> batch_queue_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    bool stopping_ = false;
+
+    void worker_loop(size_t worker_index);
+
+    void enqueue(std::function<void()> job, bool batch);
+
+public:
+    explicit JobSystem(size_t n_threads);
+
+    ~JobSystem() noexcept;
+
+    JobSystem(const JobSystem&) = delete;
+
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Must be called before the first `instance()` call to take effect
+    static void initialize(size_t n_threads) { requested_threads = n_threads; }
+
+    static JobSystem& instance() {
+        static JobSystem instance(requested_threads);
+        return instance;
+    }
+
+    // Background threads plus the calling thread
+    size_t worker_count() const { return threads_.size() + 1; }
+
+    static size_t current_worker_index();
+
+    // Splits [0, count) into contiguous ranges of at least `min_batch` items and calls
+    // `fn(begin, end, worker_index)` for each, blocking until all ranges are done. The
+    // calling thread works through ranges of this call while it waits, never other queued
+    // jobs, so it's safe to call from the frame and from inside another `parallel_for`.
+    void parallel_for(size_t count, size_t min_batch,
+                      const std::function<void(size_t, size_t, size_t)>& fn);
+
+    // Runs `fn` on a background thread, or inline without threads. Long jobs are fine,
+    // `parallel_for` callers don't pick them up while they wait.
+    template<typename Fn>
+    auto submit(Fn&& fn) -> std::future<decltype(fn())> {
+        using Result = decltype(fn());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> future = task->get_future();
+        if (threads_.empty()) {
+            (*task)();
+        } else {
+            enqueue([task] { (*task)(); }, false);
+        }
+        return future;
+    }
+};
@@ -0,0 +1,220 @@
+#include "engine/utilities/Json.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+class JsonParser {
+private:
+    static constexpr int MAX_DEPTH = 256;
+
+    std::string_view text_;
+    size_t pos_ = 0;
+
+    [[noreturn]] void fail(const char* reason) const {
+        throw std::runtime_error("Invalid JSON at offset " + std::to_string(pos_) + ": " + reason);
+    }
+
+    void skip_whitespace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool consume(char c) {
+        skip_whitespace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) fail("unexpected character");
+    }
+
+    bool consume_literal(std::string_view literal) {
+        if (text_.substr(pos_, literal.size()) != literal) return false;
+        pos_ += literal.size();
+        return true;
+    }
+
+    unsigned int parse_hex4() {
+        if (pos_ + 4 > text_.size()) fail("truncated escape");
+        unsigned int code = 0;
+        for (int i = 0; i < 4; i++) {
+            const char c = text_[pos_++];
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else fail("bad escape");
+        }
+        return code;
+    }
+
+    static void append_utf8(unsigned int code, std::string& out) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    std::string parse_string() {
+        expect('"');
+        std::string out;
+        while (true) {
+            if (pos_ >= text_.size()) fail("unterminated string");
+            const char c = text_[pos_++];
+            if (c == '"') return out;
+            if (static_cast<unsigned char>(c) < 0x20) fail("control character in string");
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+
+            if (pos_ >= text_.size()) fail("truncated escape");
+            switch (text_[pos_++]) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned int code = parse_hex4();
+                    // Characters outside the BMP come as a surrogate pair
+                    if (code >= 0xD800 && code < 0xDC00 && consume_literal("\\u")) {
+                        const unsigned int low = parse_hex4();
+                        if (low < 0xDC00 || low >= 0xE000) fail("bad surrogate pair");
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(code, out);
+                    break;
+                }
+                default:
+                    fail("bad escape");
+            }
+        }
+    }
+
+    double parse_number() {
+        // strtod also accepts hex, inf and nan, so the JSON grammar is checked first
+        const size_t start = pos_;
+        auto digits = [this] {
+            const size_t first = pos_;
+            while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') pos_++;
+            return pos_ > first;
+        };
+        if (pos_ < text_.size() && text_[pos_] == '-') pos_++;
+        if (pos_ < text_.size() && text_[pos_] == '0') {
+            pos_++;  // No leading zeros
+        } else if (!digits()) {
+            fail("bad number");
+        }
+        if (pos_ < text_.size() && text_[pos_] == '.') {
+            pos_++;
+            if (!digits()) fail("bad number");
+        }
+        if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            pos_++;
+            if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) pos_++;
+            if (!digits()) fail("bad number");
+        }
+        const std::string number(text_.substr(start, pos_ - start));
+        return std::strtod(number.c_str(), nullptr);
+    }
+
+public:
+    explicit JsonParser(std::string_view text) : text_(text) {}
+
+    void parse_value(Json& out, int depth) {
+        if (depth > MAX_DEPTH) fail("nested too deeply");
+        skip_whitespace();
+        if (pos_ >= text_.size()) fail("unexpected end");
+
+        const char c = text_[pos_];
+        if (c == '{') {
+            pos_++;
+            out.type_ = Json::Type::OBJECT;
+            if (consume('}')) return;
+            do {
+                skip_whitespace();
+                out.keys_.push_back(parse_string());
+                expect(':');
+                parse_value(out.values_.emplace_back(), depth + 1);
+            } while (consume(','));
+            expect('}');
+        } else if (c == '[') {
+            pos_++;
+            out.type_ = Json::Type::ARRAY;
+            if (consume(']')) return;
+            do {
+                parse_value(out.values_.emplace_back(), depth + 1);
+            } while (consume(','));
+            expect(']');
+        } else if (c == '"') {
+            out.type_ = Json::Type::STRING;
+            out.string_ = parse_string();
+        } else if (consume_literal("true")) {
+            out.type_ = Json::Type::BOOL;
+            out.bool_ = true;
+        } else if (consume_literal("false")) {
+            out.type_ = Json::Type::BOOL;
+        } else if (consume_literal("null")) {
+            out.type_ = Json::Type::NUL;
+        } else {
+            out.type_ = Json::Type::NUMBER;
+            out.number_ = parse_number();
+        }
+    }
+
+    void finish() {
+        skip_whitespace();
+        if (pos_ != text_.size()) fail("trailing characters");
+    }
+};
+
+Json Json::parse(std::string_view text) {
+    Json root;
+    JsonParser parser(text);
+    parser.parse_value(root, 0);
+    parser.finish();
+    return root;
+}
+
+bool Json::contains(std::string_view key) const {
+    for (const auto& k: keys_) {
+        if (k == key) return true;
+    }
+    return false;
+}
+
+const Json& Json::operator[](std::string_view key) const {
+    static const Json null;
+    // Linear, asset metadata objects only have a handful of members
+    for (size_t i = 0; i < keys_.size(); i++) {
+        if (keys_[i] == key) return values_[i];
+    }
+    return null;
+}
+
+const Json& Json::operator[](size_t index) const {
+    static const Json null;
+    if (type_ != Type::ARRAY || index >= values_.size()) return null;
+    return values_[index];
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Minimal read-only JSON document, enough for asset metadata such as glTF. Lookups never
+// throw: a missing key or index, or a lookup on the wrong type, returns a null value, so
+// optional fields read as `doc["a"]["b"].as_number(default)`.
+class Json {
+public:
+    enum class Type {
+        NUL,
+        BOOL,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT,
+    };
+
+private:
+    Type type_ = Type::NUL;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;
+    std::vector<Json> values_;       // Array elements or object members
+    std::vector<std::string> keys_;  // Object member names, parallel to `values_`
+
+    friend class JsonParser;
+
+public:
+    // Throws if `text` isn't a single valid JSON value
+    static Json parse(std::string_view text);
+
+    Type type() const { return type_; }
+    bool is_null() const { return type_ == Type::NUL; }
+    bool is_number() const { return type_ == Type::NUMBER; }
+    bool is_string() const { return type_ == Type::STRING; }
+    bool is_array() const { return type_ == Type::ARRAY; }
+    bool is_object() const { return type_ == Type::OBJECT; }
+
+    bool as_bool(bool fallback = false) const { return type_ == Type::BOOL ? bool_ : fallback; }
+    double as_number(double fallback = 0.0) const { return type_ == Type::NUMBER ? number_ : fallback; }
+    const std::string& as_string() const { return string_; }
+
+    // Elements of an array or members of an object, 0 otherwise
+    size_t size() const { return values_.size(); }
+
+    bool contains(std::string_view key) const;
+
+    const Json& operator[](std::string_view key) const;
+
+    const Json& operator[](size_t index) const;
+};
@@ -0,0 +1,45 @@
+#include "engine/utilities/MappedFile.hpp"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "engine/utilities/AssetArchive.hpp"
+
+MappedFile::MappedFile(const std::string& path) {
+    if (const auto packed = AssetArchive::find_mounted(path)) {
+        data_ = const_cast<unsigned char*>(packed->data());
+        size_ = packed->size();
+        owned_ = false;
+        return;
+    }
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Failed to open " + path);
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to stat " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+
+    // mmap rejects empty mappings, an empty file simply has no data
+    if (size_ > 0) {
+        data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data_ == MAP_FAILED) {
+            data_ = nullptr;
+            close(fd);
+            throw std::runtime_error("Failed to map " + path);
+        }
+    }
+    // The mapping keeps its own reference to the file
+    close(fd);
+}
+
+MappedFile::~MappedFile() noexcept {
+    if (data_ && owned_) munmap(data_, size_);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are read in on first touch and stay
+// file-backed, so the kernel can drop them again under memory pressure. Files packed in the
+// mounted `AssetArchive` are views of the archive's mapping instead, with no file opened.
+class MappedFile {
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    bool owned_ = true;  // False for views of the archive
+
+public:
+    // Throws if the file can't be opened or mapped
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile() noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return static_cast<const unsigned char*>(data_); }
+    size_t size() const { return size_; }
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Read-only view of a contiguous array the viewer doesn't own, e.g. a range of a mapped
+// file. Stands in for std::span, which needs C++20.
+template<class T>
+class Span {
+private:
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+
+public:
+    Span() = default;
+
+    Span(const T* data, size_t size) : data_(data), size_(size) {}
+
+    Span(const std::vector<T>& vector) : data_(vector.data()), size_(vector.size()) {}
+
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const T& operator[](size_t index) const { return data_[index]; }
+
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+};
@@ -29,6 +29,7 @@ namespace Utils {
         std::vector<float> data;
         size_t index = 0;
         bool filled = false;
+        size_t pushed = 0;
 
     public:
         explicit CircularBuffer(size_t size) : data(size, 0.0f) {
@@ -38,6 +39,7 @@ namespace Utils {
             data[index] = value;
             index = (index + 1) % data.size();
             if (index == 0) filled = true;
+            pushed++;
         }
 
         float average_value(size_t last_n = 5) const {
@@ -71,6 +73,9 @@ namespace Utils {
 
         float* buffer() { return data.data(); }
         size_t size() const { return filled ? data.size() : index; }
+
+        // Every value ever pushed, including the ones overwritten since
+        size_t total_pushed() const { return pushed; }
     };
 
     template<typename T>
@@ -10,6 +10,7 @@
 #include "engine/scene/Prefab.hpp"
 #include "engine/objects/Camera.hpp"
 #include "engine/objects/LightSource.hpp"
+#include "engine/objects/ParticleEmitter.hpp"
 #include "engine/objects/GameObject.hpp"
 #include "engine/objects/Node.hpp"
 #include "engine/application/Application.hpp"
@@ -148,10 +149,31 @@ struct ShipPrefab : Scene::Prefab {
 
         auto exhaust_light = std::make_unique<LightSource>("sphere.gltf", Vector3{1.0}, 0.4);
         exhaust_light->set_position(0, 0, 3).set_scale(0.5, 0.5, 0.5);
-        scene.add_scene_object(std::move(exhaust_light), ship_id);
+        auto exhaust_light_id = scene.add_scene_object(std::move(exhaust_light), ship_id);
+
+        ParticleEmitter::Settings exhaust;
+        exhaust.capacity = 100000;
+        exhaust.rate = 40000.0f;
+        exhaust.lifetime_min = 0.8f;
+        exhaust.lifetime_max = 2.0f;
+        exhaust.speed_min = 4.0f;
+        exhaust.speed_max = 8.0f;
+        exhaust.spread = 0.15f;
+        exhaust.drag = 1.5f;
+        exhaust.color_min = {1.0f, 0.45f, 0.15f, 0.6f};
+        exhaust.color_max = {1.0f, 0.8f, 0.4f, 1.0f};
+        exhaust.size = 0.15f;
+        scene.add_scene_object(std::make_unique<ParticleEmitter>(exhaust), exhaust_light_id);
 
         return root_id;
     }
+
+    void collect(AssetManifest &manifest) const override {
+        manifest.add_model("fighter.gltf");
+        manifest.add_model("sphere.gltf");
+        manifest.add_shader("default");
+        manifest.add_shader("light_source");
+    }
 };
 
 struct DebrisPrefab : Scene::Prefab {
@@ -176,6 +198,11 @@ struct DebrisPrefab : Scene::Prefab {
         }
         return root_id;
     }
+
+    void collect(AssetManifest& manifest) const override {
+        manifest.add_model("suzanne.gltf");
+        manifest.add_shader("default");
+    }
 };
 
 class SpaceGame : public Application {
@@ -188,9 +215,11 @@ public:
 
         auto ship_prefab = ShipPrefab();
         ship_prefab.aspect_ratio = get_aspect_ratio();
-        add_prefab_to_scene(ship_prefab);
-
         auto debris_prefab = DebrisPrefab();
+
+        // Everything loads together, the objects then find their assets ready
+        const Preloader::Report preloaded = preload({&ship_prefab, &debris_prefab});
+        add_prefab_to_scene(ship_prefab);
         add_prefab_to_scene(debris_prefab);
 
         std::vector<std::string> skybox_textures = {
@@ -1,7 +1,46 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
 #include "SpaceDemo.hpp"
 
-int main(int /*argc*/, char** argv) {
+int main(int argc, char** argv) {
+    // The backend and window have to be picked before the game creates them
+    bool headless = false;
+    int width = 0, height = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--software") == 0) {
+            Renderer::set_backend(Renderer::Backend::SOFTWARE);
+        } else if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--float-vertices") == 0) {
+            Renderer::preferred_vertex_format() = Renderer::VertexFormat::POSITION_NORMAL_UV;
+        } else if (std::strcmp(argv[i], "--no-texture-streaming") == 0) {
+            Renderer::TextureStreamer::instance().set_enabled(false);
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            std::sscanf(argv[++i], "%dx%d", &width, &height);
+        }
+    }
+    if (headless || !Renderer::uses_gl()) {
+        Application::request_headless(width, height);
+    }
+
     SpaceGame game{argv};
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--deferred") == 0) {
+            game.set_render_mode(RenderMode::DEFERRED);
+        } else if (std::strcmp(argv[i], "--dynamic-resolution") == 0) {
+            game.set_dynamic_resolution(true);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            game.set_max_frames(static_cast<unsigned int>(std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            game.set_output_image(argv[++i]);
+        } else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            game.set_frame_capture(argv[++i], Renderer::FrameRecorder::Format::PNG);
+        } else if (std::strcmp(argv[i], "--capture-raw") == 0 && i + 1 < argc) {
+            game.set_frame_capture(argv[++i], Renderer::FrameRecorder::Format::RAW);
+        }
+    }
     game.setup();
-    return game.loop();
+    return game.loop() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
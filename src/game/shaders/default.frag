@@ -2,6 +2,10 @@
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 UV;
+flat in vec3 MaterialAmbient;
+flat in vec3 MaterialDiffuse;
+flat in vec3 MaterialSpecular;
+flat in float MaterialShininess;
 
 out vec4 FragColor;
 
@@ -10,28 +14,23 @@ uniform vec3 light_pos;
 uniform float ambient_strength;
 uniform vec3 view_pos;
 
-uniform vec3 material_ambient;
-uniform vec3 material_diffuse;
-uniform vec3 material_specular;
-uniform float material_shininess;
-
 uniform bool useTexture;
 uniform sampler2D albedoTex;
 
 void main()
 {
-    vec3 ambient = material_ambient * ambient_strength;
+    vec3 ambient = MaterialAmbient * ambient_strength;
 
     vec3 norm = normalize(Normal);
     vec3 light_dir = normalize(light_pos - FragPos);
 
     float diff = max(dot(norm, light_dir), 0.0);
-    vec3 diffuse = diff * material_diffuse * light_color;
+    vec3 diffuse = diff * MaterialDiffuse * light_color;
 
     vec3 view_dir = normalize(view_pos - FragPos);
     vec3 reflect_dir = reflect(-light_dir, norm);
-    float spec = pow(max(dot(view_dir, reflect_dir), 0.0), material_shininess);
-    vec3 specular = material_specular * spec * light_color;
+    float spec = pow(max(dot(view_dir, reflect_dir), 0.0), MaterialShininess);
+    vec3 specular = MaterialSpecular * spec * light_color;
 
     vec3 tex = useTexture ? texture(albedoTex, UV).rgb : vec3(1.0, 1.0, 1.0);
 
@@ -6,15 +6,45 @@ layout (location = 2) in vec2 aUV;
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 UV;
+flat out vec3 MaterialAmbient;
+flat out vec3 MaterialDiffuse;
+flat out vec3 MaterialSpecular;
+flat out float MaterialShininess;
 
-uniform mat4 model;
 uniform mat4 view;        // TODO load from uniform buffer object
 uniform mat4 projection;  // TODO ditto
 
+// Per draw matrices and material, see Renderer::RenderQueue::DRAW_DATA_TEXELS
+uniform samplerBuffer draw_data;
+uniform int draw_offset;
+
+// Quantized meshes store unit normals octahedral-encoded in aNormal.xy
+vec3 decode_octahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+    return normalize(n);
+}
+
 void main()
 {
+    int base = (draw_offset + gl_InstanceID) * 10;
+    mat4 model = mat4(texelFetch(draw_data, base), texelFetch(draw_data, base + 1),
+                      texelFetch(draw_data, base + 2), texelFetch(draw_data, base + 3));
+    vec4 normal_column = texelFetch(draw_data, base + 4);
+    mat3 normal_matrix = mat3(normal_column.xyz, texelFetch(draw_data, base + 5).xyz,
+                              texelFetch(draw_data, base + 6).xyz);
+    vec3 normal = normal_column.w > 0.5 ? decode_octahedral(aNormal.xy) : aNormal;
+
     gl_Position = projection * view * model * vec4(aPos, 1.0);
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;  // TODO calculate on the CPU
+    Normal = normal_matrix * normal;
     UV = aUV;
+
+    MaterialAmbient = texelFetch(draw_data, base + 7).rgb;
+    MaterialDiffuse = texelFetch(draw_data, base + 8).rgb;
+    vec4 specular = texelFetch(draw_data, base + 9);
+    MaterialSpecular = specular.rgb;
+    MaterialShininess = specular.a;
 }
@@ -0,0 +1,18 @@
+#version 330 core
+in vec2 UV;
+
+out vec4 FragColor;
+
+uniform sampler2D gLight;
+uniform sampler2D gDepth;
+uniform vec2 uv_scale;  // Fraction of the G-buffer covered by the viewport
+
+void main()
+{
+    vec2 uv = UV * uv_scale;
+    float depth = texture(gDepth, uv).r;
+    if (depth == 1.0) discard;  // Background, filled by the skybox pass
+
+    FragColor = vec4(texture(gLight, uv).rgb, 1.0);
+    gl_FragDepth = depth;
+}
@@ -0,0 +1,49 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+
+uniform mat4 inv_view_projection;
+uniform vec2 screen_size;
+uniform vec3 view_pos;
+
+uniform vec3 light_pos;
+uniform vec3 light_color;
+uniform float light_range;
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / screen_size;
+    float depth = texture(gDepth, uv).r;
+    if (depth == 1.0) discard;  // Nothing was drawn here
+
+    vec4 ndc = vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 world = inv_view_projection * ndc;
+    vec3 frag_pos = world.xyz / world.w;
+
+    vec3 to_light = light_pos - frag_pos;
+    float dist = length(to_light);
+    if (dist > light_range) discard;
+
+    // Smooth window so the edge of the volume doesn't show
+    float window = clamp(1.0 - pow(dist / light_range, 4.0), 0.0, 1.0);
+    window *= window;
+
+    vec4 albedo = texture(gAlbedo, uv);
+    vec4 normal_shininess = texture(gNormal, uv);
+
+    vec3 norm = normalize(normal_shininess.xyz);
+    vec3 light_dir = to_light / dist;
+
+    float diff = max(dot(norm, light_dir), 0.0);
+    vec3 diffuse = diff * albedo.rgb * light_color;
+
+    vec3 view_dir = normalize(view_pos - frag_pos);
+    vec3 reflect_dir = reflect(-light_dir, norm);
+    float spec = pow(max(dot(view_dir, reflect_dir), 0.0), normal_shininess.w);
+    vec3 specular = albedo.a * spec * light_color;
+
+    FragColor = vec4((diffuse + specular) * window, 1.0);
+}
@@ -0,0 +1,28 @@
+#version 330 core
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 UV;
+flat in vec3 MaterialAmbient;
+flat in vec3 MaterialDiffuse;
+flat in vec3 MaterialSpecular;
+flat in float MaterialShininess;
+
+layout (location = 0) out vec4 gAlbedo;
+layout (location = 1) out vec4 gNormal;
+layout (location = 2) out vec4 gLight;
+
+uniform float ambient_strength;
+
+uniform bool useTexture;
+uniform sampler2D albedoTex;
+
+void main()
+{
+    vec3 tex = useTexture ? texture(albedoTex, UV).rgb : vec3(1.0, 1.0, 1.0);
+
+    gAlbedo = vec4(MaterialDiffuse * tex, dot(MaterialSpecular, vec3(1.0 / 3.0)));
+    gNormal = vec4(normalize(Normal), MaterialShininess);
+
+    // Seed the light accumulation target with the ambient term
+    gLight = vec4(MaterialAmbient * ambient_strength * tex, 1.0);
+}
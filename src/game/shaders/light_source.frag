@@ -1,15 +1,13 @@
 #version 330 core
-in vec3 vertexColor;
+flat in vec3 LightColor;
+flat in vec3 MaterialColor;
 
 out vec4 FragColor;
 
-uniform vec3 material_color;
-uniform vec3 light_color;
-
 void main()
 {
-    vec3 ambient = light_color;
+    vec3 ambient = LightColor;
 
-    vec3 result = ambient * material_color;
+    vec3 result = ambient * MaterialColor;
     FragColor = vec4(result, 1.0);
 }
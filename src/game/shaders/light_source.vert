@@ -2,11 +2,23 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 
-uniform mat4 model;
+flat out vec3 LightColor;
+flat out vec3 MaterialColor;
+
 uniform mat4 view;        // TODO load from uniform buffer object
 uniform mat4 projection;  // TODO ditto
 
+// Per draw matrices and color, see Renderer::RenderQueue::DRAW_DATA_TEXELS
+uniform samplerBuffer draw_data;
+uniform int draw_offset;
+
 void main()
 {
+    int base = (draw_offset + gl_InstanceID) * 10;
+    mat4 model = mat4(texelFetch(draw_data, base), texelFetch(draw_data, base + 1),
+                      texelFetch(draw_data, base + 2), texelFetch(draw_data, base + 3));
+
     gl_Position = projection * view * model * vec4(aPos, 1.0);
+    LightColor = texelFetch(draw_data, base + 7).rgb;
+    MaterialColor = texelFetch(draw_data, base + 8).rgb;
 }
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;    // Per instance
+layout (location = 1) in vec4 aColor;  // Per instance
+
+out vec2 Corner;
+out vec4 Color;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float size;
+
+void main()
+{
+    // Triangle strip quad from the vertex index, expanded in view space so it faces the camera
+    Corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    Color = aColor;
+
+    vec4 view_pos = view * vec4(aPos, 1.0);
+    view_pos.xy += Corner * size;
+    gl_Position = projection * view_pos;
+}
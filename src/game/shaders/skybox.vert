@@ -9,5 +9,7 @@ uniform mat4 view;
 void main()
 {
     TexCoords = aPos;
-    gl_Position = projection * view * vec4(aPos, 1.0);
+    vec4 pos = projection * view * vec4(aPos, 1.0);
+    // z = w puts the skybox exactly on the far plane after the perspective divide
+    gl_Position = pos.xyww;
 }
@@ -0,0 +1,14 @@
+#version 330 core
+in vec2 UV;
+
+out vec4 FragColor;
+
+uniform sampler2D scene;
+uniform vec2 uv_scale;  // Fraction of the offscreen target the scene was drawn into
+
+void main()
+{
+    // Clamp half a texel inside the drawn region so filtering doesn't pull in stale pixels
+    vec2 uv_max = uv_scale - 0.5 / vec2(textureSize(scene, 0));
+    FragColor = vec4(texture(scene, min(UV * uv_scale, uv_max)).rgb, 1.0);
+}
@@ -0,0 +1,10 @@
+#version 330 core
+out vec2 UV;
+
+void main()
+{
+    // Fullscreen triangle, no vertex buffer needed
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    UV = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,42 @@
+// Packs runtime asset directories into one archive, see engine/utilities/AssetArchive.hpp.
+// Usage: asset_packer <root> <output.pak> <directory>...
+// Directories are relative to root, and so are the names they're packed under.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "engine/utilities/AssetArchive.hpp"
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        printf("Usage: %s <root> <output.pak> <directory>...\n", argv[0]);
+        return 1;
+    }
+
+    const std::filesystem::path root = argv[1];
+    const std::string output = argv[2];
+
+    try {
+        std::vector<std::string> names;
+        for (int i = 3; i < argc; i++) {
+            for (const auto& entry: std::filesystem::recursive_directory_iterator(root / argv[i])) {
+                if (!entry.is_regular_file()) continue;
+                names.push_back(entry.path().lexically_relative(root).generic_string());
+            }
+        }
+        // Same archive for the same files, whatever order the directory listing is in
+        std::sort(names.begin(), names.end());
+        AssetArchive::write(root, names, output);
+        printf("%zu assets -> %s (%ju bytes)\n", names.size(), output.c_str(),
+               static_cast<uintmax_t>(std::filesystem::file_size(output)));
+    } catch (const std::exception& e) {
+        printf("ERROR — %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Compiles a model into the engine's .mesh format, see engine/resources/MeshFile.hpp.
+// Usage: mesh_compiler <model.gltf> [output.mesh]
+
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <string>
+
+#include "engine/resources/MeshFile.hpp"
+#include "engine/resources/Model.hpp"
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        printf("Usage: %s <model> [output.mesh]\n", argv[0]);
+        return 1;
+    }
+
+    const std::filesystem::path input = argv[1];
+    std::filesystem::path output = input;
+    output.replace_extension(".mesh");
+    if (argc == 3) output = argv[2];
+
+    try {
+        // Only the CPU half of loading, no GL context exists here
+        Model::Model model;
+        model.import(input.string());
+        Model::MeshFile::write(model, output.string());
+
+        size_t n_vertices = 0, n_indices = 0;
+        for (const auto& mesh: model.get_meshes()) {
+            n_vertices += mesh.get_vertex_data().size() / 8;
+            n_indices += mesh.get_indices().size();
+        }
+        printf("%s: %zu meshes, %zu vertices, %zu indices, %zu instances -> %s\n",
+               input.filename().string().c_str(), model.get_meshes().size(), n_vertices, n_indices,
+               model.get_instances().size(), output.string().c_str());
+        const auto& report = model.get_optimization_report();
+        for (size_t i = 0; i < report.size(); i++) {
+            printf("  mesh %zu: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", i,
+                   report[i].before.acmr, report[i].after.acmr, report[i].before.atvr, report[i].after.atvr);
+        }
+    } catch (const std::exception& e) {
+        printf("ERROR — %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
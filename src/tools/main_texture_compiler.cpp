@@ -0,0 +1,50 @@
+// Compiles an image into the engine's .tex format, see engine/resources/TextureFile.hpp.
+// Usage: texture_compiler [--linear] <image> [output.tex]
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include "engine/resources/Texture.hpp"
+#include "engine/resources/TextureFile.hpp"
+#include "engine/utilities/JobSystem.hpp"
+
+int main(int argc, char** argv) {
+    // Color textures are the default, --linear is for data such as normal maps
+    bool srgb = true;
+    int first_arg = 1;
+    if (argc > 1 && std::strcmp(argv[1], "--linear") == 0) {
+        srgb = false;
+        first_arg++;
+    }
+    if (argc - first_arg < 1 || argc - first_arg > 2) {
+        printf("Usage: %s [--linear] <image> [output.tex]\n", argv[0]);
+        return 1;
+    }
+
+    const std::filesystem::path input = argv[first_arg];
+    std::filesystem::path output = input;
+    output.replace_extension(".tex");
+    if (argc - first_arg == 2) output = argv[first_arg + 1];
+
+    JobSystem::initialize(std::thread::hardware_concurrency());
+    try {
+        // Only the CPU half of loading, no GL context exists here
+        Texture texture(srgb);
+        texture.decode(input.string());
+        TextureFile::write(texture.pixels.data(), texture.width, texture.height, texture.channels, srgb,
+                           output.string());
+
+        const TextureFile::Image compiled(output.string());
+        printf("%s: %dx%d, %d channels, %zu levels, %zu -> %zu bytes -> %s\n",
+               input.filename().string().c_str(), texture.width, texture.height, texture.channels,
+               compiled.get_levels().size(), texture.pixels.size(), compiled.get_size(), output.string().c_str());
+    } catch (const std::exception& e) {
+        printf("ERROR — %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/engine/utilities/AssetArchive.hpp"
+#include "../src/engine/utilities/MappedFile.hpp"
+
+namespace {
+    // A directory with a few assets laid out like the runtime directory
+    std::filesystem::path make_assets() {
+        const std::filesystem::path root = std::filesystem::path(testing::TempDir()) / "asset_archive_test";
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "shaders");
+        std::filesystem::create_directories(root / "models");
+        std::ofstream(root / "shaders/default.vert", std::ios::binary) << "#version 330 core\n";
+        std::ofstream(root / "models/sphere.mesh", std::ios::binary) << std::string(5000, 'm');
+        std::ofstream(root / "models/empty.bin", std::ios::binary);
+        return root;
+    }
+
+    const std::vector<std::string> NAMES = {"shaders/default.vert", "models/sphere.mesh", "models/empty.bin"};
+
+    std::string as_string(const Span<unsigned char>& span) {
+        return std::string(reinterpret_cast<const char*>(span.data()), span.size());
+    }
+}
+
+TEST(AssetArchiveTest, WriteRoundTrips) {
+    const auto root = make_assets();
+    const std::string path = (root / "assets.pak").string();
+    AssetArchive::write(root, NAMES, path);
+
+    const AssetArchive archive(path);
+    EXPECT_EQ(archive.size(), 3u);
+
+    const auto shader = archive.find_name("shaders/default.vert");
+    ASSERT_TRUE(shader.has_value());
+    EXPECT_EQ(as_string(*shader), "#version 330 core\n");
+
+    const auto mesh = archive.find(root / "models" / "." / "sphere.mesh");
+    ASSERT_TRUE(mesh.has_value());
+    EXPECT_EQ(as_string(*mesh), std::string(5000, 'm'));
+
+    const auto empty = archive.find_name("models/empty.bin");
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_EQ(empty->size(), 0u);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(AssetArchiveTest, PayloadsArePageAligned) {
+    const auto root = make_assets();
+    const std::string path = (root / "assets.pak").string();
+    AssetArchive::write(root, NAMES, path);
+
+    const AssetArchive archive(path);
+    const MappedFile file(path);
+    for (const auto& name: NAMES) {
+        const auto payload = archive.find_name(name);
+        ASSERT_TRUE(payload.has_value());
+        // Offsets within the file, the mapping itself is page aligned
+        const size_t offset = payload->data() - archive.find_name(NAMES[0])->data();
+        EXPECT_EQ(offset % AssetArchive::PAYLOAD_ALIGNMENT, 0u) << name;
+    }
+    EXPECT_EQ(file.size() % AssetArchive::PAYLOAD_ALIGNMENT, 0u);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(AssetArchiveTest, MissingNamesAreNotFound) {
+    const auto root = make_assets();
+    const std::string path = (root / "assets.pak").string();
+    AssetArchive::write(root, NAMES, path);
+
+    const AssetArchive archive(path);
+    EXPECT_FALSE(archive.find_name("shaders/missing.frag").has_value());
+    EXPECT_FALSE(archive.find_name("default.vert").has_value());
+    EXPECT_FALSE(archive.find("/somewhere/else/shaders/default.vert").has_value());
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(AssetArchiveTest, RejectsCorruptFiles) {
+    const auto root = make_assets();
+    const std::string path = (root / "assets.pak").string();
+    AssetArchive::write(root, NAMES, path);
+    std::ifstream in(path, std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    auto bad_magic = bytes;
+    bad_magic[0] = 0;
+    auto truncated = bytes;
+    truncated.resize(bytes.size() - 100);
+    auto bad_entry = bytes;
+    // First bucket's payload size, pointed past the end of the file in every bucket
+    for (size_t bucket = sizeof(AssetArchive::Header); bucket < sizeof(AssetArchive::Header) + 8 * sizeof(AssetArchive::Bucket);
+         bucket += sizeof(AssetArchive::Bucket)) {
+        bad_entry[bucket + offsetof(AssetArchive::Bucket, size) + 7] = 0x7F;
+    }
+
+    for (const auto& corrupt: {bad_magic, truncated, bad_entry}) {
+        const std::string corrupt_path = (root / "corrupt.pak").string();
+        std::ofstream(corrupt_path, std::ios::binary) << corrupt;
+        EXPECT_THROW(AssetArchive archive(corrupt_path), std::runtime_error);
+    }
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(AssetArchiveTest, MappedFilesReadFromTheMountedArchive) {
+    const auto root = make_assets();
+    const std::string path = (root / "assets.pak").string();
+    AssetArchive::write(root, NAMES, path);
+    AssetArchive::mount(std::make_unique<AssetArchive>(path));
+
+    // Removed from disk, so this can only come from the archive
+    std::filesystem::remove(root / "models/sphere.mesh");
+    {
+        const MappedFile file((root / "models/sphere.mesh").string());
+        EXPECT_EQ(file.size(), 5000u);
+        EXPECT_EQ(file.data(), AssetArchive::mounted()->find_name("models/sphere.mesh")->data());
+    }
+    EXPECT_THROW(MappedFile((root / "models/missing.mesh").string()), std::runtime_error);
+
+    AssetArchive::mount(nullptr);
+    EXPECT_THROW(MappedFile((root / "models/sphere.mesh").string()), std::runtime_error);
+    std::filesystem::remove_all(root);
+}
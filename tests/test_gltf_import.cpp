@@ -0,0 +1,152 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/engine/resources/Model.hpp"
+#include "../src/engine/utilities/Json.hpp"
+
+TEST(JsonTest, ParsesNestedValues) {
+    const Json json = Json::parse(R"({"a": [1, 2.5e1, -3], "b": {"c": "x\"é"}, "d": true, "e": null})");
+
+    EXPECT_TRUE(json.is_object());
+    EXPECT_EQ(json["a"].size(), 3u);
+    EXPECT_DOUBLE_EQ(json["a"][1].as_number(), 25.0);
+    EXPECT_DOUBLE_EQ(json["a"][2].as_number(), -3.0);
+    EXPECT_EQ(json["b"]["c"].as_string(), "x\"\xc3\xa9");
+    EXPECT_TRUE(json["d"].as_bool());
+    EXPECT_TRUE(json["e"].is_null());
+}
+
+TEST(JsonTest, MissingValuesAreNull) {
+    const Json json = Json::parse(R"({"a": [1]})");
+
+    EXPECT_TRUE(json["missing"].is_null());
+    EXPECT_TRUE(json["a"][5].is_null());
+    EXPECT_TRUE(json["a"]["not an object"].is_null());
+    EXPECT_DOUBLE_EQ(json["missing"]["deeper"].as_number(7.0), 7.0);
+}
+
+TEST(JsonTest, RejectsMalformedText) {
+    EXPECT_THROW(Json::parse("{\"a\": }"), std::runtime_error);
+    EXPECT_THROW(Json::parse("[1, 2"), std::runtime_error);
+    EXPECT_THROW(Json::parse("01"), std::runtime_error);
+    EXPECT_THROW(Json::parse("{} {}"), std::runtime_error);
+}
+
+// A quad as two triangles with 16-bit indices and a texture, placed by a child node
+// rotated a quarter turn around z under a translated parent
+static std::string write_quad(const std::string& name, const std::string& primitive_extra = "") {
+    const float positions[] = {0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0};
+    const float normals[] = {0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1};
+    const float uvs[] = {0, 0, 1, 0, 1, 0.25f, 0, 1};
+    const uint16_t indices[] = {0, 1, 2, 0, 2, 3};
+
+    const std::string dir = testing::TempDir();
+    std::ofstream bin(dir + name + ".bin", std::ios::binary | std::ios::trunc);
+    bin.write(reinterpret_cast<const char*>(positions), sizeof(positions));
+    bin.write(reinterpret_cast<const char*>(normals), sizeof(normals));
+    bin.write(reinterpret_cast<const char*>(uvs), sizeof(uvs));
+    bin.write(reinterpret_cast<const char*>(indices), sizeof(indices));
+    bin.close();
+
+    std::ofstream gltf(dir + name + ".gltf", std::ios::trunc);
+    gltf << R"({
+        "asset": {"version": "2.0"},
+        "scene": 0,
+        "scenes": [{"nodes": [0]}],
+        "nodes": [
+            {"translation": [5, 0, 0], "children": [1]},
+            {"rotation": [0, 0, 0.70710678, 0.70710678], "mesh": 0}
+        ],
+        "meshes": [{"primitives": [{
+            "attributes": {"POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2},
+            "indices": 3, "material": 0)" << primitive_extra << R"(
+        }]}],
+        "materials": [{"pbrMetallicRoughness": {
+            "baseColorFactor": [0.5, 0.25, 1, 1],
+            "roughnessFactor": 0.5,
+            "baseColorTexture": {"index": 0}
+        }}],
+        "textures": [{"source": 0}],
+        "images": [{"uri": "textures/quad_color.png"}],
+        "buffers": [{"uri": ")" << name << R"(.bin", "byteLength": 140}],
+        "bufferViews": [
+            {"buffer": 0, "byteOffset": 0, "byteLength": 48},
+            {"buffer": 0, "byteOffset": 48, "byteLength": 48},
+            {"buffer": 0, "byteOffset": 96, "byteLength": 32},
+            {"buffer": 0, "byteOffset": 128, "byteLength": 12}
+        ],
+        "accessors": [
+            {"bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3"},
+            {"bufferView": 1, "componentType": 5126, "count": 4, "type": "VEC3"},
+            {"bufferView": 2, "componentType": 5126, "count": 4, "type": "VEC2"},
+            {"bufferView": 3, "componentType": 5123, "count": 6, "type": "SCALAR"}
+        ]
+    })";
+    return dir + name + ".gltf";
+}
+
+TEST(GltfImportTest, ImportsInterleavedMesh) {
+    const std::string path = write_quad("quad");
+
+    Model::Model model;
+    model.import(path);
+
+    ASSERT_EQ(model.get_meshes().size(), 1u);
+    const Model::Mesh& mesh = model.get_meshes()[0];
+    ASSERT_EQ(mesh.get_vertex_data().size(), 32u);
+    // Vertex 2: position, normal, then UV with V flipped
+    const float expected[] = {1, 1, 0, 0, 0, 1, 1, 0.75f};
+    for (int i = 0; i < 8; i++) {
+        EXPECT_FLOAT_EQ(mesh.get_vertex_data()[16 + i], expected[i]) << "component " << i;
+    }
+    ASSERT_EQ(mesh.get_indices().size(), 6u);
+    EXPECT_EQ(mesh.get_indices()[5], 3u);
+
+    ASSERT_EQ(model.get_materials().size(), 1u);
+    const Model::Material& material = model.get_materials()[0];
+    EXPECT_DOUBLE_EQ(material.get_diffuse().y, 0.25);
+    EXPECT_FLOAT_EQ(material.get_shininess(), 250.0f);
+    EXPECT_EQ(material.get_texture_name(), "quad_color.png");
+}
+
+TEST(GltfImportTest, ComposesNodeTransforms) {
+    const std::string path = write_quad("quad");
+
+    Model::Model model;
+    model.import(path);
+
+    ASSERT_EQ(model.get_instances().size(), 1u);
+    const glm::vec4 corner = model.get_instances()[0].transform * glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+    EXPECT_NEAR(corner.x, 5.0f, 1e-5f);
+    EXPECT_NEAR(corner.y, 1.0f, 1e-5f);
+    EXPECT_NEAR(model.get_bounds().min.x, 4.0f, 1e-5f);
+    EXPECT_NEAR(model.get_bounds().max.y, 1.0f, 1e-5f);
+
+    // Mesh space, set at import for streamed texture levels
+    const glm::vec4& sphere = model.get_meshes()[0].get_bounding_sphere();
+    EXPECT_NEAR(sphere.x, 0.5f, 1e-5f);
+    EXPECT_NEAR(sphere.y, 0.5f, 1e-5f);
+    EXPECT_NEAR(sphere.w, std::sqrt(0.5f), 1e-5f);
+}
+
+TEST(GltfImportTest, RejectsOutOfRangeData) {
+    // Index accessor reaching past its buffer view
+    const std::string path = write_quad("bad_quad");
+    std::string text;
+    {
+        std::ifstream in(path);
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    text.replace(text.find("\"count\": 6"), 10, "\"count\": 9");
+    std::ofstream(path, std::ios::trunc) << text;
+
+    Model::Model model;
+    EXPECT_THROW(model.import(path), std::runtime_error);
+}
@@ -0,0 +1,96 @@
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/engine/resources/ImageDecoder.hpp"
+#include "../src/engine/utilities/JobSystem.hpp"
+
+// A binary PPM, the simplest format stb_image reads. Row y is filled with y, column x with x.
+static std::string write_ppm(const std::string& name, int width, int height) {
+    const std::string path = testing::TempDir() + name;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const unsigned char texel[3] = {static_cast<unsigned char>(x), static_cast<unsigned char>(y), 7};
+            file.write(reinterpret_cast<const char*>(texel), 3);
+        }
+    }
+    return path;
+}
+
+TEST(ImageDecoderTest, FlipsRowsWhenAsked) {
+    const std::string path = write_ppm("decoder.ppm", 4, 3);
+
+    const ImageDecoder::Image top_down = ImageDecoder::decode(path, false);
+    ASSERT_EQ(top_down.width, 4);
+    ASSERT_EQ(top_down.height, 3);
+    ASSERT_EQ(top_down.channels, 3);
+    ASSERT_EQ(top_down.pixels.size(), 36u);
+    EXPECT_EQ(top_down.pixels[1], 0);
+    EXPECT_EQ(top_down.pixels[2 * 12 + 3 * 3], 3);
+
+    const ImageDecoder::Image bottom_up = ImageDecoder::decode(path, true);
+    ASSERT_EQ(bottom_up.pixels.size(), 36u);
+    // First row is the file's last
+    EXPECT_EQ(bottom_up.pixels[1], 2);
+    EXPECT_EQ(bottom_up.pixels[2 * 12 + 1], 0);
+    EXPECT_EQ(bottom_up.pixels[2 * 12 + 3 * 3], 3);
+
+    const ImageDecoder::Image rgba = ImageDecoder::decode(path, false, 4);
+    EXPECT_EQ(rgba.channels, 4);
+    EXPECT_EQ(rgba.pixels.size(), 48u);
+    EXPECT_EQ(rgba.pixels[3], 255);
+    std::remove(path.c_str());
+}
+
+TEST(ImageDecoderTest, MissingFilesThrow) {
+    EXPECT_THROW(ImageDecoder::decode(testing::TempDir() + "missing.png", true), std::runtime_error);
+}
+
+TEST(ImageDecoderTest, ConcurrentDecodesKeepTheirOwnOrientation) {
+    // Flipped and unflipped decodes interleaved on several threads, which races with
+    // stb's global flip setting
+    const std::string path = write_ppm("concurrent.ppm", 16, 16);
+    JobSystem jobs(4);
+    std::vector<ImageDecoder::Image> images(64);
+
+    jobs.parallel_for(images.size(), 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) images[i] = ImageDecoder::decode(path, i % 2 == 1);
+    });
+
+    for (size_t i = 0; i < images.size(); i++) {
+        ASSERT_EQ(images[i].pixels.size(), 16u * 16u * 3u);
+        EXPECT_EQ(images[i].pixels[1], i % 2 == 1 ? 15 : 0) << "image " << i;
+    }
+    std::remove(path.c_str());
+}
+
+TEST(ImageDecoderTest, ReleasedBuffersAreReused) {
+    ImageDecoder::clear_pool();
+    std::vector<unsigned char> buffer = ImageDecoder::acquire_buffer(1000);
+    const unsigned char* data = buffer.data();
+
+    ImageDecoder::release_buffer(std::move(buffer));
+    EXPECT_GE(ImageDecoder::pooled_bytes(), 1000u);
+
+    // Too large for the pooled buffer, a new one
+    const std::vector<unsigned char> large = ImageDecoder::acquire_buffer(5000);
+    EXPECT_EQ(large.size(), 5000u);
+    // Far smaller than the pooled buffer, which stays for a closer fit
+    const std::vector<unsigned char> small = ImageDecoder::acquire_buffer(400);
+    EXPECT_NE(small.data(), data);
+    EXPECT_GE(ImageDecoder::pooled_bytes(), 1000u);
+    const std::vector<unsigned char> reused = ImageDecoder::acquire_buffer(800);
+    EXPECT_EQ(reused.data(), data);
+    EXPECT_EQ(reused.size(), 800u);
+    EXPECT_EQ(ImageDecoder::pooled_bytes(), 0u);
+
+    // Beyond the pool's limit, freed instead
+    ImageDecoder::release_buffer(std::vector<unsigned char>(ImageDecoder::MAX_POOLED_BYTES + 1));
+    EXPECT_EQ(ImageDecoder::pooled_bytes(), 0u);
+}
@@ -0,0 +1,98 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/engine/utilities/JobSystem.hpp"
+
+TEST(JobSystemTest, ParallelForVisitsEveryIndexOnce) {
+    JobSystem jobs(3);
+    std::vector<std::atomic<int>> visits(1000);
+
+    jobs.parallel_for(visits.size(), 10, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) visits[i]++;
+    });
+
+    for (const auto& count: visits) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+TEST(JobSystemTest, WorkerIndicesAreInRange) {
+    JobSystem jobs(4);
+    std::atomic<bool> in_range{true};
+
+    jobs.parallel_for(500, 1, [&](size_t, size_t, size_t worker) {
+        if (worker >= jobs.worker_count()) in_range = false;
+    });
+
+    EXPECT_TRUE(in_range.load());
+}
+
+TEST(JobSystemTest, RunsInlineWithoutThreads) {
+    JobSystem jobs(0);
+    EXPECT_EQ(jobs.worker_count(), 1u);
+
+    size_t calls = 0;
+    jobs.parallel_for(100, 1, [&](size_t begin, size_t end, size_t worker) {
+        EXPECT_EQ(begin, 0u);
+        EXPECT_EQ(end, 100u);
+        EXPECT_EQ(worker, 0u);
+        calls++;
+    });
+    EXPECT_EQ(calls, 1u);
+}
+
+TEST(JobSystemTest, SubmitReturnsResult) {
+    JobSystem jobs(2);
+    auto future = jobs.submit([] { return 42; });
+    EXPECT_EQ(future.get(), 42);
+}
+
+TEST(JobSystemTest, NestedParallelForVisitsEveryIndexOnce) {
+    JobSystem jobs(3);
+    std::vector<std::atomic<int>> visits(64 * 64);
+
+    jobs.parallel_for(64, 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t row = begin; row < end; row++) {
+            jobs.parallel_for(64, 4, [&](size_t inner_begin, size_t inner_end, size_t) {
+                for (size_t i = inner_begin; i < inner_end; i++) visits[row * 64 + i]++;
+            });
+        }
+    });
+
+    for (const auto& count: visits) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+TEST(JobSystemTest, ParallelForCallerSkipsSubmittedJobs) {
+    JobSystem jobs(1);
+    // Occupies the only background thread, so the next job stays queued
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> blocking{false};
+    auto blocker = jobs.submit([&] {
+        blocking = true;
+        released.wait();
+    });
+    while (!blocking) std::this_thread::yield();
+
+    // Stands in for a long asset load queued ahead of the frame's work
+    auto load = jobs.submit([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return std::this_thread::get_id();
+    });
+
+    size_t visited = 0;
+    jobs.parallel_for(100, 1, [&](size_t begin, size_t end, size_t) { visited += end - begin; });
+    EXPECT_EQ(visited, 100u);
+    EXPECT_EQ(load.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+    release.set_value();
+    blocker.get();
+    EXPECT_NE(load.get(), std::this_thread::get_id());
+}
@@ -0,0 +1,135 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/engine/resources/MeshFile.hpp"
+#include "../src/engine/resources/Model.hpp"
+
+using namespace Model::MeshFile;
+
+// One textured triangle, instanced twice
+static std::vector<unsigned char> triangle_file() {
+    const float vertices[] = {
+        0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+        0.0f, 2.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
+    };
+    const unsigned int indices[] = {0, 1, 2};
+    const std::string strings = "brick.png";
+
+    Header header;
+    header.mesh_count = 1;
+    header.material_count = 1;
+    header.instance_count = 2;
+    header.string_table_size = static_cast<uint32_t>(strings.size());
+    header.meshes_offset = 96;
+    header.materials_offset = 160;
+    header.instances_offset = 208;
+    header.strings_offset = 368;
+    header.bounds_max[0] = 6.0f;
+    header.bounds_max[1] = 2.0f;
+    header.file_size = 528;
+
+    MeshRecord mesh;
+    mesh.vertex_offset = 384;
+    mesh.index_offset = 512;
+    mesh.vertex_count = 3;
+    mesh.index_count = 3;
+
+    MaterialRecord material;
+    material.diffuse[0] = 0.5f;
+    material.shininess = 32.0f;
+    material.texture_name_length = static_cast<uint32_t>(strings.size());
+
+    InstanceRecord instances[2];
+    for (auto& instance: instances) {
+        for (int i = 0; i < 4; i++) instance.transform[i * 5] = 1.0f;
+    }
+    instances[1].transform[12] = 5.0f;
+
+    std::vector<unsigned char> bytes(header.file_size, 0);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + header.meshes_offset, &mesh, sizeof(mesh));
+    std::memcpy(bytes.data() + header.materials_offset, &material, sizeof(material));
+    std::memcpy(bytes.data() + header.instances_offset, instances, sizeof(instances));
+    std::memcpy(bytes.data() + header.strings_offset, strings.data(), strings.size());
+    std::memcpy(bytes.data() + mesh.vertex_offset, vertices, sizeof(vertices));
+    std::memcpy(bytes.data() + mesh.index_offset, indices, sizeof(indices));
+    return bytes;
+}
+
+static std::string write_temp(const std::string& name, const std::vector<unsigned char>& bytes) {
+    const std::string path = testing::TempDir() + name;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return path;
+}
+
+static void expect_triangle_model(const Model::Model& model) {
+    ASSERT_EQ(model.get_meshes().size(), 1u);
+    const Model::Mesh& mesh = model.get_meshes()[0];
+    ASSERT_EQ(mesh.get_vertex_data().size(), 24u);
+    EXPECT_FLOAT_EQ(mesh.get_vertex_data()[17], 2.0f);
+    ASSERT_EQ(mesh.get_indices().size(), 3u);
+    EXPECT_EQ(mesh.get_indices()[2], 2u);
+
+    ASSERT_EQ(model.get_materials().size(), 1u);
+    EXPECT_DOUBLE_EQ(model.get_materials()[0].get_diffuse().x, 0.5);
+    EXPECT_FLOAT_EQ(model.get_materials()[0].get_shininess(), 32.0f);
+    EXPECT_EQ(model.get_materials()[0].get_texture_name(), "brick.png");
+
+    ASSERT_EQ(model.get_instances().size(), 2u);
+    EXPECT_FLOAT_EQ(model.get_instances()[1].transform[3][0], 5.0f);
+    EXPECT_FLOAT_EQ(model.get_bounds().max.x, 6.0f);
+}
+
+TEST(MeshFileTest, ImportMapsMeshData) {
+    const std::string path = write_temp("triangle.mesh", triangle_file());
+
+    Model::Model model;
+    model.import(path);
+
+    expect_triangle_model(model);
+    std::remove(path.c_str());
+}
+
+TEST(MeshFileTest, WriteRoundTrips) {
+    const std::string path = write_temp("triangle.mesh", triangle_file());
+    const std::string copy_path = testing::TempDir() + "triangle_copy.mesh";
+
+    Model::Model model;
+    model.import(path);
+    write(model, copy_path);
+
+    Model::Model copy;
+    copy.import(copy_path);
+
+    expect_triangle_model(copy);
+    std::remove(path.c_str());
+    std::remove(copy_path.c_str());
+}
+
+TEST(MeshFileTest, RejectsCorruptFiles) {
+    auto bad_magic = triangle_file();
+    bad_magic[0] = 0;
+    auto truncated = triangle_file();
+    truncated.resize(400);
+    auto bad_index = triangle_file();
+    bad_index[96 + offsetof(MeshRecord, index_count)] = 200;
+    auto index_past_vertices = triangle_file();
+    index_past_vertices[512 + 2 * sizeof(unsigned int)] = 3;
+    auto no_vertices = triangle_file();
+    no_vertices[96 + offsetof(MeshRecord, vertex_count)] = 0;
+
+    for (const auto& bytes: {bad_magic, truncated, bad_index, index_past_vertices, no_vertices}) {
+        const std::string path = write_temp("corrupt.mesh", bytes);
+        Model::Model model;
+        EXPECT_THROW(model.import(path), std::runtime_error);
+        std::remove(path.c_str());
+    }
+}
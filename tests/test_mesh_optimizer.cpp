@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include "../src/engine/resources/MeshOptimizer.hpp"
+
+namespace {
+    // `size` x `size` quads on the XY plane, Pos vec3; Norm vec3; UV vec2, triangles shuffled
+    void make_grid(int size, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+        for (int y = 0; y <= size; y++) {
+            for (int x = 0; x <= size; x++) {
+                vertices.insert(vertices.end(), {static_cast<float>(x), static_cast<float>(y), 0.0f,
+                                                 0.0f, 0.0f, 1.0f,
+                                                 static_cast<float>(x) / size, static_cast<float>(y) / size});
+            }
+        }
+        std::vector<std::array<unsigned int, 3>> triangles;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                const unsigned int v = y * (size + 1) + x;
+                triangles.push_back({v, v + 1, v + size + 2});
+                triangles.push_back({v, v + size + 2, v + size + 1});
+            }
+        }
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937(7));
+        for (const auto& triangle: triangles) indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+
+    // Every triangle as its three positions, rotated to a canonical start so winding is kept
+    std::vector<std::array<float, 9>> triangle_set(const std::vector<float>& vertices,
+                                                   const std::vector<unsigned int>& indices) {
+        std::vector<std::array<float, 9>> triangles;
+        for (size_t t = 0; t + 3 <= indices.size(); t += 3) {
+            std::array<std::array<float, 3>, 3> corners;
+            for (int k = 0; k < 3; k++) {
+                for (int axis = 0; axis < 3; axis++) corners[k][axis] = vertices[indices[t + k] * 8 + axis];
+            }
+            const size_t first = std::min_element(corners.begin(), corners.end()) - corners.begin();
+            std::array<float, 9> triangle;
+            for (int k = 0; k < 3; k++) {
+                for (int axis = 0; axis < 3; axis++) triangle[k * 3 + axis] = corners[(first + k) % 3][axis];
+            }
+            triangles.push_back(triangle);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+}
+
+TEST(MeshOptimizerTest, AnalyzeCountsFifoMisses) {
+    // Two triangles sharing an edge: 4 misses over 2 triangles and 4 vertices
+    const unsigned int indices[] = {0, 1, 2, 2, 1, 3};
+    const MeshOptimizer::CacheStats stats = MeshOptimizer::analyze_vertex_cache(indices, 6, 4);
+    EXPECT_FLOAT_EQ(stats.acmr, 2.0f);
+    EXPECT_FLOAT_EQ(stats.atvr, 1.0f);
+
+    // With a 3 entry cache vertex 0 is evicted by the time it comes back
+    const unsigned int evicting[] = {0, 1, 2, 3, 4, 5, 0, 4, 5};
+    EXPECT_FLOAT_EQ(MeshOptimizer::analyze_vertex_cache(evicting, 9, 6, 3).acmr, 7.0f / 3.0f);
+}
+
+TEST(MeshOptimizerTest, VertexCacheOrderBeatsShuffledOrder) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    make_grid(32, vertices, indices);
+    const size_t n_vertices = vertices.size() / 8;
+
+    const float before = MeshOptimizer::analyze_vertex_cache(indices.data(), indices.size(), n_vertices).acmr;
+    MeshOptimizer::optimize_vertex_cache(indices.data(), indices.size(), n_vertices);
+    const float after = MeshOptimizer::analyze_vertex_cache(indices.data(), indices.size(), n_vertices).acmr;
+
+    EXPECT_GT(before, 2.0f);
+    // A regular grid has 0.5 vertices per triangle at best, a 16 entry FIFO gets close-ish
+    EXPECT_LT(after, 0.8f);
+}
+
+TEST(MeshOptimizerTest, OptimizeKeepsTrianglesAndReordersVertices) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    make_grid(20, vertices, indices);
+    // An unreferenced vertex, dropped by the fetch pass
+    vertices.insert(vertices.end(), {100.0f, 100.0f, 100.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f});
+    const auto original = triangle_set(vertices, indices);
+    const size_t n_indices = indices.size();
+
+    const MeshOptimizer::Report report = MeshOptimizer::optimize(vertices, indices);
+
+    EXPECT_LT(report.after.acmr, report.before.acmr);
+    EXPECT_LT(report.after.atvr, report.before.atvr);
+    ASSERT_EQ(indices.size(), n_indices);
+    EXPECT_EQ(vertices.size(), 21u * 21u * 8u);
+    EXPECT_EQ(triangle_set(vertices, indices), original);
+
+    // Vertices are numbered in first use order
+    unsigned int next = 0;
+    for (const unsigned int index: indices) {
+        ASSERT_LE(index, next);
+        if (index == next) next++;
+    }
+}
+
+TEST(MeshOptimizerTest, OverdrawDrawsOutwardFacingClustersFirst) {
+    // Two disjoint quads facing +Z, one at the front of the mesh and one at the back, so
+    // each is its own cluster. The front one is listed second but should be drawn first.
+    const std::vector<float> vertices = {
+        0, 0, -5,  0, 0, 1,  0, 0,
+        1, 0, -5,  0, 0, 1,  0, 0,
+        1, 1, -5,  0, 0, 1,  0, 0,
+        0, 1, -5,  0, 0, 1,  0, 0,
+        0, 0, 5,   0, 0, 1,  0, 0,
+        1, 0, 5,   0, 0, 1,  0, 0,
+        1, 1, 5,   0, 0, 1,  0, 0,
+        0, 1, 5,   0, 0, 1,  0, 0,
+    };
+    std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7};
+
+    MeshOptimizer::optimize_overdraw(indices.data(), indices.size(), vertices.data(), 8, 8);
+
+    const std::vector<unsigned int> expected = {4, 5, 6, 4, 6, 7, 0, 1, 2, 0, 2, 3};
+    EXPECT_EQ(indices, expected);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../src/engine/particles/ParticlePool.hpp"
+#include "../src/engine/objects/ParticleEmitter.hpp"
+
+using Particles::ParticlePool;
+
+namespace {
+    ParticlePool::Spawn particle(float lifetime, glm::vec3 velocity = glm::vec3(0.0f)) {
+        return {glm::vec3(0.0f), velocity, glm::vec4(1.0f), lifetime};
+    }
+}
+
+TEST(ParticlePoolTest, SpawnStopsAtCapacity) {
+    ParticlePool pool(5);
+    for (int i = 0; i < 8; i++) {
+        pool.spawn(particle(1.0f));
+    }
+
+    EXPECT_EQ(pool.size(), 5u);
+    EXPECT_EQ(pool.get_dropped(), 3u);
+}
+
+TEST(ParticlePoolTest, IntegratesVelocityThenPosition) {
+    ParticlePool pool(7);  // Not a multiple of 4, the last group is partly padding
+    for (int i = 0; i < 7; i++) {
+        pool.spawn(particle(10.0f, glm::vec3(1.0f, 0.0f, 0.0f)));
+    }
+
+    pool.simulate(0.5f, glm::vec3(0.0f, -2.0f, 0.0f), 0.0f);
+
+    for (size_t i = 0; i < pool.size(); i++) {
+        const glm::vec3 velocity = pool.get_velocity(i);
+        const glm::vec3 position = pool.get_position(i);
+        EXPECT_FLOAT_EQ(velocity.x, 1.0f);
+        EXPECT_FLOAT_EQ(velocity.y, -1.0f);
+        EXPECT_FLOAT_EQ(position.x, 0.5f);
+        EXPECT_FLOAT_EQ(position.y, -0.5f);
+        EXPECT_FLOAT_EQ(pool.get_life(i), 9.5f);
+    }
+}
+
+TEST(ParticlePoolTest, ExpiredParticlesAreRemoved) {
+    ParticlePool pool(10);
+    for (int i = 0; i < 10; i++) {
+        pool.spawn(particle(i % 2 ? 2.0f : 0.5f));
+    }
+
+    pool.simulate(1.0f, glm::vec3(0.0f), 0.0f);
+
+    ASSERT_EQ(pool.size(), 5u);
+    for (size_t i = 0; i < pool.size(); i++) {
+        EXPECT_FLOAT_EQ(pool.get_life(i), 1.0f);
+    }
+
+    // Freed slots are reused
+    pool.spawn(particle(1.0f));
+    EXPECT_EQ(pool.size(), 6u);
+    EXPECT_EQ(pool.get_dropped(), 0u);
+}
+
+TEST(ParticlePoolTest, InstancesFadeWithLife) {
+    ParticlePool pool(1);
+    pool.spawn(particle(2.0f));
+    pool.simulate(1.0f, glm::vec3(0.0f), 0.0f);
+
+    std::vector<ParticlePool::Instance> instances(pool.size());
+    pool.write_instances(instances.data());
+
+    EXPECT_EQ(instances[0].color & 0xFFFFFFu, 0xFFFFFFu);
+    EXPECT_EQ(instances[0].color >> 24, 128u);
+}
+
+TEST(ParticleEmitterTest, SpawnsAtRate) {
+    ParticleEmitter::Settings settings;
+    settings.rate = 100.0f;
+    settings.lifetime_min = settings.lifetime_max = 10.0f;
+    ParticleEmitter emitter(settings);
+
+    emitter.update(0.25);
+    EXPECT_EQ(emitter.get_pool().size(), 25u);
+
+    // Fractional particles carry over to the next update
+    emitter.update(0.005);
+    emitter.update(0.005);
+    EXPECT_EQ(emitter.get_pool().size(), 26u);
+
+    emitter.set_emitting(false);
+    emitter.update(0.25);
+    EXPECT_EQ(emitter.get_pool().size(), 26u);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../src/engine/resources/Preloader.hpp"
+#include "../src/engine/resources/ResourceManager.hpp"
+
+TEST(PreloaderTest, ManifestIgnoresDuplicates) {
+    AssetManifest manifest;
+    manifest.add_model("ship.gltf", {"hull.png"});
+    manifest.add_model("ship.gltf", {"hull.png", "glass.png"});
+    manifest.add_shader("default");
+    manifest.add_shader("default");
+    manifest.add_texture("sky.png");
+    manifest.add_texture("sky.png");
+
+    EXPECT_EQ(manifest.models, std::vector<std::string>{"ship.gltf"});
+    EXPECT_EQ(manifest.shaders, std::vector<std::string>{"default"});
+    EXPECT_EQ(manifest.textures, std::vector<std::string>{"sky.png"});
+    const std::vector<std::string> edges = {"hull.png", "glass.png"};
+    EXPECT_EQ(manifest.model_textures.at("ship.gltf"), edges);
+    EXPECT_FALSE(manifest.empty());
+}
+
+TEST(PreloaderTest, MergeKeepsModelTextures) {
+    AssetManifest ship;
+    ship.add_model("ship.gltf", {"hull.png"});
+    ship.add_shader("default");
+    AssetManifest debris;
+    debris.add_model("rock.gltf");
+    debris.add_model("ship.gltf", {"glass.png"});
+    debris.add_shader("default");
+
+    AssetManifest scene;
+    EXPECT_TRUE(scene.empty());
+    scene.merge(ship);
+    scene.merge(debris);
+
+    const std::vector<std::string> models = {"ship.gltf", "rock.gltf"};
+    EXPECT_EQ(scene.models, models);
+    EXPECT_EQ(scene.shaders, std::vector<std::string>{"default"});
+    const std::vector<std::string> edges = {"hull.png", "glass.png"};
+    EXPECT_EQ(scene.model_textures.at("ship.gltf"), edges);
+    EXPECT_EQ(scene.model_textures.count("rock.gltf"), 0u);
+}
+
+TEST(PreloaderTest, ReportsMissingAssetsAsFailed) {
+    const auto dir = std::filesystem::temp_directory_path() / "gldemo_preloader_test";
+    std::filesystem::create_directories(dir);
+    Managers::initialize(dir);
+
+    AssetManifest manifest;
+    manifest.add_model("missing.gltf", {"missing_hull.png"});
+    manifest.add_texture("missing_sky.png");
+    manifest.add_texture("missing_hull.png");
+
+    const Preloader::Report report = Preloader::load(manifest);
+
+    // Each texture once, the one listed for the model as its dependency
+    ASSERT_EQ(report.assets.size(), 3u);
+    EXPECT_EQ(report.failed_count(), 3u);
+    EXPECT_GE(report.total_ms, 0.0);
+    for (const auto& timing: report.assets) {
+        EXPECT_LE(timing.ms, report.total_ms);
+        if (timing.name == "missing_hull.png") {
+            EXPECT_EQ(timing.model, "missing.gltf");
+        } else if (timing.name == "missing_sky.png") {
+            EXPECT_TRUE(timing.model.empty());
+        }
+    }
+    EXPECT_EQ(report.handles.size(), 3u);
+
+    std::filesystem::remove_all(dir);
+}
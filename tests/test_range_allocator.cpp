@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include "../src/engine/renderer/RangeAllocator.hpp"
+
+using Renderer::RangeAllocator;
+
+TEST(RangeAllocatorTest, AllocatesFromTheFront) {
+    RangeAllocator allocator(100);
+
+    EXPECT_EQ(allocator.allocate(10), 0u);
+    EXPECT_EQ(allocator.allocate(20), 10u);
+    EXPECT_EQ(allocator.free_space(), 70u);
+}
+
+TEST(RangeAllocatorTest, FailsWhenNoBlockFits) {
+    RangeAllocator allocator(100);
+    allocator.allocate(40);
+    const auto middle = allocator.allocate(20);
+    allocator.allocate(40);
+    allocator.free(*middle, 20);
+
+    EXPECT_FALSE(allocator.allocate(30).has_value());
+    EXPECT_FALSE(allocator.allocate(0).has_value());
+    EXPECT_EQ(allocator.allocate(20), 40u);
+}
+
+TEST(RangeAllocatorTest, PicksTheSmallestBlockThatFits) {
+    RangeAllocator allocator(100);
+    const auto a = allocator.allocate(30);
+    allocator.allocate(10);
+    const auto b = allocator.allocate(15);
+    allocator.allocate(10);
+    allocator.free(*a, 30);
+    allocator.free(*b, 15);
+
+    // Free blocks: [0, 30), [40, 55) and [65, 100)
+    EXPECT_EQ(allocator.allocate(12), 40u);
+    EXPECT_EQ(allocator.allocate(25), 0u);
+}
+
+TEST(RangeAllocatorTest, FreedNeighboursMerge) {
+    RangeAllocator allocator(90);
+    const auto a = allocator.allocate(30);
+    const auto b = allocator.allocate(30);
+    const auto c = allocator.allocate(30);
+
+    allocator.free(*a, 30);
+    allocator.free(*c, 30);
+    EXPECT_EQ(allocator.free_block_count(), 2u);
+
+    allocator.free(*b, 30);
+    EXPECT_EQ(allocator.free_block_count(), 1u);
+    EXPECT_EQ(allocator.largest_free_block(), 90u);
+    EXPECT_EQ(allocator.allocate(90), 0u);
+}
+
+TEST(RangeAllocatorTest, ScatteredHolesAreFragmented) {
+    RangeAllocator allocator(100);
+    size_t offsets[10];
+    for (auto& offset: offsets) offset = *allocator.allocate(10);
+    for (size_t i = 0; i < 10; i += 2) allocator.free(offsets[i], 10);
+
+    EXPECT_EQ(allocator.free_space(), 50u);
+    EXPECT_TRUE(allocator.is_fragmented());
+    EXPECT_FALSE(allocator.allocate(20).has_value());
+}
+
+TEST(RangeAllocatorTest, ResetLeavesOneFreeBlockAfterTheUsedSpace) {
+    RangeAllocator allocator(100);
+    const auto a = allocator.allocate(25);
+    allocator.allocate(25);
+    allocator.free(*a, 25);
+
+    allocator.reset(25);
+    EXPECT_EQ(allocator.free_space(), 75u);
+    EXPECT_FALSE(allocator.is_fragmented());
+    EXPECT_EQ(allocator.allocate(75), 25u);
+}
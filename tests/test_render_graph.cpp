@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "../src/engine/renderer/RenderGraph.hpp"
+
+using Renderer::RenderGraph;
+using Renderer::TextureDesc;
+
+static void no_op(const RenderGraph::PassResources&) {
+}
+
+// compile() does no GL work, execute() is covered by running the game
+
+TEST(RenderGraphTest, CullsPassesWithUnusedOutput) {
+    RenderGraph graph;
+    const auto backbuffer = graph.import_framebuffer("backbuffer", 0, 64, 64);
+
+    const auto unused = graph.add_pass("unused", [](RenderGraph::PassBuilder& builder) {
+        builder.create("debug", {64, 64, GL_RGBA8});
+    }, no_op);
+    const auto present = graph.add_pass("present", [&](RenderGraph::PassBuilder& builder) {
+        builder.write(backbuffer);
+    }, no_op);
+    graph.compile();
+
+    EXPECT_TRUE(graph.is_culled(unused));
+    EXPECT_FALSE(graph.is_culled(present));
+    ASSERT_EQ(graph.get_execution_order().size(), 1u);
+    EXPECT_EQ(graph.get_execution_order()[0], present);
+}
+
+TEST(RenderGraphTest, SideEffectPassIsKept) {
+    RenderGraph graph;
+    const auto pass = graph.add_pass("readback", [](RenderGraph::PassBuilder& builder) {
+        builder.create("capture", {64, 64, GL_RGBA8});
+        builder.set_side_effect();
+    }, no_op);
+    graph.compile();
+
+    EXPECT_FALSE(graph.is_culled(pass));
+}
+
+TEST(RenderGraphTest, ProducerRunsBeforeConsumer) {
+    RenderGraph graph;
+    const auto backbuffer = graph.import_framebuffer("backbuffer", 0, 64, 64);
+    const auto color = graph.create_texture("color", {64, 64, GL_RGBA8});
+
+    const auto producer = graph.add_pass("producer", [&](RenderGraph::PassBuilder& builder) {
+        builder.write(color);
+    }, no_op);
+    const auto consumer = graph.add_pass("consumer", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(color);
+        builder.write(backbuffer);
+    }, no_op);
+    graph.compile();
+
+    const auto& order = graph.get_execution_order();
+    ASSERT_EQ(order.size(), 2u);
+    EXPECT_EQ(order[0], producer);
+    EXPECT_EQ(order[1], consumer);
+}
+
+TEST(RenderGraphTest, AliasesTransientsWithDisjointLifetimes) {
+    RenderGraph graph;
+    const auto backbuffer = graph.import_framebuffer("backbuffer", 0, 64, 64);
+    const TextureDesc desc{64, 64, GL_RGBA16F};
+
+    RenderGraph::ResourceId first = 0, second = 0;
+    graph.add_pass("a", [&](RenderGraph::PassBuilder& builder) {
+        first = builder.create("first", desc);
+    }, no_op);
+    graph.add_pass("b", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(first);
+        second = builder.create("second", desc);
+    }, no_op);
+    graph.add_pass("c", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(second);
+        builder.write(backbuffer);
+    }, no_op);
+    graph.compile();
+
+    // `first` is still being read when `second` is written, so they can't share
+    EXPECT_NE(graph.get_physical_slot(first), graph.get_physical_slot(second));
+
+    RenderGraph::ResourceId third = 0;
+    graph.add_pass("d", [&](RenderGraph::PassBuilder& builder) {
+        third = builder.create("third", desc);
+    }, no_op);
+    graph.add_pass("e", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(third);
+        builder.write(backbuffer);
+    }, no_op);
+    graph.compile();
+
+    // `first` is dead by the time `third` is written
+    EXPECT_EQ(graph.get_physical_slot(third), graph.get_physical_slot(first));
+    EXPECT_EQ(graph.get_physical_slot_count(), 2u);
+}
+
+TEST(RenderGraphTest, DifferentDescriptionsNeverAlias) {
+    RenderGraph graph;
+    const auto backbuffer = graph.import_framebuffer("backbuffer", 0, 64, 64);
+
+    RenderGraph::ResourceId color = 0, depth = 0;
+    graph.add_pass("a", [&](RenderGraph::PassBuilder& builder) {
+        color = builder.create("color", {64, 64, GL_RGBA8});
+    }, no_op);
+    graph.add_pass("b", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(color);
+        builder.write(backbuffer);
+    }, no_op);
+    graph.add_pass("c", [&](RenderGraph::PassBuilder& builder) {
+        depth = builder.create("depth", {64, 64, GL_DEPTH_COMPONENT24});
+    }, no_op);
+    graph.add_pass("d", [&](RenderGraph::PassBuilder& builder) {
+        builder.read(depth);
+        builder.write(backbuffer);
+    }, no_op);
+    graph.compile();
+
+    EXPECT_NE(graph.get_physical_slot(color), graph.get_physical_slot(depth));
+    EXPECT_EQ(graph.get_physical_slot(backbuffer), -1);
+}
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/engine/renderer/ResolutionController.hpp"
+
+static void fill(Utils::CircularBuffer& buffer, float value, size_t count = 8) {
+    for (size_t i = 0; i < count; i++) buffer.push(value);
+}
+
+TEST(ResolutionControllerTest, StartsAtMaxScale) {
+    Renderer::ResolutionController controller(8.0, 0.5, 1.0);
+    EXPECT_DOUBLE_EQ(controller.get_scale(), 1.0);
+}
+
+TEST(ResolutionControllerTest, HoldsUntilEnoughSamples) {
+    Renderer::ResolutionController controller(8.0);
+    Utils::CircularBuffer cpu(32), gpu(32);
+    fill(cpu, 2.0f, 2);
+    fill(gpu, 20.0f, 2);
+    EXPECT_DOUBLE_EQ(controller.update(cpu, gpu), 1.0);
+}
+
+TEST(ResolutionControllerTest, DropsWhenGpuBound) {
+    Renderer::ResolutionController controller(8.0, 0.5, 1.0);
+    Utils::CircularBuffer cpu(32), gpu(32);
+    fill(cpu, 2.0f);
+    fill(gpu, 12.0f);
+    double scale = controller.update(cpu, gpu);
+    EXPECT_LT(scale, 1.0);
+    EXPECT_GE(scale, 0.5);
+}
+
+TEST(ResolutionControllerTest, HoldsWhenCpuBound) {
+    Renderer::ResolutionController controller(8.0, 0.5, 1.0);
+    Utils::CircularBuffer cpu(32), gpu(32);
+    fill(cpu, 14.0f);
+    fill(gpu, 9.0f);
+    EXPECT_DOUBLE_EQ(controller.update(cpu, gpu), 1.0);
+}
+
+TEST(ResolutionControllerTest, RecoversWhenUnderBudget) {
+    Renderer::ResolutionController controller(8.0, 0.5, 1.0);
+    Utils::CircularBuffer cpu(32), gpu(32);
+    fill(cpu, 2.0f);
+    fill(gpu, 30.0f);
+    double dropped = controller.update(cpu, gpu);
+    ASSERT_LT(dropped, 1.0);
+
+    fill(gpu, 2.0f);
+    double raised = controller.update(cpu, gpu);
+    EXPECT_GT(raised, dropped);
+
+    for (int i = 0; i < 50; i++) {
+        fill(gpu, 2.0f);
+        controller.update(cpu, gpu);
+    }
+    EXPECT_DOUBLE_EQ(controller.get_scale(), 1.0);
+}
+
+TEST(ResolutionControllerTest, NeverDropsBelowMinimum) {
+    Renderer::ResolutionController controller(8.0, 0.5, 1.0);
+    Utils::CircularBuffer cpu(32), gpu(32);
+    fill(cpu, 1.0f);
+    fill(gpu, 500.0f);
+    for (int i = 0; i < 20; i++) {
+        fill(gpu, 500.0f);
+        controller.update(cpu, gpu);
+    }
+    EXPECT_DOUBLE_EQ(controller.get_scale(), 0.5);
+}
+
+TEST(ResolutionControllerTest, HoldsUntilSamplesReflectTheChange) {
+    Renderer::ResolutionController controller(8.0, 0.5, 1.0, 4);
+    Utils::CircularBuffer cpu(32), gpu(32);
+    fill(cpu, 2.0f);
+    fill(gpu, 12.0f);
+    const double dropped = controller.update(cpu, gpu);
+    ASSERT_LT(dropped, 1.0);
+
+    // Window plus latency worth of samples still from before the drop
+    for (int i = 0; i < 11; i++) {
+        gpu.push(12.0f);
+        EXPECT_DOUBLE_EQ(controller.update(cpu, gpu), dropped);
+    }
+    gpu.push(12.0f);
+    EXPECT_LT(controller.update(cpu, gpu), dropped);
+}
+
+TEST(ResolutionControllerTest, SettlesWhenGpuTimeFollowsScale) {
+    // 12 ms at full scale over an 8 ms budget, GPU time proportional to pixel count and
+    // measured 4 frames late
+    Renderer::ResolutionController controller(8.0, 0.5, 1.0, 4);
+    Utils::CircularBuffer cpu(32), gpu(32);
+    std::vector<double> scales;
+    double lowest = 1.0;
+    for (int frame = 0; frame < 300; frame++) {
+        const double scale = controller.get_scale();
+        scales.push_back(scale);
+        lowest = std::min(lowest, scale);
+        cpu.push(2.0f);
+        if (frame >= 4) {
+            const double measured = scales[frame - 4];
+            gpu.push(static_cast<float>(12.0 * measured * measured));
+        }
+        controller.update(cpu, gpu);
+    }
+
+    // sqrt(6 / 12) to sqrt(7.6 / 12) keeps GPU time between the watermarks
+    EXPECT_GT(lowest, 0.65);
+    for (int frame = 200; frame < 300; frame++) {
+        EXPECT_GE(scales[frame], 0.7);
+        EXPECT_LE(scales[frame], 0.8);
+    }
+    EXPECT_DOUBLE_EQ(scales[299], scales[200]);
+}
@@ -1,4 +1,10 @@
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -24,13 +30,12 @@ public:
     TransparentManager() : TestManager(TestLoader()) {}
 
     bool has_resource(const std::string& name) const {
-        auto it = resources_.find(name);
-        return it != resources_.end();
+        return tracks(name);
     }
 
     bool resource_is_active(const std::string& name) const {
         if (has_resource(name)) {
-            auto resource = resources_[name];
+            auto resource = tracked_handle(name);
             return !resource.expired();
         } else {
             return false;
@@ -38,20 +43,53 @@ public:
     }
 
     unsigned int count_tracked_resources() const {
-        return resources_.size();
+        unsigned int sum = 0;
+        for_each_handle([&sum](const std::string&, const std::weak_ptr<TestResource>&) { sum += 1; });
+        return sum;
     }
 
     unsigned int count_active_resources() const {
         unsigned int sum = 0;
-        for (auto it : resources_) {
-            if (!it.second.expired()) {
+        for_each_handle([&sum](const std::string&, const std::weak_ptr<TestResource>& handle) {
+            if (!handle.expired()) {
                 sum += 1;
             }
-        }
+        });
         return sum;
     }
 };
 
+class AsyncTestResource : public AsyncResource {
+public:
+    std::string name;
+    bool uploaded = false;
+
+    AsyncTestResource() : AsyncResource(State::LOADING) {}
+    explicit AsyncTestResource(const std::string& name) : name(name), uploaded(true) {}
+};
+
+struct AsyncTestLoader {
+    std::shared_ptr<AsyncTestResource> load(const std::string& name) const {
+        return std::make_shared<AsyncTestResource>(name);
+    }
+
+    std::shared_ptr<AsyncTestResource> load_async(const std::string& name) const {
+        auto resource = std::make_shared<AsyncTestResource>();
+        AsyncResource::load_in_background(
+            resource,
+            [name](AsyncTestResource& r) {
+                if (name == "missing") throw std::runtime_error("Failed to load " + name);
+                r.name = name;
+                return size_t(1);
+            },
+            [](AsyncTestResource& r) { r.uploaded = true; }
+        );
+        return resource;
+    }
+};
+
+using AsyncTestManager = ResourceManager<AsyncTestResource, AsyncTestLoader>;
+
 struct TestOwner {
     std::shared_ptr<TestResource> resource;
 };
@@ -126,3 +164,259 @@ TEST(ResourceTest, ResourceManagerShouldTrackResources) {
     EXPECT_FALSE(manager.has_resource("bar"));
     EXPECT_FALSE(manager.resource_is_active("bar"));
 }
+
+TEST(ResourceTest, AsyncResourceIsReadyAfterUpload) {
+    AsyncTestManager manager{AsyncTestLoader()};
+
+    auto resource = manager.get_async("foo");
+    EXPECT_FALSE(resource->is_ready());
+    EXPECT_EQ(manager.get_async("foo"), resource);
+
+    while (!resource->is_ready()) {
+        Renderer::UploadQueue::instance().process(SIZE_MAX);
+    }
+    EXPECT_TRUE(resource->uploaded);
+    EXPECT_EQ(resource->name, "foo");
+}
+
+TEST(ResourceTest, GetFinishesAsyncLoad) {
+    AsyncTestManager manager{AsyncTestLoader()};
+
+    auto pending = manager.get_async("bar");
+    auto resource = manager.get("bar");
+    EXPECT_EQ(resource, pending);
+    EXPECT_TRUE(resource->is_ready());
+    EXPECT_TRUE(resource->uploaded);
+}
+
+TEST(ResourceTest, FailedAsyncLoadIsRetried) {
+    AsyncTestManager manager{AsyncTestLoader()};
+
+    auto failed = manager.get_async("missing");
+    while (failed->get_state() == AsyncResource::State::LOADING) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(failed->get_state(), AsyncResource::State::FAILED);
+    EXPECT_NE(manager.get_async("missing"), failed);
+}
+
+class SizedResource {
+public:
+    static int n_loaded;
+    std::string name;
+
+    explicit SizedResource(const std::string& name) : name(name) { n_loaded++; }
+
+    MemoryUsage get_memory_usage() const { return {60, 40}; }
+};
+
+int SizedResource::n_loaded = 0;
+
+struct SizedLoader {
+    std::shared_ptr<SizedResource> load(const std::string& name) const {
+        return std::make_shared<SizedResource>(name);
+    }
+};
+
+using SizedManager = ResourceManager<SizedResource, SizedLoader>;
+
+TEST(ResourceTest, ReleasedResourcesAreRetained) {
+    SizedManager manager{SizedLoader(), 250};
+    SizedResource::n_loaded = 0;
+
+    auto foo = manager.get("foo");
+    const SizedResource* address = foo.get();
+    EXPECT_EQ(manager.get_memory_usage().cpu_bytes, 60u);
+    EXPECT_EQ(manager.get_memory_usage().gpu_bytes, 40u);
+
+    foo.reset();
+    EXPECT_EQ(manager.retained_count(), 1u);
+    EXPECT_EQ(manager.get_retained_usage().total(), 100u);
+    EXPECT_EQ(manager.get_memory_usage().total(), 100u);
+
+    // Requested again, the same resource comes back without loading
+    foo = manager.get("foo");
+    EXPECT_EQ(foo.get(), address);
+    EXPECT_EQ(SizedResource::n_loaded, 1);
+    EXPECT_EQ(manager.retained_count(), 0u);
+}
+
+TEST(ResourceTest, RetentionEvictsLeastRecentlyReleased) {
+    SizedManager manager{SizedLoader(), 250};
+    SizedResource::n_loaded = 0;
+
+    manager.get("a");
+    manager.get("b");
+    manager.get("c");
+    // 300 bytes released into a 250 byte budget, "a" went first and is freed
+    EXPECT_EQ(manager.retained_count(), 2u);
+    EXPECT_EQ(manager.get_retained_usage().total(), 200u);
+
+    manager.get("b");
+    EXPECT_EQ(SizedResource::n_loaded, 3);
+    manager.get("a");
+    EXPECT_EQ(SizedResource::n_loaded, 4);
+
+    manager.set_retention_budget(100);
+    EXPECT_EQ(manager.retained_count(), 1u);
+    manager.clean();
+    EXPECT_EQ(manager.retained_count(), 0u);
+    EXPECT_EQ(manager.get_memory_usage().total(), 0u);
+}
+
+// Reads on its own thread until released, so a handle can be dropped mid-load
+class MidLoadResource : public AsyncResource {
+public:
+    std::vector<unsigned char> data;
+
+    MidLoadResource() : AsyncResource(State::LOADING) {}
+
+    MemoryUsage get_memory_usage() const { return {data.capacity(), 0}; }
+};
+
+struct MidLoadLoader {
+    std::shared_future<void> released;
+    std::shared_ptr<std::thread> reader;
+
+    std::shared_ptr<MidLoadResource> load(const std::string&) const { return nullptr; }
+
+    std::shared_ptr<MidLoadResource> load_async(const std::string&) const {
+        auto resource = std::make_shared<MidLoadResource>();
+        *reader = std::thread([resource, released = released] {
+            AsyncResource::load_in_background(
+                resource,
+                [released](MidLoadResource& r) {
+                    released.wait();
+                    r.data.resize(1000);
+                    return r.data.size();
+                },
+                [](MidLoadResource&) {}
+            );
+        });
+        return resource;
+    }
+};
+
+TEST(ResourceTest, ResourcesReleasedWhileLoadingCountOnceReady) {
+    std::promise<void> release;
+    MidLoadLoader loader{release.get_future().share(), std::make_shared<std::thread>()};
+    const std::shared_ptr<std::thread> reader = loader.reader;
+    ResourceManager<MidLoadResource, MidLoadLoader> manager{loader, 1 << 20};
+
+    manager.get_async("slow");
+    ASSERT_EQ(manager.retained_count(), 1u);
+
+    // The reader writes the resource while its size is asked for, which only counts once
+    // the upload makes it ready
+    release.set_value();
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(manager.get_retained_usage().total(), 0u);
+    }
+    reader->join();
+    EXPECT_EQ(manager.get_retained_usage().total(), 0u);
+
+    Renderer::UploadQueue::instance().process(SIZE_MAX);
+    EXPECT_EQ(manager.get_retained_usage().total(), 1000u);
+    manager.clean();
+    Renderer::UploadQueue::instance().process(SIZE_MAX);
+}
+
+TEST(ResourceTest, ResourcesInUseAreNotEvicted) {
+    SizedManager manager{SizedLoader(), 0};
+
+    auto held = manager.get("held");
+    manager.get("released");
+    manager.clean();
+    EXPECT_EQ(manager.get("held"), held);
+    EXPECT_EQ(manager.get_memory_usage().total(), 100u);
+}
+
+TEST(ResourceTest, ExpiredNamesAreSweptAutomatically) {
+    TransparentManager manager{};
+
+    for (int i = 0; i < 1000; i++) {
+        manager.get("resource_" + std::to_string(i));
+    }
+    // Without a retention budget, nothing released is kept, and the names don't pile up
+    EXPECT_LT(manager.count_tracked_resources(), 200u);
+    EXPECT_EQ(manager.count_active_resources(), 0u);
+}
+
+class SlowResource {
+public:
+    static std::atomic<int> n_loaded;
+    std::string name;
+
+    explicit SlowResource(const std::string& name) : name(name) {
+        n_loaded++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        if (name == "missing") throw std::runtime_error("Failed to load " + name);
+    }
+};
+
+std::atomic<int> SlowResource::n_loaded{0};
+
+struct SlowLoader {
+    std::shared_ptr<SlowResource> load(const std::string& name) const {
+        return std::make_shared<SlowResource>(name);
+    }
+};
+
+TEST(ResourceTest, ConcurrentRequestsLoadOnce) {
+    ResourceManager<SlowResource, SlowLoader> manager{SlowLoader()};
+    SlowResource::n_loaded = 0;
+
+    std::vector<std::shared_ptr<SlowResource>> results(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < results.size(); i++) {
+        threads.emplace_back([&manager, &results, i] {
+            results[i] = manager.get(i % 2 ? "foo" : "bar");
+        });
+    }
+    for (auto& thread: threads) thread.join();
+
+    EXPECT_EQ(SlowResource::n_loaded, 2);
+    for (size_t i = 2; i < results.size(); i++) {
+        EXPECT_EQ(results[i], results[i % 2]);
+    }
+    EXPECT_EQ(results[0]->name, "bar");
+    EXPECT_EQ(results[1]->name, "foo");
+}
+
+TEST(ResourceTest, WaitersSeeTheFailedLoad) {
+    ResourceManager<SlowResource, SlowLoader> manager{SlowLoader()};
+    SlowResource::n_loaded = 0;
+
+    std::atomic<int> n_failed{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&manager, &n_failed] {
+            try {
+                manager.get("missing");
+            } catch (const std::runtime_error&) {
+                n_failed++;
+            }
+        });
+    }
+    for (auto& thread: threads) thread.join();
+
+    EXPECT_EQ(n_failed, 4);
+    EXPECT_LE(SlowResource::n_loaded, 4);
+    // Nothing is left in flight, the next request loads again
+    EXPECT_THROW(manager.get("missing"), std::runtime_error);
+}
+
+TEST(UploadQueueTest, ProcessStaysWithinBudget) {
+    Renderer::UploadQueue queue;
+    int n_run = 0;
+    for (int i = 0; i < 3; i++) {
+        queue.push(10, [&n_run] { n_run++; });
+    }
+
+    EXPECT_EQ(queue.process(25), 2u);
+    EXPECT_EQ(n_run, 2);
+
+    // Uploads larger than the budget still run, one per call
+    EXPECT_EQ(queue.process(5), 1u);
+    EXPECT_EQ(queue.size(), 0u);
+}
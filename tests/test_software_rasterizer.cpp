@@ -0,0 +1,123 @@
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/engine/renderer/SoftwareRasterizer.hpp"
+#include "../src/engine/resources/Model.hpp"
+
+using Renderer::DrawCommand;
+using Renderer::FrameUniforms;
+using Renderer::SoftwareRasterizer;
+
+// Meshes skip their GL upload under the software backend, so no context is needed
+class SoftwareRasterizerTest : public ::testing::Test {
+protected:
+    void SetUp() override { Renderer::set_backend(Renderer::Backend::SOFTWARE); }
+    void TearDown() override { Renderer::set_backend(Renderer::Backend::OPENGL); }
+
+    // Pos vec3; Norm vec3; UV vec2
+    static void add_vertex(std::vector<float>& data, float x, float y, float z) {
+        data.insert(data.end(), {x, y, z, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f});
+    }
+
+    static Model::Mesh make_quad(float z) {
+        std::vector<float> data;
+        add_vertex(data, -1.0f, -1.0f, z);
+        add_vertex(data, 1.0f, -1.0f, z);
+        add_vertex(data, 1.0f, 1.0f, z);
+        add_vertex(data, -1.0f, 1.0f, z);
+        return Model::Mesh(data, {0, 1, 2, 0, 2, 3}, 0);
+    }
+
+    // Unlit, so the output is color * color as in light_source.frag
+    static DrawCommand unlit(const Model::Mesh& mesh, const glm::vec3& color) {
+        DrawCommand command;
+        command.mesh = &mesh;
+        command.color = color;
+        return command;
+    }
+
+    static constexpr uint32_t WHITE = 0xFFFFFFFF;
+    static constexpr uint32_t BLACK = 0xFF000000;
+};
+
+TEST_F(SoftwareRasterizerTest, FullscreenQuadCoversEveryPixel) {
+    SoftwareRasterizer rasterizer(67, 45);  // Not a multiple of the tile or SIMD width
+    const Model::Mesh quad = make_quad(0.0f);
+
+    rasterizer.draw({unlit(quad, glm::vec3(1.0f))}, FrameUniforms{});
+
+    for (int y = 0; y < rasterizer.get_height(); y++) {
+        for (int x = 0; x < rasterizer.get_width(); x++) {
+            ASSERT_EQ(rasterizer.get_pixel(x, y), WHITE) << x << ", " << y;
+        }
+    }
+}
+
+TEST_F(SoftwareRasterizerTest, TriangleFanHasNoCracks) {
+    SoftwareRasterizer rasterizer(128, 128);
+
+    constexpr int SLICES = 37;
+    std::vector<float> data;
+    std::vector<unsigned int> indices;
+    add_vertex(data, 0.013f, -0.021f, 0.0f);
+    for (int i = 0; i < SLICES; i++) {
+        const float angle = 2.0f * static_cast<float>(M_PI) * i / SLICES;
+        add_vertex(data, 0.9f * std::cos(angle), 0.9f * std::sin(angle), 0.0f);
+        indices.insert(indices.end(), {0u, 1u + i, 1u + (i + 1) % SLICES});
+    }
+    const Model::Mesh fan(data, indices, 0);
+
+    rasterizer.draw({unlit(fan, glm::vec3(1.0f))}, FrameUniforms{});
+
+    // Everything well inside the rim must be covered
+    for (int y = 0; y < 128; y++) {
+        for (int x = 0; x < 128; x++) {
+            const float nx = (x + 0.5f) / 64.0f - 1.0f;
+            const float ny = (y + 0.5f) / 64.0f - 1.0f;
+            if (std::sqrt(nx * nx + ny * ny) < 0.85f) {
+                ASSERT_EQ(rasterizer.get_pixel(x, y), WHITE) << x << ", " << y;
+            }
+        }
+    }
+}
+
+TEST_F(SoftwareRasterizerTest, NearerSurfaceWinsRegardlessOfOrder) {
+    SoftwareRasterizer rasterizer(32, 32);
+    const Model::Mesh near_quad = make_quad(-0.5f);
+    const Model::Mesh far_quad = make_quad(0.5f);
+
+    rasterizer.draw({unlit(far_quad, glm::vec3(0.0f)), unlit(near_quad, glm::vec3(1.0f))}, FrameUniforms{});
+    EXPECT_EQ(rasterizer.get_pixel(16, 16), WHITE);
+
+    rasterizer.clear();
+    rasterizer.draw({unlit(near_quad, glm::vec3(1.0f)), unlit(far_quad, glm::vec3(0.0f))}, FrameUniforms{});
+    EXPECT_EQ(rasterizer.get_pixel(16, 16), WHITE);
+    EXPECT_FLOAT_EQ(rasterizer.get_depth(16, 16), 0.25f);
+}
+
+TEST_F(SoftwareRasterizerTest, ClipsTrianglesCrossingTheNearPlane) {
+    SoftwareRasterizer rasterizer(64, 64);
+
+    // 90 degree perspective, near 0.1, far 100, column major
+    const float n = 0.1f, f = 100.0f;
+    FrameUniforms frame;
+    frame.projection = glm::mat4(1.0f, 0.0f, 0.0f, 0.0f,
+                                 0.0f, 1.0f, 0.0f, 0.0f,
+                                 0.0f, 0.0f, -(f + n) / (f - n), -1.0f,
+                                 0.0f, 0.0f, -2.0f * f * n / (f - n), 0.0f);
+
+    // A floor below the camera reaching from behind it into the distance
+    std::vector<float> data;
+    add_vertex(data, -10.0f, -1.0f, 5.0f);
+    add_vertex(data, 10.0f, -1.0f, 5.0f);
+    add_vertex(data, 0.0f, -1.0f, -50.0f);
+    const Model::Mesh floor(data, {0, 1, 2}, 0);
+
+    rasterizer.draw({unlit(floor, glm::vec3(1.0f))}, frame);
+
+    EXPECT_EQ(rasterizer.get_pixel(32, 63), WHITE);  // Just in front of the camera
+    EXPECT_EQ(rasterizer.get_pixel(32, 33), WHITE);  // Towards the horizon
+    EXPECT_EQ(rasterizer.get_pixel(32, 20), BLACK);  // Above the horizon
+}
@@ -0,0 +1,131 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/engine/renderer/Backend.hpp"
+#include "../src/engine/resources/BlockCompression.hpp"
+#include "../src/engine/resources/Texture.hpp"
+#include "../src/engine/resources/TextureFile.hpp"
+
+// Smooth gradient with a hard alpha edge. The colors within a block lie on a line, which is
+// what the four-color block palettes can represent.
+static std::vector<unsigned char> gradient(int width, int height) {
+    std::vector<unsigned char> rgba(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            unsigned char* texel = &rgba[(static_cast<size_t>(y) * width + x) * 4];
+            texel[0] = static_cast<unsigned char>(x * 255 / (width - 1));
+            texel[1] = static_cast<unsigned char>(texel[0] / 2 + y);
+            texel[2] = 64;
+            texel[3] = x < width / 2 ? 255 : 0;
+        }
+    }
+    return rgba;
+}
+
+static int max_error(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int channels) {
+    int error = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (static_cast<int>(i % 4) < channels) error = std::max(error, std::abs(a[i] - b[i]));
+    }
+    return error;
+}
+
+TEST(BlockCompressionTest, Bc1RoundTripsClosely) {
+    const auto rgba = gradient(16, 16);
+
+    const auto blocks = BlockCompression::compress(rgba.data(), 16, 16, BlockCompression::Format::BC1);
+    EXPECT_EQ(blocks.size(), 16u * 8u);
+    const auto decoded = BlockCompression::decompress(blocks.data(), 16, 16, BlockCompression::Format::BC1);
+
+    EXPECT_LE(max_error(rgba, decoded, 3), 12);
+}
+
+TEST(BlockCompressionTest, Bc3KeepsAlpha) {
+    const auto rgba = gradient(16, 16);
+
+    const auto blocks = BlockCompression::compress(rgba.data(), 16, 16, BlockCompression::Format::BC3);
+    EXPECT_EQ(blocks.size(), 16u * 16u);
+    const auto decoded = BlockCompression::decompress(blocks.data(), 16, 16, BlockCompression::Format::BC3);
+
+    EXPECT_LE(max_error(rgba, decoded, 3), 12);
+    for (size_t i = 3; i < rgba.size(); i += 4) EXPECT_EQ(decoded[i], rgba[i]);
+}
+
+TEST(BlockCompressionTest, PadsPartialBlocks) {
+    const auto rgba = gradient(6, 3);
+
+    const auto blocks = BlockCompression::compress(rgba.data(), 6, 3, BlockCompression::Format::BC1);
+    EXPECT_EQ(blocks.size(), 2u * 8u);
+    const auto decoded = BlockCompression::decompress(blocks.data(), 6, 3, BlockCompression::Format::BC1);
+
+    ASSERT_EQ(decoded.size(), rgba.size());
+    EXPECT_LE(max_error(rgba, decoded, 3), 12);
+}
+
+TEST(TextureFileTest, WritesFullMipChain) {
+    const auto rgba = gradient(16, 4);
+    const std::string path = testing::TempDir() + "gradient.tex";
+
+    TextureFile::write(rgba.data(), 16, 4, 4, true, path);
+    const TextureFile::Image image(path);
+
+    EXPECT_EQ(image.get_format(), BlockCompression::Format::BC3);
+    const auto& levels = image.get_levels();
+    ASSERT_EQ(levels.size(), 5u);
+    EXPECT_EQ(levels[2].width, 4);
+    EXPECT_EQ(levels[2].height, 1);
+    EXPECT_EQ(levels[4].width, 1);
+    EXPECT_EQ(image.get_size(), 64u + 32u + 16u + 16u + 16u);
+    std::remove(path.c_str());
+}
+
+TEST(TextureFileTest, OpaqueImagesUseBc1) {
+    auto rgba = gradient(8, 8);
+    for (size_t i = 3; i < rgba.size(); i += 4) rgba[i] = 255;
+    const std::string path = testing::TempDir() + "opaque.tex";
+
+    TextureFile::write(rgba.data(), 8, 8, 4, true, path);
+
+    EXPECT_EQ(TextureFile::Image(path).get_format(), BlockCompression::Format::BC1);
+    std::remove(path.c_str());
+}
+
+TEST(TextureFileTest, RejectsCorruptFiles) {
+    const auto rgba = gradient(8, 8);
+    const std::string path = testing::TempDir() + "corrupt.tex";
+    TextureFile::write(rgba.data(), 8, 8, 4, true, path);
+
+    std::vector<char> bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    bytes.resize(bytes.size() - 8);
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+    EXPECT_THROW(TextureFile::Image image(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(TextureFileTest, SoftwareBackendDecodesTopLevel) {
+    Renderer::set_backend(Renderer::Backend::SOFTWARE);
+    const auto rgba = gradient(8, 8);
+    const std::string path = testing::TempDir() + "software.tex";
+    TextureFile::write(rgba.data(), 8, 8, 4, true, path);
+
+    Texture texture(path);
+
+    EXPECT_EQ(texture.width, 8);
+    EXPECT_EQ(texture.channels, 4);
+    EXPECT_EQ(texture.compressed, nullptr);
+    ASSERT_EQ(texture.pixels.size(), rgba.size());
+    EXPECT_LE(max_error(rgba, texture.pixels, 4), 12);
+    std::remove(path.c_str());
+    Renderer::set_backend(Renderer::Backend::OPENGL);
+}
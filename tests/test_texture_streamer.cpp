@@ -0,0 +1,54 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/engine/renderer/TextureStreamer.hpp"
+#include "../src/engine/resources/Texture.hpp"
+#include "../src/engine/resources/TextureFile.hpp"
+
+using Renderer::TextureStreamer;
+
+TEST(TextureStreamerTest, CloseDrawsWantTheTopLevel) {
+    // 90 degree field of view, a unit sphere 2 units away covers half of a 1024 pixel viewport
+    EXPECT_EQ(TextureStreamer::desired_level(512, 10, 2.0f, 1.0f, 1.0f, 1024), 0);
+    EXPECT_EQ(TextureStreamer::desired_level(1024, 11, 2.0f, 1.0f, 1.0f, 1024), 1);
+    // Inside the sphere
+    EXPECT_EQ(TextureStreamer::desired_level(4096, 13, 0.5f, 1.0f, 1.0f, 1024), 0);
+}
+
+TEST(TextureStreamerTest, LevelsCoarsenWithDistance) {
+    int previous = 0;
+    for (float distance = 2.0f; distance < 4096.0f; distance *= 2.0f) {
+        const int level = TextureStreamer::desired_level(2048, 12, distance, 1.0f, 1.0f, 1024);
+        EXPECT_GE(level, previous);
+        previous = level;
+    }
+    // Each doubling of the distance halves the on-screen size, so one level per doubling
+    EXPECT_EQ(TextureStreamer::desired_level(2048, 12, 16.0f, 1.0f, 1.0f, 1024), 5);
+    EXPECT_EQ(TextureStreamer::desired_level(2048, 12, 32.0f, 1.0f, 1.0f, 1024), 6);
+    // Smaller than a pixel, the last level
+    EXPECT_EQ(TextureStreamer::desired_level(2048, 12, 1e6f, 1.0f, 1.0f, 1024), 11);
+}
+
+TEST(TextureStreamerTest, LargeTexturesUploadOnlyTheirTail) {
+    const int size = 1024;
+    std::vector<unsigned char> rgba(static_cast<size_t>(size) * size * 4, 255);
+    const std::string path = testing::TempDir() + "streamed.tex";
+    TextureFile::write(rgba.data(), size, size, 4, true, path);
+
+    Texture texture(true);
+    texture.decode(path);
+    ASSERT_EQ(texture.get_level_count(), 11);
+    // 1024 .. 128 are streamed, 64 and below are resident from the start
+    EXPECT_EQ(texture.get_tail_level(), 4);
+    size_t tail = 0;
+    for (int level = 4; level < 11; level++) tail += texture.get_level_size(level);
+    EXPECT_EQ(texture.get_upload_size(), tail);
+
+    TextureStreamer::instance().set_enabled(false);
+    EXPECT_EQ(texture.get_upload_size(), texture.compressed->get_size());
+    TextureStreamer::instance().set_enabled(true);
+    std::remove(path.c_str());
+}
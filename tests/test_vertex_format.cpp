@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "../src/engine/renderer/GeometryPool.hpp"
+
+using namespace Renderer;
+
+namespace {
+    struct PackedVertex {
+        int16_t position[4];
+        int16_t normal[2];
+        uint16_t uv[2];
+    };
+
+    float from_snorm16(int16_t value) {
+        return std::fmax(static_cast<float>(value) / 32767.0f, -1.0f);
+    }
+}
+
+TEST(VertexFormatTest, QuantizedLayoutIsHalfTheFloatLayout) {
+    EXPECT_EQ(vertex_stride(VertexFormat::POSITION_NORMAL_UV), 32u);
+    EXPECT_EQ(vertex_stride(VertexFormat::QUANTIZED), sizeof(PackedVertex));
+    EXPECT_EQ(index_size(IndexType::UINT16), 2u);
+    EXPECT_EQ(index_size(IndexType::UINT32), 4u);
+}
+
+TEST(VertexFormatTest, HalfFloatRoundTrip) {
+    for (float value: {0.0f, 1.0f, -2.5f, 0.333f, 7.99f, 1e-5f, 65504.0f}) {
+        EXPECT_NEAR(half_to_float(float_to_half(value)), value, std::fabs(value) / 1024.0f + 1e-7f) << value;
+    }
+    EXPECT_EQ(float_to_half(1.0f), 0x3C00);
+    EXPECT_EQ(float_to_half(-2.0f), 0xC000);
+    EXPECT_TRUE(std::isinf(half_to_float(float_to_half(1e6f))));
+}
+
+TEST(VertexFormatTest, OctahedralNormalsRoundTrip) {
+    // Both hemispheres, the poles, and the fold creases
+    const std::vector<glm::vec3> normals = {
+        {0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {0, -1, 0}, {0.6f, 0.0f, -0.8f},
+        {0.267f, -0.535f, 0.802f}, {-0.577f, -0.577f, -0.577f}, {0.1f, 0.99f, -0.1f},
+    };
+    for (glm::vec3 normal: normals) {
+        normal = glm::normalize(normal);
+        const glm::vec2 encoded = encode_octahedral(normal);
+        EXPECT_LE(std::fabs(encoded.x), 1.0f);
+        EXPECT_LE(std::fabs(encoded.y), 1.0f);
+        const glm::vec3 decoded = decode_octahedral(encoded);
+        EXPECT_GT(glm::dot(decoded, normal), 0.99999f);
+    }
+}
+
+TEST(VertexFormatTest, PackQuantizedDequantizesWithinTolerance) {
+    // Pos vec3; Norm vec3; UV vec2
+    const std::vector<float> vertices = {
+        -4.0f, 1.0f, 10.0f,   0.0f, 1.0f, 0.0f,    0.0f, 0.0f,
+        2.0f, 1.0f, 12.5f,    0.0f, 0.0f, -1.0f,   1.0f, 0.5f,
+        0.3f, 1.0f, 11.1f,    0.6f, -0.8f, 0.0f,   3.25f, -2.0f,
+    };
+    glm::mat4 dequantize;
+    const std::vector<unsigned char> packed =
+        pack_vertices(VertexFormat::QUANTIZED, vertices.data(), 3, dequantize);
+    ASSERT_EQ(packed.size(), 3 * sizeof(PackedVertex));
+
+    for (size_t i = 0; i < 3; i++) {
+        PackedVertex vertex;
+        std::memcpy(&vertex, packed.data() + i * sizeof(PackedVertex), sizeof(vertex));
+        const float* expected = &vertices[i * 8];
+
+        const glm::vec4 position = dequantize * glm::vec4(from_snorm16(vertex.position[0]),
+                                                          from_snorm16(vertex.position[1]),
+                                                          from_snorm16(vertex.position[2]), 1.0f);
+        // 16 bits over a 6 unit wide box
+        for (int axis = 0; axis < 3; axis++) EXPECT_NEAR(position[axis], expected[axis], 1e-4f);
+
+        const glm::vec3 normal = decode_octahedral(glm::vec2(from_snorm16(vertex.normal[0]),
+                                                             from_snorm16(vertex.normal[1])));
+        EXPECT_GT(glm::dot(normal, glm::vec3(expected[3], expected[4], expected[5])), 0.9999f);
+
+        EXPECT_NEAR(half_to_float(vertex.uv[0]), expected[6], 1e-3f);
+        EXPECT_NEAR(half_to_float(vertex.uv[1]), expected[7], 1e-3f);
+    }
+}
+
+TEST(VertexFormatTest, PackFloatLayoutCopiesVertices) {
+    const std::vector<float> vertices = {1, 2, 3, 0, 0, 1, 0.5f, 0.25f};
+    glm::mat4 dequantize(2.0f);
+    const std::vector<unsigned char> packed =
+        pack_vertices(VertexFormat::POSITION_NORMAL_UV, vertices.data(), 1, dequantize);
+
+    ASSERT_EQ(packed.size(), vertices.size() * sizeof(float));
+    EXPECT_EQ(std::memcmp(packed.data(), vertices.data(), packed.size()), 0);
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) EXPECT_EQ(dequantize[column][row], column == row ? 1.0f : 0.0f);
+    }
+}